@@ -0,0 +1,222 @@
+import argparse
+import csv
+import json
+import os
+import socket
+import ssl
+import statistics
+import sys
+import tempfile
+import threading
+import time
+import urllib.request
+
+# Compares TLS handshake latency (and, on the device, heap use) per certificate type.
+#
+# Against the device (measures whatever cert/key is installed; run once per key type,
+# uploading the other cert in between, and compare the rows in the CSV):
+#   python generate_certs.py --type ec     # or --type rsa, then build.bat -UploadData
+#   python benchmark_tls.py --device 10.2.1.79 --api-key hello --csv tls_bench.csv
+#
+# Against a host server (no device needed; runs every key type in turn):
+#   python benchmark_tls.py --local
+#
+# Each run does --count full handshakes (no session reuse) and --count resumed
+# handshakes (reusing the first session). Device runs also read the server-side
+# numbers from POST /config: handshake timing, heap held per connection and the
+# peak heap drop during a handshake. Reboot the device before a run for an exact
+# peak; it is taken from the heap low-water mark.
+#
+# The run fails (exit status 1) unless every resumed handshake was actually
+# resumed; on the device the server's own `resumed` counter must also have grown
+# by that many, so a missing session cache shows up here rather than as a
+# silently slower handshake.
+
+def client_context():
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    ctx.check_hostname = False
+    ctx.verify_mode = ssl.CERT_NONE   # self-signed; we only time the handshake
+    ctx.maximum_version = ssl.TLSVersion.TLSv1_2   # what the device speaks
+    return ctx
+
+def handshake(ctx, host, port, session=None):
+    sock = socket.create_connection((host, port), timeout=10)
+    try:
+        start = time.perf_counter()
+        tls = ctx.wrap_socket(sock, server_hostname=host, session=session, do_handshake_on_connect=False)
+        tls.do_handshake()
+        ms = (time.perf_counter() - start) * 1000.0
+        info = (ms, tls.session, tls.session_reused, tls.cipher()[0])
+        tls.close()
+        return info
+    finally:
+        sock.close()
+
+def summarize(samples):
+    if not samples:
+        return {"n": 0, "median": 0.0, "p90": 0.0, "min": 0.0, "max": 0.0}
+    s = sorted(samples)
+    return {
+        "n": len(s),
+        "median": statistics.median(s),
+        "p90": s[min(len(s) - 1, int(len(s) * 0.9))],
+        "min": s[0],
+        "max": s[-1],
+    }
+
+def run(host, port, count):
+    ctx = client_context()
+    full = []
+    cipher = ""
+    session = None
+    for _ in range(count):
+        ms, session, _, cipher = handshake(ctx, host, port)
+        full.append(ms)
+        time.sleep(0.05)
+
+    resumed = []
+    reused = 0
+    for _ in range(count):
+        ms, new_session, was_reused, _ = handshake(ctx, host, port, session)
+        resumed.append(ms)
+        reused += 1 if was_reused else 0
+        session = new_session
+        time.sleep(0.05)
+
+    return {"cipher": cipher, "full": summarize(full), "resumed": summarize(resumed), "reused": reused}
+
+def device_stats(host, api_key):
+    req = urllib.request.Request(f"https://{host}/config", data=b"", method="POST",
+                                 headers={"X-API-Key": api_key})
+    ctx = client_context()
+    with urllib.request.urlopen(req, context=ctx, timeout=10) as r:
+        data = json.load(r)
+    return data.get("security", {}).get("tls", {}), data.get("device", {})
+
+def check_resumption(result, server_resumed=None):
+    n = result["resumed"]["n"]
+    ok = result["reused"] == n
+    line = f"resumption: {result['reused']}/{n} reused by the client"
+    if server_resumed is not None:
+        line += f", {server_resumed} counted by the server"
+        ok = ok and server_resumed >= n
+    print(line + ("" if ok else "  FAILED"))
+    return ok
+
+def print_row(label, result, server=None):
+    f, r = result["full"], result["resumed"]
+    print(f"{label:<12} {result['cipher']:<32} full {f['median']:7.1f} ms (p90 {f['p90']:7.1f})  "
+          f"resumed {r['median']:7.1f} ms ({result['reused']}/{r['n']} reused)")
+    if server:
+        print(f"{'':<12} device: avg {server.get('handshake_avg_ms', 0)} ms, max {server.get('handshake_max_ms', 0)} ms, "
+              f"{server.get('heap_per_connection', 0)} B/connection, peak {server.get('handshake_heap_peak', 0)} B")
+
+def append_csv(path, row):
+    new = not os.path.exists(path)
+    with open(path, "a", newline="") as f:
+        w = csv.DictWriter(f, fieldnames=list(row.keys()))
+        if new:
+            w.writeheader()
+        w.writerow(row)
+
+def csv_row(target, key_type, result, server):
+    f, r = result["full"], result["resumed"]
+    return {
+        "time": time.strftime("%Y-%m-%d %H:%M:%S"),
+        "target": target,
+        "key_type": key_type,
+        "cipher": result["cipher"],
+        "full_median_ms": round(f["median"], 1),
+        "full_p90_ms": round(f["p90"], 1),
+        "resumed_median_ms": round(r["median"], 1),
+        "resumed_count": result["reused"],
+        "device_avg_ms": server.get("handshake_avg_ms", ""),
+        "device_max_ms": server.get("handshake_max_ms", ""),
+        "heap_per_connection": server.get("heap_per_connection", ""),
+        "handshake_heap_peak": server.get("handshake_heap_peak", ""),
+    }
+
+# ===== Host server =====
+# Same suites and order the device offers (SR_TLSServer.cpp)
+DEVICE_CIPHERS = ("ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-ECDSA-AES128-SHA256:"
+                  "ECDHE-RSA-AES128-GCM-SHA256:ECDHE-RSA-CHACHA20-POLY1305:ECDHE-RSA-AES128-SHA256")
+
+def serve(ctx, listener, stop):
+    while not stop.is_set():
+        try:
+            conn, _ = listener.accept()
+        except socket.timeout:
+            continue
+        try:
+            tls = ctx.wrap_socket(conn, server_side=True)
+            tls.close()
+        except (ssl.SSLError, OSError):
+            conn.close()
+
+def run_local(count, csv_path):
+    import generate_certs
+
+    ok = True
+    for key_type in generate_certs.KEY_TYPES:
+        with tempfile.TemporaryDirectory() as out_dir:
+            generate_certs.generate_self_signed_cert(key_type, out_dir)
+            ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+            ctx.maximum_version = ssl.TLSVersion.TLSv1_2
+            ctx.set_ciphers(DEVICE_CIPHERS)
+            ctx.load_cert_chain(os.path.join(out_dir, "cert.pem"), os.path.join(out_dir, "key.pem"))
+
+            listener = socket.create_server(("127.0.0.1", 0))
+            listener.settimeout(0.2)
+            stop = threading.Event()
+            thread = threading.Thread(target=serve, args=(ctx, listener, stop), daemon=True)
+            thread.start()
+            try:
+                result = run("127.0.0.1", listener.getsockname()[1], count)
+            finally:
+                stop.set()
+                thread.join()
+                listener.close()
+
+        print_row(key_type, result)
+        ok = check_resumption(result) and ok
+        if csv_path:
+            append_csv(csv_path, csv_row("host", key_type, result, {}))
+    return ok
+
+def main():
+    parser = argparse.ArgumentParser(description="TLS handshake benchmark per certificate type")
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("--device", help="device IP (HTTPS on port 443)")
+    target.add_argument("--local", action="store_true", help="benchmark a host server for each key type")
+    parser.add_argument("--port", type=int, default=443)
+    parser.add_argument("--api-key", default="hello", help="X-API-Key for reading /config")
+    parser.add_argument("--count", type=int, default=20, help="handshakes per mode")
+    parser.add_argument("--csv", help="append results to this CSV file")
+    args = parser.parse_args()
+
+    if args.local:
+        sys.exit(0 if run_local(args.count, args.csv) else 1)
+
+    try:
+        before, _ = device_stats(args.device, args.api_key)
+    except Exception as e:
+        print(f"Could not read /config: {e}", file=sys.stderr)
+        before = None
+    result = run(args.device, args.port, args.count)
+    try:
+        server, _ = device_stats(args.device, args.api_key)
+    except Exception as e:
+        print(f"Could not read /config: {e}", file=sys.stderr)
+        server = {}
+    key_type = server.get("key_type", "?")
+    print_row(key_type, result, server)
+    server_resumed = None
+    if before is not None and "resumed" in server:
+        server_resumed = server["resumed"] - before.get("resumed", 0)
+    ok = check_resumption(result, server_resumed)
+    if args.csv:
+        append_csv(args.csv, csv_row(args.device, key_type, result, server))
+    sys.exit(0 if ok else 1)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,109 @@
+import argparse
+import csv
+import json
+import ssl
+import statistics
+import sys
+import time
+import urllib.request
+
+# Checks the device's wall clock against this PC (keep the PC on NTP).
+#
+#   python check_time.py --device 10.2.1.79 --api-key hello
+#   python check_time.py --device 10.2.1.79 --http --api-key myReadKey --count 120 --interval 30
+#
+# Every poll of GET /time is timestamped on the host before and after; the
+# device's utc_ms is compared with the midpoint, so the error bound of each
+# sample is half its round trip. The summary gives the offset from the
+# lowest-RTT samples and, over a long enough run, the drift of the device's
+# clock (slope of offset over time, in ppm) next to the drift the device
+# itself has estimated between SNTP syncs. With drift compensation working,
+# the measured slope should stay well under the raw crystal error the
+# device reports.
+
+def fetch(url, api_key, ctx):
+    req = urllib.request.Request(url, headers={"X-API-Key": api_key} if api_key else {})
+    t0 = time.time()
+    with urllib.request.urlopen(req, timeout=10, context=ctx) as resp:
+        body = resp.read()
+    t1 = time.time()
+    return t0, t1, json.loads(body)
+
+def slope(xs, ys):
+    mx = statistics.fmean(xs)
+    my = statistics.fmean(ys)
+    den = sum((x - mx) ** 2 for x in xs)
+    return sum((x - mx) * (y - my) for x, y in zip(xs, ys)) / den if den else 0.0
+
+def main():
+    ap = argparse.ArgumentParser(description="Measure the device clock offset and drift")
+    ap.add_argument("--device", required=True)
+    ap.add_argument("--api-key", default="")
+    ap.add_argument("--http", action="store_true", help="plain HTTP (read-only listener) instead of HTTPS")
+    ap.add_argument("--port", type=int)
+    ap.add_argument("--count", type=int, default=20)
+    ap.add_argument("--interval", type=float, default=1.0, help="seconds between polls")
+    ap.add_argument("--csv", help="write every sample to this file")
+    args = ap.parse_args()
+
+    scheme = "http" if args.http else "https"
+    port = args.port or (80 if args.http else 443)
+    url = "%s://%s:%d/time" % (scheme, args.device, port)
+    ctx = None
+    if not args.http:
+        ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+        ctx.check_hostname = False
+        ctx.verify_mode = ssl.CERT_NONE
+
+    writer = None
+    if args.csv:
+        f = open(args.csv, "w", newline="")
+        writer = csv.writer(f)
+        writer.writerow(["host_s", "rtt_ms", "offset_ms", "device_utc_ms", "synced", "syncs", "drift_ppm"])
+
+    samples = []   # (host midpoint s, rtt ms, offset ms)
+    last = None
+    for i in range(args.count):
+        if i:
+            time.sleep(args.interval)
+        try:
+            t0, t1, info = fetch(url, args.api_key, ctx)
+        except Exception as e:
+            print("poll %d failed: %s" % (i + 1, e), file=sys.stderr)
+            continue
+        last = info
+        mid = (t0 + t1) / 2
+        rtt = (t1 - t0) * 1000.0
+        if not info.get("synced"):
+            print("poll %d: device clock not synced yet (server %s)" % (i + 1, info.get("server")))
+            continue
+        offset = info["utc_ms"] - mid * 1000.0
+        samples.append((mid, rtt, offset))
+        print("poll %d: offset %+8.1f ms  rtt %6.1f ms  syncs %d" % (i + 1, offset, rtt, info["syncs"]))
+        if writer:
+            writer.writerow(["%.3f" % mid, "%.1f" % rtt, "%.1f" % offset, info["utc_ms"], 1,
+                             info["syncs"], info["drift_ppm"]])
+
+    if not samples:
+        print("no synced samples")
+        return 1
+
+    best = sorted(samples, key=lambda s: s[1])[:max(1, len(samples) // 4)]
+    print()
+    print("samples            %d" % len(samples))
+    print("offset (best RTT)  %+.1f ms +/- %.1f ms" % (statistics.median(s[2] for s in best),
+                                                       max(s[1] for s in best) / 2))
+    print("offset range       %+.1f .. %+.1f ms" % (min(s[2] for s in samples), max(s[2] for s in samples)))
+    span = samples[-1][0] - samples[0][0]
+    if span >= 600:
+        ppm = slope([s[0] for s in samples], [s[2] for s in samples]) * 1000.0
+        print("measured drift     %+.2f ppm over %.0f s" % (ppm, span))
+    else:
+        print("measured drift     (needs a run of 10 min or more)")
+    if last:
+        print("device estimate    %+.3f ppm drift, last correction %+.3f ms, %d syncs, %d s since sync" %
+              (last["drift_ppm"], last["last_offset_ms"], last["syncs"], last["since_sync_s"]))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,211 @@
+import argparse
+import csv
+import json
+import random
+import sys
+import threading
+import time
+import urllib.error
+import urllib.request
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+# Stand-in for the central collector that devices push readings to (upload_url).
+#
+#   python collector_stub.py --port 8090
+#   curl -X POST https://<device>/config -k -H "X-API-Key: hello" \
+#        -d password=admin -d upload_url=http://<this-pc>:8090/ingest     # then reboot
+#
+# Batches are deduplicated on (device, boot, seq), the way a real collector
+# must, and the summary shows how many readings arrived twice (retries after
+# a lost response, or the flash queue resent after a reboot) and any gaps
+# longer than --sample-ms (the device's upload_sample_ms). Outages can be
+# simulated to watch the device queue, back off and catch up:
+#
+#   --outage 30:120     answer 503 from 30 s after start, for 120 s
+#   --fail-rate 0.2     answer 503 to 20% of batches
+#   --slow-ms 8000      store the batch but answer after the device has timed out
+#
+# --self-test runs the server in-process and checks the deduplication logic.
+
+class Collector:
+    def __init__(self, sample_ms=1000, csv_path=None):
+        self.lock = threading.Lock()
+        self.seen = set()
+        self.sample_ms = sample_ms
+        self.last_t = {}        # (device, boot) -> newest t_ms
+        self.stats = {}         # device -> counters
+        self.csv_path = csv_path
+        self.csv_file = None
+        self.csv_writer = None
+
+    def device_stats(self, device):
+        return self.stats.setdefault(device, {"batches": 0, "readings": 0, "duplicates": 0,
+                                              "gaps": 0, "boots": 0, "refused": 0})
+
+    def ingest(self, batch):
+        device = str(batch["device"])
+        boot = int(batch["boot"])
+        readings = batch["readings"]
+        with self.lock:
+            s = self.device_stats(device)
+            s["batches"] += 1
+            stream = (device, boot)
+            if stream not in self.last_t:
+                s["boots"] += 1
+                self.last_t[stream] = None
+            for r in readings:
+                key = (device, boot, int(r["seq"]))
+                if key in self.seen:
+                    s["duplicates"] += 1
+                    continue
+                self.seen.add(key)
+                s["readings"] += 1
+                # seq advances once per publish tick, not per uploaded sample,
+                # so gaps are judged by time against upload_sample_ms
+                last = self.last_t[stream]
+                if last is not None and r["t_ms"] - last > self.sample_ms * 1.5:
+                    s["gaps"] += 1
+                if last is None or r["t_ms"] > last:
+                    self.last_t[stream] = r["t_ms"]
+                self.write_csv(device, boot, batch.get("station", ""), r)
+
+    def write_csv(self, device, boot, station, r):
+        if not self.csv_path:
+            return
+        if self.csv_writer is None:
+            self.csv_file = open(self.csv_path, "a", newline="")
+            fields = ["device", "station", "boot"] + list(r.keys())
+            self.csv_writer = csv.DictWriter(self.csv_file, fieldnames=fields, extrasaction="ignore")
+            if self.csv_file.tell() == 0:
+                self.csv_writer.writeheader()
+        self.csv_writer.writerow(dict(r, device=device, station=station, boot=boot))
+        self.csv_file.flush()
+
+    def summary(self):
+        with self.lock:
+            return {d: dict(s) for d, s in self.stats.items()}
+
+def make_handler(collector, args, started):
+    class Handler(BaseHTTPRequestHandler):
+        def do_POST(self):
+            body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+            elapsed = time.time() - started
+            down = args.outage and args.outage[0] <= elapsed < args.outage[0] + args.outage[1]
+            if down or random.random() < args.fail_rate:
+                self.reply(503, {"error": "collector unavailable"})
+                return
+            try:
+                batch = json.loads(body)
+                collector.ingest(batch)
+            except (ValueError, KeyError, TypeError) as e:
+                with collector.lock:
+                    collector.device_stats("?")["refused"] += 1
+                self.reply(400, {"error": f"bad batch: {e}"})
+                return
+            if args.slow_ms:
+                time.sleep(args.slow_ms / 1000.0)
+            self.reply(200, {"stored": len(batch["readings"])})
+
+        def reply(self, code, obj):
+            data = json.dumps(obj).encode()
+            try:
+                self.send_response(code)
+                self.send_header("Content-Type", "application/json")
+                self.send_header("Content-Length", str(len(data)))
+                self.end_headers()
+                self.wfile.write(data)
+            except (BrokenPipeError, ConnectionResetError):
+                pass   # device gave up waiting (--slow-ms)
+
+        def log_message(self, fmt, *a):
+            if args.verbose:
+                sys.stderr.write("%s %s\n" % (self.address_string(), fmt % a))
+
+    return Handler
+
+def print_summary(collector):
+    for device, s in sorted(collector.summary().items()):
+        print(f"{device}: {s['readings']} readings in {s['batches']} batches, "
+              f"{s['duplicates']} duplicates, {s['gaps']} gaps, {s['boots']} boots, {s['refused']} refused")
+    sys.stdout.flush()
+
+def parse_outage(text):
+    start, duration = text.split(":")
+    return (float(start), float(duration))
+
+# ===== Self-test =====
+def post(url, batch):
+    req = urllib.request.Request(url, data=json.dumps(batch).encode(), method="POST",
+                                 headers={"Content-Type": "application/json"})
+    try:
+        with urllib.request.urlopen(req, timeout=5) as r:
+            return r.status
+    except urllib.error.HTTPError as e:
+        return e.code
+
+def self_test():
+    def batch(boot, seqs):
+        return {"device": "test", "station": "bench", "boot": boot,
+                "readings": [{"seq": s, "t_ms": s * 1000, "speed_mph": 1.0} for s in seqs]}
+
+    collector = Collector(sample_ms=1000)
+    args = argparse.Namespace(outage=None, fail_rate=0.0, slow_ms=0, verbose=False)
+    httpd = ThreadingHTTPServer(("127.0.0.1", 0), make_handler(collector, args, time.time()))
+    threading.Thread(target=httpd.serve_forever, daemon=True).start()
+    url = f"http://127.0.0.1:{httpd.server_address[1]}/ingest"
+
+    codes = [
+        post(url, batch(1, range(1, 17))),
+        post(url, batch(1, range(1, 17))),      # retry of a batch whose response was lost
+        post(url, batch(1, range(17, 33))),
+        post(url, batch(1, range(40, 50))),     # readings dropped on the device
+        post(url, batch(2, range(5, 10))),      # reboot: new boot id
+    ]
+    args.outage = (0, 3600)
+    codes.append(post(url, batch(2, range(10, 15))))
+    args.outage = None
+    codes.append(post(url, {"device": "test"}))
+    httpd.shutdown()
+
+    s = collector.summary()["test"]
+    checks = [
+        ("status codes", codes == [200, 200, 200, 200, 200, 503, 400]),
+        ("readings", s["readings"] == 16 + 16 + 10 + 5),
+        ("duplicates", s["duplicates"] == 16),
+        ("gaps", s["gaps"] == 1),
+        ("boots", s["boots"] == 2),
+    ]
+    for name, ok in checks:
+        print(f"{name} ... {'ok' if ok else 'FAIL'}")
+    return 0 if all(ok for _, ok in checks) else 1
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in collector for device uploads")
+    parser.add_argument("--port", type=int, default=8090)
+    parser.add_argument("--sample-ms", type=int, default=1000, help="the device's upload_sample_ms")
+    parser.add_argument("--csv", help="append unique readings to this CSV file")
+    parser.add_argument("--outage", type=parse_outage, help="START:DURATION in seconds; answer 503 meanwhile")
+    parser.add_argument("--fail-rate", type=float, default=0.0, help="fraction of batches answered with 503")
+    parser.add_argument("--slow-ms", type=int, default=0, help="delay every response after storing the batch")
+    parser.add_argument("--verbose", action="store_true", help="log every request")
+    parser.add_argument("--self-test", action="store_true")
+    args = parser.parse_args()
+
+    if args.self_test:
+        sys.exit(self_test())
+
+    collector = Collector(args.sample_ms, args.csv)
+    httpd = ThreadingHTTPServer(("0.0.0.0", args.port), make_handler(collector, args, time.time()))
+    threading.Thread(target=httpd.serve_forever, daemon=True).start()
+    print(f"Collector listening on port {args.port}")
+    try:
+        while True:
+            time.sleep(10)
+            print_summary(collector)
+    except KeyboardInterrupt:
+        pass
+    httpd.shutdown()
+    print_summary(collector)
+
+if __name__ == "__main__":
+    main()
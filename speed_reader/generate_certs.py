@@ -1,28 +1,43 @@
 
 import os
+import argparse
 import datetime
 import ipaddress
 
 # This script generates a simple self-signed certificate and private key in DER format
 # for use with the ESP32 HTTPS server. 
 # It requires the 'cryptography' library. If not installed, run: pip install cryptography
+#
+# Key types (--type):
+#   ec       ECDSA P-256 (default). Fastest handshakes and smallest buffers on the ESP32.
+#   rsa      RSA 2048. Works, but each handshake spends hundreds of ms signing.
+#   ed25519  For host-side benchmarks only; the device's TLS stack can't use it.
 
 try:
     from cryptography import x509
     from cryptography.x509.oid import NameOID
     from cryptography.hazmat.primitives import hashes
     from cryptography.hazmat.primitives import serialization
-    from cryptography.hazmat.primitives.asymmetric import ec
+    from cryptography.hazmat.primitives.asymmetric import ec, rsa, ed25519
 except ImportError:
     print("Error: 'cryptography' library not found.")
     print("Please install it by running: pip install cryptography")
     exit(1)
 
-def generate_self_signed_cert():
+KEY_TYPES = ("ec", "rsa", "ed25519")
+
+def generate_key(key_type):
+    if key_type == "rsa":
+        print("Generating RSA Private Key (2048 bit)...")
+        return rsa.generate_private_key(public_exponent=65537, key_size=2048)
+    if key_type == "ed25519":
+        print("Generating Ed25519 Private Key (host benchmarks only)...")
+        return ed25519.Ed25519PrivateKey.generate()
     print("Generating Elliptic Curve Private Key (secp256r1)...")
-    key = ec.generate_private_key(
-        ec.SECP256R1()
-    )
+    return ec.generate_private_key(ec.SECP256R1())
+
+def generate_self_signed_cert(key_type="ec", out_dir="data"):
+    key = generate_key(key_type)
 
     print("Generating Self-Signed Certificate...")
     subject = issuer = x509.Name([
@@ -53,29 +68,44 @@ def generate_self_signed_cert():
             x509.IPAddress(ipaddress.IPv4Address(u"10.2.1.79"))
         ]),
         critical=False,
-    ).sign(key, hashes.SHA256())
+    ).sign(key, None if key_type == "ed25519" else hashes.SHA256())
 
-    # Ensure data directory exists
-    os.makedirs("data", exist_ok=True)
+    # Ensure output directory exists
+    os.makedirs(out_dir, exist_ok=True)
 
-    print("Saving to data/key.der...")
-    with open("data/key.der", "wb") as f:
+    print(f"Saving to {out_dir}/key.der...")
+    with open(os.path.join(out_dir, "key.der"), "wb") as f:
         f.write(key.private_bytes(
             encoding=serialization.Encoding.DER,
             format=serialization.PrivateFormat.PKCS8,
             encryption_algorithm=serialization.NoEncryption(),
         ))
 
-    print("Saving to data/cert.der...")
-    with open("data/cert.der", "wb") as f:
+    print(f"Saving to {out_dir}/cert.der...")
+    with open(os.path.join(out_dir, "cert.der"), "wb") as f:
         f.write(cert.public_bytes(serialization.Encoding.DER))
 
-    print("Saving to data/cert.pem...")
-    with open("data/cert.pem", "wb") as f:
+    print(f"Saving to {out_dir}/cert.pem...")
+    with open(os.path.join(out_dir, "cert.pem"), "wb") as f:
         f.write(cert.public_bytes(serialization.Encoding.PEM))
 
-    print("\nSuccess! Files generated in the 'data' folder.")
-    print("Now run: build.bat -UploadData")
+    # PEM key for host-side servers (benchmark_tls.py --local); kept out of
+    # data/ so it isn't uploaded to SPIFFS
+    if out_dir != "data":
+        with open(os.path.join(out_dir, "key.pem"), "wb") as f:
+            f.write(key.private_bytes(
+                encoding=serialization.Encoding.PEM,
+                format=serialization.PrivateFormat.PKCS8,
+                encryption_algorithm=serialization.NoEncryption(),
+            ))
+
+    print(f"\nSuccess! Files generated in the '{out_dir}' folder.")
+    if out_dir == "data":
+        print("Now run: build.bat -UploadData")
 
 if __name__ == "__main__":
-    generate_self_signed_cert()
+    parser = argparse.ArgumentParser(description="Generate a self-signed HTTPS certificate")
+    parser.add_argument("--type", choices=KEY_TYPES, default="ec", help="key type (default: ec = ECDSA P-256)")
+    parser.add_argument("--out", default="data", help="output folder (default: data)")
+    args = parser.parse_args()
+    generate_self_signed_cert(args.type, args.out)
@@ -2,6 +2,9 @@
 #include <Wire.h>
 #include <math.h>
 #include "globals.h"
+#include "SR_Metrics.h"
+#include "SR_Profiler.h"
+#include "SR_Log.h"
 
 #define ACCEL_ADDR 0x68
 #define MPU6050_PWR_MGMT_1 0x6B
@@ -43,7 +46,7 @@ bool writeAccelRegister(uint8_t reg, uint8_t value) {
 }
 
 void initAccelerometer() {
-  Serial.println("Initializing GY-521 (MPU6050)...");
+  LOG_I("Accel", "Initializing GY-521 (MPU6050)...");
   
   // Initialize I2C with defined pins
   Wire.begin(I2C_SDA, I2C_SCL);
@@ -53,7 +56,7 @@ void initAccelerometer() {
   // Check if device is reachable
   Wire.beginTransmission(ACCEL_ADDR);
   if (Wire.endTransmission() != 0) {
-      Serial.println("GY-521 (MPU6050) not found. Accelerometer disabled.");
+      LOG_E("Accel", "GY-521 (MPU6050) not found. Accelerometer disabled.");
       isAccelConnected = false;
       return;
   }
@@ -76,10 +79,11 @@ void initAccelerometer() {
   
   isAccelConnected = true;
   last_update_micros = micros();
-  Serial.println("GY-521 init done.");
+  LOG_I("Accel", "GY-521 init done.");
 }
 
 void updateAngle() {
+  PROFILE_SCOPE(PROF_UPDATE_ANGLE);
   if (!isAccelConnected) return;
 
   unsigned long now = micros();
@@ -193,7 +197,7 @@ void updateAngle() {
     float finalAngle = smoothedAngle;
     if (finalAngle < 0.2f && finalAngle > -0.2f) finalAngle = 0.0f;
     
-    if (xSemaphoreTake(dataMutex, 0) == pdTRUE) {
+    if (takeMutex(dataMutex, MUTEX_DATA, 0)) {
       currentAngle = finalAngle;
       currentVibration = smoothed_vib + vibrationOffset;
       if (currentVibration > maxVibration) maxVibration = currentVibration;
@@ -207,7 +211,7 @@ void updateAngle() {
 void calibrateAccelerometer(int samples) {
     if (!isAccelConnected) return;
 
-    Serial.println("Calibrating 3D Vector...");
+    LOG_I("Accel", "Calibrating 3D Vector...");
     
     // Warmup
     for(int i=0; i<100; i++) {
@@ -265,5 +269,5 @@ void calibrateAccelerometer(int samples) {
     est_y = base_y;
     est_z = base_z;
     
-    Serial.println("Calibration Done.");
+    LOG_I("Accel", "Calibration Done.");
 }
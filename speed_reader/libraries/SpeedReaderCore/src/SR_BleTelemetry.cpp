@@ -0,0 +1,183 @@
+#include "SR_BleTelemetry.h"
+#include "globals.h"
+
+#if ENABLE_BT
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLE2902.h>
+#include <BLESecurity.h>
+#include "SR_Readings.h"
+#include "SR_ReadingCodec.h"
+#include "SR_Session.h"
+#include "SR_Worker.h"
+#include "SR_Log.h"
+
+static TaskHandle_t bleTaskHandle = NULL;
+static BLEServer* bleServer = NULL;
+static BLECharacteristic* readingsChar = NULL;
+static BLECharacteristic* rateChar = NULL;
+
+static volatile bool centralConnected = false;
+static volatile uint16_t notifyIntervalMs = 0;
+
+// ===== Session commands =====
+// Writes arrive on the BLE stack's task; the session work (flash, LCD)
+// runs on the worker instead
+static void deferredStart(void* arg) {
+  char* job = (char*)arg;
+  startSession(job);
+  free(job);
+}
+
+static void deferredStop(void*) {
+  if (sessionActive) endSession();
+}
+
+// The passkey, or -1 unless ble_pin is exactly six digits
+static long parsePin(const char* pin) {
+  if (strlen(pin) != 6) return -1;
+  for (int i = 0; i < 6; i++) {
+    if (pin[i] < '0' || pin[i] > '9') return -1;
+  }
+  return atol(pin);
+}
+
+static void setRate(uint16_t ms) {
+  if (ms < publishIntervalMs) ms = publishIntervalMs;
+  if (ms > 60000) ms = 60000;
+  notifyIntervalMs = ms;
+  uint8_t le[2] = { (uint8_t)(ms & 0xFF), (uint8_t)(ms >> 8) };
+  rateChar->setValue(le, sizeof(le));
+}
+
+class StartCallbacks : public BLECharacteristicCallbacks {
+  void onWrite(BLECharacteristic* c) override {
+    size_t len = c->getLength();
+    if (len == 0 || len >= sizeof(currentJob)) {
+      LOG_W("BLE", "start ignored, job name must be 1-%u bytes",
+            (unsigned)sizeof(currentJob) - 1);
+      return;
+    }
+    char* job = (char*)malloc(len + 1);
+    if (!job) return;
+    memcpy(job, c->getData(), len);
+    job[len] = '\0';
+    if (!runDeferred(deferredStart, job)) free(job);
+  }
+};
+
+class StopCallbacks : public BLECharacteristicCallbacks {
+  void onWrite(BLECharacteristic*) override {
+    runDeferred(deferredStop);
+  }
+};
+
+class RateCallbacks : public BLECharacteristicCallbacks {
+  void onWrite(BLECharacteristic* c) override {
+    if (c->getLength() < 2) return;
+    const uint8_t* d = c->getData();
+    setRate((uint16_t)(d[0] | (d[1] << 8)));
+  }
+};
+
+class ServerCallbacks : public BLEServerCallbacks {
+  void onConnect(BLEServer*) override {
+    setRate((uint16_t)bleIntervalMs);
+    centralConnected = true;
+  }
+  void onDisconnect(BLEServer*) override {
+    centralConnected = false;
+    // Stops advertising on connect; one central at a time
+    BLEDevice::startAdvertising();
+  }
+};
+
+// ===== Notify task =====
+static void bleTelemetryTask(void* parameter) {
+  uint8_t value[sizeof(CompactReading)];
+  uint32_t lastSeq = 0;
+  unsigned long lastNotifyMs = 0;
+
+  subscribeReadings(xTaskGetCurrentTaskHandle());
+
+  while (true) {
+    // Woken by each published reading
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+    unsigned long now = millis();
+    if (now - lastNotifyMs < notifyIntervalMs) continue;
+
+    uint32_t seq = latestReadingSeq();
+    Reading r;
+    if (seq == lastSeq || !getReading(seq, r)) continue;
+    if (encodeReadingCompact(r, value, sizeof(value)) == 0) continue;
+
+    // Kept current for READ even with nobody subscribed
+    readingsChar->setValue(value, sizeof(value));
+    if (centralConnected) readingsChar->notify();
+    lastSeq = seq;
+    lastNotifyMs = now;
+  }
+}
+
+bool startBleTelemetry() {
+  if (bleTaskHandle) return true;
+
+  LOG_I("BLE", "Starting BLE as '%s'...", deviceName);
+  BLEDevice::init(deviceName);
+  bleServer = BLEDevice::createServer();
+  if (!bleServer) {
+    LOG_E("BLE", "init FAILED");
+    return false;
+  }
+  bleServer->setCallbacks(new ServerCallbacks());
+
+  // Static passkey pairing: the stack only lets a central that entered
+  // the PIN (MITM-protected, encrypted link) write the characteristics
+  // below
+  long pin = parsePin(blePin);
+  if (pin >= 0) {
+    BLESecurity* security = new BLESecurity();
+    security->setStaticPIN((uint32_t)pin);
+  } else {
+    LOG_W("BLE", "ble_pin is not 6 digits, start/stop/rate writes are refused");
+  }
+  const esp_gatt_perm_t writePerm = ESP_GATT_PERM_WRITE_ENC_MITM;
+
+  BLEService* service = bleServer->createService(BLE_SERVICE_UUID);
+  readingsChar = service->createCharacteristic(
+      BLE_READINGS_UUID, BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY);
+  readingsChar->addDescriptor(new BLE2902());
+
+  BLECharacteristic* startChar =
+      service->createCharacteristic(BLE_START_UUID, BLECharacteristic::PROPERTY_WRITE);
+  startChar->setAccessPermissions(writePerm);
+  startChar->setCallbacks(new StartCallbacks());
+
+  BLECharacteristic* stopChar =
+      service->createCharacteristic(BLE_STOP_UUID, BLECharacteristic::PROPERTY_WRITE);
+  stopChar->setAccessPermissions(writePerm);
+  stopChar->setCallbacks(new StopCallbacks());
+
+  rateChar = service->createCharacteristic(
+      BLE_RATE_UUID, BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_WRITE);
+  rateChar->setAccessPermissions(ESP_GATT_PERM_READ | writePerm);
+  rateChar->setCallbacks(new RateCallbacks());
+  setRate((uint16_t)bleIntervalMs);
+
+  service->start();
+  BLEAdvertising* adv = BLEDevice::getAdvertising();
+  adv->addServiceUUID(BLE_SERVICE_UUID);
+  adv->setScanResponse(true);
+  BLEDevice::startAdvertising();
+
+  xTaskCreatePinnedToCore(bleTelemetryTask, "BleTelemetry", 3072, NULL, 1, &bleTaskHandle, 0);
+  LOG_I("BLE", "BLE telemetry advertising, notify every %d ms", bleIntervalMs);
+  return true;
+}
+
+#else
+
+bool startBleTelemetry() { return false; }
+
+#endif // ENABLE_BT
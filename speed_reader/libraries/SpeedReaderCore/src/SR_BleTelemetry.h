@@ -0,0 +1,32 @@
+#ifndef SR_BLE_TELEMETRY_H
+#define SR_BLE_TELEMETRY_H
+
+#include <Arduino.h>
+
+// ===== BLE telemetry service =====
+// A GATT service (ENABLE_BT) for phones and tablets next to the machine:
+//
+//   readings  READ | NOTIFY   CompactReading, 20 bytes (SR_ReadingCodec.h)
+//   start     WRITE*          job name, 1-31 bytes UTF-8; starts a session
+//   stop      WRITE*          any value; ends the session
+//   rate      READ | WRITE*   notify interval in ms, uint16 little-endian
+//
+// * Writes need an encrypted link paired with passkey entry (MITM
+//   protection) using the 6-digit ble_pin; bonds are kept. Without a
+//   valid ble_pin no central can pair that way, so writes are refused and
+//   the service is read-only.
+//
+// A notification fits the default 23-byte ATT MTU, so no MTU exchange is
+// needed. The rate starts at ble_interval_ms for each connection and is
+// not saved. Advertising restarts when the central disconnects.
+
+#define BLE_SERVICE_UUID   "5352a001-5f3c-4d1e-9a55-7b1f0c2e8d40"
+#define BLE_READINGS_UUID  "5352a002-5f3c-4d1e-9a55-7b1f0c2e8d40"
+#define BLE_START_UUID     "5352a003-5f3c-4d1e-9a55-7b1f0c2e8d40"
+#define BLE_STOP_UUID      "5352a004-5f3c-4d1e-9a55-7b1f0c2e8d40"
+#define BLE_RATE_UUID      "5352a005-5f3c-4d1e-9a55-7b1f0c2e8d40"
+
+// Returns false if the BLE stack could not be started
+bool startBleTelemetry();
+
+#endif // SR_BLE_TELEMETRY_H
@@ -0,0 +1,138 @@
+#include "SR_CertInfo.h"
+#include <string.h>
+
+// Object identifiers (DER contents, without tag and length)
+static const uint8_t OID_RSA[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x01 };
+static const uint8_t OID_EC[] = { 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x02, 0x01 };
+static const uint8_t OID_P256[] = { 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x03, 0x01, 0x07 };
+static const uint8_t OID_ED25519[] = { 0x2B, 0x65, 0x70 };
+
+enum DerTag : uint8_t {
+  DER_INTEGER = 0x02,
+  DER_OCTET_STRING = 0x04,
+  DER_OID = 0x06,
+  DER_SEQUENCE = 0x30,
+  DER_CONTEXT_0 = 0xA0
+};
+
+struct DerItem {
+  uint8_t tag;
+  const uint8_t* data;
+  size_t len;
+};
+
+// Reads one TLV from [p, end); advances p past it
+static bool readItem(const uint8_t*& p, const uint8_t* end, DerItem& item) {
+  if (end - p < 2) return false;
+  item.tag = *p++;
+  size_t len = *p++;
+  if (len & 0x80) {
+    size_t n = len & 0x7F;
+    if (n == 0 || n > 3 || (size_t)(end - p) < n) return false;
+    len = 0;
+    while (n--) len = (len << 8) | *p++;
+  }
+  if ((size_t)(end - p) < len) return false;
+  item.data = p;
+  item.len = len;
+  p += len;
+  return true;
+}
+
+static bool oidEquals(const DerItem& item, const uint8_t* oid, size_t len) {
+  return item.tag == DER_OID && item.len == len && memcmp(item.data, oid, len) == 0;
+}
+
+static uint16_t integerBits(const DerItem& item) {
+  size_t len = item.len;
+  const uint8_t* p = item.data;
+  while (len > 0 && *p == 0) {
+    p++;
+    len--;
+  }
+  if (len == 0) return 0;
+  uint16_t bits = (uint16_t)(len * 8);
+  for (uint8_t top = *p; !(top & 0x80); top <<= 1) bits--;
+  return bits;
+}
+
+// PKCS#1 RSAPrivateKey: SEQUENCE { version, modulus, ... }
+static bool parseRsaKey(const uint8_t* p, const uint8_t* end, KeyInfo& out) {
+  DerItem seq, version, modulus;
+  if (!readItem(p, end, seq) || seq.tag != DER_SEQUENCE) return false;
+  const uint8_t* q = seq.data;
+  const uint8_t* qEnd = seq.data + seq.len;
+  if (!readItem(q, qEnd, version) || version.tag != DER_INTEGER) return false;
+  if (!readItem(q, qEnd, modulus) || modulus.tag != DER_INTEGER) return false;
+  out.type = KEY_RSA;
+  out.bits = integerBits(modulus);
+  return true;
+}
+
+// SEC1 ECPrivateKey: SEQUENCE { 1, OCTET STRING key, [0] curve OID, ... }
+static bool parseEcKey(const uint8_t* p, const uint8_t* end, const DerItem* curve, KeyInfo& out) {
+  DerItem seq, version, key, item;
+  if (!readItem(p, end, seq) || seq.tag != DER_SEQUENCE) return false;
+  const uint8_t* q = seq.data;
+  const uint8_t* qEnd = seq.data + seq.len;
+  if (!readItem(q, qEnd, version) || version.tag != DER_INTEGER) return false;
+  if (!readItem(q, qEnd, key) || key.tag != DER_OCTET_STRING) return false;
+
+  DerItem inner;
+  while (!curve && readItem(q, qEnd, item)) {
+    const uint8_t* r = item.data;
+    if (item.tag == DER_CONTEXT_0 && readItem(r, item.data + item.len, inner)) curve = &inner;
+  }
+  bool p256 = curve ? oidEquals(*curve, OID_P256, sizeof(OID_P256)) : key.len == 32;
+  out.type = p256 ? KEY_EC_P256 : KEY_EC_OTHER;
+  out.bits = (uint16_t)(key.len * 8);
+  return true;
+}
+
+bool parsePrivateKey(const uint8_t* der, size_t len, KeyInfo& out) {
+  out.type = KEY_UNKNOWN;
+  out.bits = 0;
+
+  const uint8_t* p = der;
+  const uint8_t* end = der + len;
+  DerItem seq, version, next;
+  if (!readItem(p, end, seq) || seq.tag != DER_SEQUENCE) return false;
+  const uint8_t* q = seq.data;
+  const uint8_t* qEnd = seq.data + seq.len;
+  if (!readItem(q, qEnd, version) || version.tag != DER_INTEGER) return false;
+  if (!readItem(q, qEnd, next)) return false;
+
+  if (next.tag == DER_INTEGER) return parseRsaKey(der, end, out);
+  if (next.tag == DER_OCTET_STRING) return parseEcKey(der, end, NULL, out);
+  if (next.tag != DER_SEQUENCE) return false;
+
+  // PKCS#8: SEQUENCE { version, AlgorithmIdentifier, OCTET STRING key }
+  DerItem alg, params, key;
+  const uint8_t* a = next.data;
+  const uint8_t* aEnd = next.data + next.len;
+  if (!readItem(a, aEnd, alg)) return false;
+  bool hasParams = readItem(a, aEnd, params);
+  if (!readItem(q, qEnd, key) || key.tag != DER_OCTET_STRING) return false;
+  const uint8_t* keyEnd = key.data + key.len;
+
+  if (oidEquals(alg, OID_RSA, sizeof(OID_RSA))) return parseRsaKey(key.data, keyEnd, out);
+  if (oidEquals(alg, OID_EC, sizeof(OID_EC))) {
+    return parseEcKey(key.data, keyEnd, hasParams ? &params : NULL, out);
+  }
+  if (oidEquals(alg, OID_ED25519, sizeof(OID_ED25519))) {
+    out.type = KEY_ED25519;
+    out.bits = 255;
+    return true;
+  }
+  return false;
+}
+
+const char* keyTypeName(KeyType type) {
+  switch (type) {
+    case KEY_RSA:      return "rsa";
+    case KEY_EC_P256:  return "ecdsa-p256";
+    case KEY_EC_OTHER: return "ec";
+    case KEY_ED25519:  return "ed25519";
+    default:           return "unknown";
+  }
+}
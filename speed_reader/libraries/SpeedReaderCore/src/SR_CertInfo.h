@@ -0,0 +1,30 @@
+#ifndef SR_CERT_INFO_H
+#define SR_CERT_INFO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== Private key identification =====
+// Reads just enough of a DER private key (PKCS#8, SEC1 or PKCS#1) to tell
+// which algorithm it is, so the TLS setup can pick matching cipher suites
+// and refuse keys the device cannot use. No Arduino dependencies.
+
+enum KeyType : uint8_t {
+  KEY_UNKNOWN = 0,
+  KEY_RSA,
+  KEY_EC_P256,
+  KEY_EC_OTHER,     // EC on a curve other than P-256
+  KEY_ED25519
+};
+
+struct KeyInfo {
+  KeyType type;
+  uint16_t bits;    // RSA modulus or EC field size
+};
+
+bool parsePrivateKey(const uint8_t* der, size_t len, KeyInfo& out);
+
+// "rsa", "ecdsa-p256", "ec", "ed25519" or "unknown"
+const char* keyTypeName(KeyType type);
+
+#endif // SR_CERT_INFO_H
@@ -0,0 +1,192 @@
+#include "SR_CertStore.h"
+
+#if ENABLE_HTTP
+#include <SPIFFS.h>
+#include <esp_partition.h>
+#include "SR_Crc.h"
+#include "SR_Log.h"
+
+static const char* CERT_PARTITION = "certs";
+static const uint8_t CERT_PARTITION_SUBTYPE = 0x40;   // first custom data subtype
+static const uint32_t CERT_MAGIC = 0x4B435253;        // "SRCK"
+static const uint8_t CERT_VERSION = 1;
+static const size_t CERT_MAX_LEN = 0xFFFF;            // SSLCert lengths are uint16_t
+static const size_t COPY_CHUNK = 256;
+
+struct __attribute__((packed)) CertHeader {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t reserved[3];
+  uint32_t certLen;
+  uint32_t keyLen;
+  uint32_t crc;        // CRC-32 over cert then key
+};
+
+// Partition layout: [CertHeader][cert][key]
+
+// ===== SPIFFS files =====
+static bool fileCrc(const char* path, uint32_t& crc, size_t& len) {
+  File f = SPIFFS.open(path, "r");
+  if (!f) return false;
+  uint8_t buf[COPY_CHUNK];
+  len = 0;
+  size_t n;
+  while ((n = f.read(buf, sizeof(buf))) > 0) {
+    crc = srCrc32(buf, n, crc);
+    len += n;
+  }
+  f.close();
+  return true;
+}
+
+static bool copyFileToPartition(const esp_partition_t* part, const char* path, size_t offset, size_t len) {
+  File f = SPIFFS.open(path, "r");
+  if (!f) return false;
+  uint8_t buf[COPY_CHUNK];
+  size_t done = 0;
+  while (done < len) {
+    size_t n = f.read(buf, sizeof(buf));
+    if (n == 0 || esp_partition_write(part, offset + done, buf, n) != ESP_OK) break;
+    done += n;
+  }
+  f.close();
+  return done == len;
+}
+
+// ===== Partition =====
+static bool readHeader(const esp_partition_t* part, CertHeader& h) {
+  if (esp_partition_read(part, 0, &h, sizeof(h)) != ESP_OK) return false;
+  return h.magic == CERT_MAGIC && h.version == CERT_VERSION &&
+         h.certLen > 0 && h.certLen <= CERT_MAX_LEN &&
+         h.keyLen > 0 && h.keyLen <= CERT_MAX_LEN &&
+         sizeof(h) + h.certLen + h.keyLen <= part->size;
+}
+
+// Copies the SPIFFS files into the partition if they differ from it
+static void importFromSpiffs(const esp_partition_t* part) {
+  if (!SPIFFS.exists("/cert.der") || !SPIFFS.exists("/key.der")) return;
+
+  uint32_t crc = 0;
+  size_t certLen = 0, keyLen = 0;
+  if (!fileCrc("/cert.der", crc, certLen) || !fileCrc("/key.der", crc, keyLen)) return;
+
+  CertHeader current;
+  if (readHeader(part, current) && current.crc == crc &&
+      current.certLen == certLen && current.keyLen == keyLen) {
+    return;
+  }
+
+  if (certLen == 0 || keyLen == 0 || certLen > CERT_MAX_LEN || keyLen > CERT_MAX_LEN ||
+      sizeof(CertHeader) + certLen + keyLen > part->size) {
+    LOG_E("Cert", "Cert/key too large for the certs partition (%u + %u bytes)",
+          (unsigned)certLen, (unsigned)keyLen);
+    return;
+  }
+
+  LOG_I("Cert", "Importing cert/key from SPIFFS into flash...");
+  size_t total = sizeof(CertHeader) + certLen + keyLen;
+  size_t eraseLen = (total + SPI_FLASH_SEC_SIZE - 1) & ~(SPI_FLASH_SEC_SIZE - 1);
+  if (esp_partition_erase_range(part, 0, eraseLen) != ESP_OK) return;
+
+  // Header last, so an interrupted import leaves no valid record
+  CertHeader h = {};
+  h.magic = CERT_MAGIC;
+  h.version = CERT_VERSION;
+  h.certLen = certLen;
+  h.keyLen = keyLen;
+  h.crc = crc;
+  if (copyFileToPartition(part, "/cert.der", sizeof(h), certLen) &&
+      copyFileToPartition(part, "/key.der", sizeof(h) + certLen, keyLen) &&
+      esp_partition_write(part, 0, &h, sizeof(h)) == ESP_OK) {
+    LOG_I("Cert", "Cert/key imported.");
+  } else {
+    LOG_E("Cert", "Cert/key import failed");
+  }
+}
+
+static bool mapPartition(const esp_partition_t* part, SSLCert& out) {
+  CertHeader h;
+  if (!readHeader(part, h)) return false;
+
+  // The mapping is kept for the lifetime of the server, so the handle is
+  // never released
+  const void* mapped = NULL;
+  esp_partition_mmap_handle_t handle;
+  size_t len = sizeof(h) + h.certLen + h.keyLen;
+  if (esp_partition_mmap(part, 0, len, ESP_PARTITION_MMAP_DATA, &mapped, &handle) != ESP_OK) {
+    return false;
+  }
+
+  const uint8_t* certData = (const uint8_t*)mapped + sizeof(h);
+  const uint8_t* keyData = certData + h.certLen;
+  uint32_t crc = srCrc32(certData, h.certLen);
+  if (srCrc32(keyData, h.keyLen, crc) != h.crc) {
+    LOG_E("Cert", "Cert/key in flash failed CRC check");
+    esp_partition_munmap(handle);
+    return false;
+  }
+
+  // The TLS stack only reads these
+  out = SSLCert((unsigned char*)certData, (uint16_t)h.certLen,
+                (unsigned char*)keyData, (uint16_t)h.keyLen);
+  return true;
+}
+
+// ===== Heap fallback =====
+static uint8_t* loadFile(const char* path, size_t& len) {
+  File f = SPIFFS.open(path, "r");
+  if (!f) return NULL;
+  len = f.size();
+  uint8_t* data = NULL;
+  if (len > 0 && len <= CERT_MAX_LEN) {
+    data = new uint8_t[len];
+    if (data && f.read(data, len) != len) {
+      delete[] data;
+      data = NULL;
+    }
+  } else {
+    LOG_E("Cert", "%s has unsupported size %u", path, (unsigned)len);
+  }
+  f.close();
+  return data;
+}
+
+static bool loadFromSpiffs(SSLCert& out) {
+  if (!SPIFFS.exists("/cert.der") || !SPIFFS.exists("/key.der")) return false;
+  size_t certLen = 0, keyLen = 0;
+  uint8_t* certData = loadFile("/cert.der", certLen);
+  uint8_t* keyData = loadFile("/key.der", keyLen);
+  if (!certData || !keyData) {
+    delete[] certData;
+    delete[] keyData;
+    return false;
+  }
+  out = SSLCert(certData, (uint16_t)certLen, keyData, (uint16_t)keyLen);
+  return true;
+}
+
+// ===== Public =====
+CertSource loadCertificate(SSLCert& out) {
+  const esp_partition_t* part = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)CERT_PARTITION_SUBTYPE, CERT_PARTITION);
+
+  if (part) {
+    importFromSpiffs(part);
+    if (mapPartition(part, out)) return CERT_FLASH;
+    LOG_W("Cert", "No valid cert/key in the certs partition");
+  } else {
+    LOG_I("Cert", "No certs partition, loading cert/key onto the heap");
+  }
+
+  return loadFromSpiffs(out) ? CERT_HEAP : CERT_NONE;
+}
+
+const char* certSourceName(CertSource source) {
+  switch (source) {
+    case CERT_FLASH: return "flash";
+    case CERT_HEAP:  return "heap";
+    default:         return "none";
+  }
+}
+
+#endif // ENABLE_HTTP
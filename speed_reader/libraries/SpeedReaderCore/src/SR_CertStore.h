@@ -0,0 +1,32 @@
+#ifndef SR_CERT_STORE_H
+#define SR_CERT_STORE_H
+
+#include "globals.h"
+
+#if ENABLE_HTTP
+#include <SSLCert.hpp>
+
+// ===== TLS credential storage =====
+// The certificate and key live in their own flash partition ("certs", see
+// partitions.csv) and are handed to the TLS stack through a read-only
+// memory-mapped pointer, so they take no heap.
+//
+// /cert.der and /key.der on SPIFFS are the provisioning path: when present
+// and different from the partition contents they are copied into the
+// partition at boot. Without a certs partition (stock partition scheme)
+// the files are loaded onto the heap as before.
+
+enum CertSource : uint8_t {
+  CERT_NONE = 0,
+  CERT_FLASH,       // mapped from the certs partition
+  CERT_HEAP         // loaded from SPIFFS onto the heap
+};
+
+// Fills `out` with the credentials; returns where they came from
+CertSource loadCertificate(SSLCert& out);
+
+const char* certSourceName(CertSource source);
+
+#endif // ENABLE_HTTP
+
+#endif // SR_CERT_STORE_H
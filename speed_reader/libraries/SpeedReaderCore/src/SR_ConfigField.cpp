@@ -0,0 +1,59 @@
+#include "SR_ConfigSchema.h"
+#include <string.h>
+#include <math.h>
+
+// ===== Parse / format =====
+// Works on a field's own storage only, so host tools can exercise it with
+// fields of their own (tools/sr_config_test.cpp).
+
+ConfigSetResult configFieldSet(const ConfigField& field, const JsonToken& value) {
+  // An explicit "" or null clears a string; numbers and bools keep their
+  // value. Members left out of the request never get here.
+  if (value.len == 0 || value.type == JSON_NULL) {
+    if (field.type != CFG_STRING) return CFG_SET_EMPTY;
+    if (field.flags & CFG_REQUIRED) return CFG_SET_INVALID;
+    ((char*)field.ptr)[0] = '\0';
+    return CFG_SET_OK;
+  }
+
+  switch (field.type) {
+    case CFG_STRING: {
+      char tmp[160];
+      if (field.size > sizeof(tmp) || !value.copyTo(tmp, field.size)) return CFG_SET_INVALID;
+      if (tmp[0] == '\0' && (field.flags & CFG_REQUIRED)) return CFG_SET_INVALID;
+      strcpy((char*)field.ptr, tmp);
+      return CFG_SET_OK;
+    }
+    case CFG_FLOAT: {
+      float f;
+      // NaN passes every range comparison; "nan" and "inf" parse as floats
+      if (!value.toFloat(f) || !isfinite(f)) return CFG_SET_INVALID;
+      if (f < field.minVal || f > field.maxVal) return CFG_SET_OUT_OF_RANGE;
+      *(float*)field.ptr = f;
+      return CFG_SET_OK;
+    }
+    case CFG_INT: {
+      long l;
+      if (!value.toLong(l)) return CFG_SET_INVALID;
+      if (l < field.minVal || l > field.maxVal) return CFG_SET_OUT_OF_RANGE;
+      *(int*)field.ptr = (int)l;
+      return CFG_SET_OK;
+    }
+    case CFG_BOOL: {
+      bool b;
+      if (!value.toBool(b)) return CFG_SET_INVALID;
+      *(bool*)field.ptr = b;
+      return CFG_SET_OK;
+    }
+  }
+  return CFG_SET_INVALID;
+}
+
+void writeConfigField(JsonWriter& w, const ConfigField& field) {
+  switch (field.type) {
+    case CFG_STRING: w.value((const char*)field.ptr); break;
+    case CFG_FLOAT:  w.value(*(const float*)field.ptr, 4); break;
+    case CFG_INT:    w.value(*(const int*)field.ptr); break;
+    case CFG_BOOL:   w.value(*(const bool*)field.ptr); break;
+  }
+}
@@ -0,0 +1,146 @@
+#include "SR_ConfigSchema.h"
+#include <string.h>
+#include "globals.h"
+
+// ===== Field table =====
+// name, type, storage, string size, min, max, flags
+static constexpr ConfigField CONFIG_FIELDS[] = {
+  { "ssid",                CFG_STRING, wifiSSID,           sizeof(wifiSSID),       0, 0, 0 },
+  { "wifi_password",       CFG_STRING, wifiPassword,       sizeof(wifiPassword),   0, 0, CFG_SECRET },
+  { "name",                CFG_STRING, deviceName,         sizeof(deviceName),     0, 0, 0 },
+  { "wifi_ip",             CFG_STRING, wifiIp,             sizeof(wifiIp),         0, 0, 0 },
+  { "wifi_gateway",        CFG_STRING, wifiGateway,        sizeof(wifiGateway),    0, 0, 0 },
+  { "wifi_subnet",         CFG_STRING, wifiSubnet,         sizeof(wifiSubnet),     0, 0, 0 },
+  { "wifi_dns",            CFG_STRING, wifiDns,            sizeof(wifiDns),        0, 0, 0 },
+  { "api_key",             CFG_STRING, apiKey,             sizeof(apiKey),         0, 0, CFG_SECRET | CFG_SHOW_PREFIX | CFG_REQUIRED },
+  { "read_key",            CFG_STRING, readKey,            sizeof(readKey),        0, 0, CFG_SECRET | CFG_SHOW_PREFIX },
+  { "device_password",     CFG_STRING, devicePassword,     sizeof(devicePassword), 0, 0, CFG_SECRET | CFG_REQUIRED },
+  { "register_url",        CFG_STRING, registerUrl,        sizeof(registerUrl),    0, 0, 0 },
+  { "station",             CFG_STRING, station,            sizeof(station),        0, 0, 0 },
+  #if ENABLE_HTTP
+  { "use_https",           CFG_BOOL,   &useHTTPS,          0, 0, 1, 0 },
+  { "lan_http",            CFG_BOOL,   &lanHTTP,           0, 0, 1, 0 },
+  { "http_port",           CFG_INT,    &httpPort,          0, 1, 65535, 0 },
+  { "https_port",          CFG_INT,    &httpsPort,         0, 1, 65535, 0 },
+  #endif
+  { "udp_enabled",         CFG_BOOL,   &udpEnabled,        0, 0, 1, 0 },
+  { "udp_address",         CFG_STRING, udpAddress,         sizeof(udpAddress),     0, 0, 0 },
+  { "udp_port",            CFG_INT,    &udpPort,           0, 1, 65535, 0 },
+  { "udp_interval_ms",     CFG_INT,    &udpIntervalMs,     0, publishIntervalMs, 60000, 0 },
+  { "udp_binary",          CFG_BOOL,   &udpBinary,         0, 0, 1, 0 },
+  #if ENABLE_BT
+  { "ble_interval_ms",     CFG_INT,    &bleIntervalMs,     0, publishIntervalMs, 60000, 0 },
+  { "ble_pin",             CFG_STRING, blePin,             sizeof(blePin),         0, 0, CFG_SECRET },
+  #endif
+  { "serial_binary",       CFG_BOOL,   &serialBinary,      0, 0, 1, 0 },
+  { "serial_baud",         CFG_INT,    &serialBaud,        0, 9600, 3000000, 0 },
+  { "serial_interval_ms",  CFG_INT,    &serialIntervalMs,  0, 2, sensorLoopMs, 0 },
+  { "upload_url",          CFG_STRING, uploadUrl,          sizeof(uploadUrl),      0, 0, 0 },
+  { "upload_sample_ms",    CFG_INT,    &uploadSampleMs,    0, publishIntervalMs, 3600000, 0 },
+  { "upload_batch_ms",     CFG_INT,    &uploadBatchMs,     0, 1000, 3600000, 0 },
+  { "event_rules",         CFG_STRING, eventRules,         sizeof(eventRules),     0, 0, 0 },
+  { "event_webhook",       CFG_STRING, eventWebhook,       sizeof(eventWebhook),   0, 0, 0 },
+  { "ntp_server",          CFG_STRING, ntpServer,          sizeof(ntpServer),      0, 0, 0 },
+  { "ntp_interval_s",      CFG_INT,    &ntpIntervalS,      0, 15, 86400, 0 },
+  { "log_level",           CFG_INT,    &logLevel,          0, 0, 4, 0 },
+  { "speed_offset",        CFG_FLOAT,  &speedOffset,       0, -100.0f, 100.0f, 0 },
+  { "speed_scale",         CFG_FLOAT,  &speedScale,        0, 0.01f, 100.0f, 0 },
+  { "pulses_per_rotation", CFG_INT,    &pulsesPerRotation, 0, 1, 1000, 0 },
+  { "distance_offset",     CFG_FLOAT,  &distanceOffset,    0, -1.0f, 1.0f, 0 },
+  { "angle_offset",        CFG_FLOAT,  &angleOffset,       0, -180.0f, 180.0f, 0 },
+  { "accel_offset",        CFG_FLOAT,  &accelOffset,       0, -1000.0f, 1000.0f, 0 },
+  { "accel_scale",         CFG_FLOAT,  &accelScale,        0, 0.01f, 100.0f, 0 },
+  { "vibration_offset",    CFG_FLOAT,  &vibrationOffset,   0, -10.0f, 10.0f, 0 },
+};
+
+static constexpr size_t FIELD_COUNT = sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]);
+
+// ===== Compile-time perfect hash =====
+// FNV-1a with a seed; the first seed that maps every field name to its own
+// slot is found by the compiler, so lookups are one hash + one strcmp.
+
+static constexpr size_t slotCountFor(size_t n) {
+  size_t s = 1;
+  while (s < n * 2) s <<= 1;
+  return s;
+}
+
+static constexpr size_t SLOT_COUNT = slotCountFor(FIELD_COUNT);
+static_assert(FIELD_COUNT <= CONFIG_MAX_FIELDS && CONFIG_MAX_FIELDS <= 64,
+              "config.json import tracks fields in a 64-bit mask");
+
+static constexpr uint32_t keyHash(const char* s, size_t len, uint32_t seed) {
+  uint32_t h = 2166136261u ^ seed;
+  for (size_t i = 0; i < len; i++) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619u;
+  }
+  // The low bits of a multiply only see low bits; fold the high half in
+  // so the seed actually changes the slot
+  return h ^ (h >> 16);
+}
+
+static constexpr size_t constLength(const char* s) {
+  size_t n = 0;
+  while (s[n]) n++;
+  return n;
+}
+
+static constexpr bool seedIsPerfect(uint32_t seed) {
+  bool used[SLOT_COUNT] = {};
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    const char* name = CONFIG_FIELDS[i].name;
+    size_t slot = keyHash(name, constLength(name), seed) & (SLOT_COUNT - 1);
+    if (used[slot]) return false;
+    used[slot] = true;
+  }
+  return true;
+}
+
+static constexpr uint32_t findPerfectSeed() {
+  for (uint32_t seed = 0; seed < 100000; seed++) {
+    if (seedIsPerfect(seed)) return seed;
+  }
+  return UINT32_MAX;
+}
+
+static constexpr uint32_t HASH_SEED = findPerfectSeed();
+static_assert(HASH_SEED != UINT32_MAX, "no perfect hash seed found for config field names");
+
+struct SlotTable {
+  uint8_t slot[SLOT_COUNT];  // field index + 1, 0 = empty
+};
+
+static constexpr SlotTable buildSlotTable() {
+  SlotTable t = {};
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    const char* name = CONFIG_FIELDS[i].name;
+    t.slot[keyHash(name, constLength(name), HASH_SEED) & (SLOT_COUNT - 1)] = (uint8_t)(i + 1);
+  }
+  return t;
+}
+
+static constexpr SlotTable SLOTS = buildSlotTable();
+
+// ===== Lookup =====
+size_t configFieldCount() {
+  return FIELD_COUNT;
+}
+
+const ConfigField& configFieldAt(size_t index) {
+  return CONFIG_FIELDS[index];
+}
+
+const ConfigField* findConfigField(const char* key, size_t len) {
+  uint8_t entry = SLOTS.slot[keyHash(key, len, HASH_SEED) & (SLOT_COUNT - 1)];
+  if (entry == 0) return NULL;
+  const ConfigField& f = CONFIG_FIELDS[entry - 1];
+  return (strncmp(f.name, key, len) == 0 && f.name[len] == '\0') ? &f : NULL;
+}
+
+const ConfigField* findConfigField(const JsonToken& key) {
+  if (!key.escaped) return findConfigField(key.p, key.len);
+  char buf[40];
+  if (!key.copyTo(buf, sizeof(buf))) return NULL;
+  return findConfigField(buf, strlen(buf));
+}
@@ -0,0 +1,64 @@
+#ifndef SR_CONFIG_SCHEMA_H
+#define SR_CONFIG_SCHEMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SR_Json.h"
+#include "SR_JsonWriter.h"
+
+// ===== Configuration schema =====
+// Every persisted setting is described once, in the table in
+// SR_ConfigSchema.cpp. /config parsing, config.json import, the NVS record
+// and the /config response are all driven from that table, so adding a
+// setting is one line there (plus its global).
+
+enum ConfigType : uint8_t {
+  CFG_STRING,   // char[size]
+  CFG_FLOAT,    // float
+  CFG_INT,      // int
+  CFG_BOOL      // bool
+};
+
+enum ConfigFlags : uint8_t {
+  CFG_SECRET      = 0x01,  // obfuscated at rest, never echoed back
+  CFG_SHOW_PREFIX = 0x02,  // secret whose first 4 chars may be shown
+  CFG_REQUIRED    = 0x04   // string that may not be cleared
+};
+
+struct ConfigField {
+  const char* name;
+  ConfigType type;
+  void* ptr;
+  uint16_t size;     // buffer size for strings
+  float minVal;      // bounds for numbers
+  float maxVal;
+  uint8_t flags;
+};
+
+enum ConfigSetResult : uint8_t {
+  CFG_SET_OK,
+  CFG_SET_EMPTY,        // empty or null number/bool, field left unchanged
+  CFG_SET_INVALID,      // wrong type or does not fit
+  CFG_SET_OUT_OF_RANGE
+};
+
+// Upper bound on the table size; also the most members /config accepts
+static const size_t CONFIG_MAX_FIELDS = 64;
+
+size_t configFieldCount();
+const ConfigField& configFieldAt(size_t index);
+
+// Perfect-hash lookup; returns NULL for unknown keys
+const ConfigField* findConfigField(const char* key, size_t len);
+const ConfigField* findConfigField(const JsonToken& key);
+
+// Parses and range-checks the value into the field. For strings an
+// explicit "" or null clears the setting (rejected for CFG_REQUIRED);
+// for numbers and bools it is CFG_SET_EMPTY and the value is kept.
+ConfigSetResult configFieldSet(const ConfigField& field, const JsonToken& value);
+
+// Writes the field's current value as the next JSON value. This and
+// configFieldSet live in SR_ConfigField.cpp, free of Arduino dependencies.
+void writeConfigField(JsonWriter& w, const ConfigField& field);
+
+#endif // SR_CONFIG_SCHEMA_H
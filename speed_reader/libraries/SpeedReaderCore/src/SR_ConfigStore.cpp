@@ -0,0 +1,203 @@
+#include "SR_ConfigStore.h"
+#include <Preferences.h>
+#include "globals.h"
+#include "SR_Crc.h"
+#include "SR_ConfigSchema.h"
+#include "SR_Log.h"
+#include "SR_Metrics.h"
+
+static const char* CONFIG_NAMESPACE = "speedreader";
+static const char* CONFIG_KEY = "cfg";
+static const uint16_t CONFIG_MAGIC = 0x5352;   // "SR"
+static const uint8_t CONFIG_VERSION = 1;
+static const uint8_t SECRET_KEY = 0x5A;        // same obfuscation as the old *_enc JSON fields
+static const size_t CONFIG_MAX_SIZE = 2048;       // every string field at full length
+
+struct __attribute__((packed)) ConfigHeader {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t size;       // bytes of body that follow the header
+  uint32_t crc;        // CRC-32 over the body
+};
+
+// Body: one entry per schema field,
+//   [name length u8][name][value length u8][value]
+// Strings are stored without padding, numbers as their raw 4-byte value,
+// bools as one byte. Entries are matched by name, so fields can be added,
+// reordered or retired without bumping the version; unknown names are
+// skipped and missing ones keep their defaults.
+
+static TaskHandle_t configTaskHandle = NULL;
+
+// Too big for the saver task's stack. Loading happens at boot, saving in
+// setup or the saver task, so the two never overlap.
+static uint8_t recordBuf[CONFIG_MAX_SIZE];
+
+static void obfuscate(char* s, size_t len) {
+  for (size_t i = 0; i < len; i++) s[i] ^= SECRET_KEY;
+}
+
+static size_t fieldValueSize(const ConfigField& field) {
+  switch (field.type) {
+    case CFG_STRING: return strlen((const char*)field.ptr);
+    case CFG_BOOL:   return 1;
+    default:         return 4;
+  }
+}
+
+// Serializes every schema field. Returns the total record size, or 0 if
+// it does not fit.
+static size_t buildRecord(uint8_t* buf, size_t cap) {
+  size_t o = sizeof(ConfigHeader);
+
+  for (size_t i = 0; i < configFieldCount(); i++) {
+    const ConfigField& field = configFieldAt(i);
+    size_t nameLen = strlen(field.name);
+    size_t valueLen = fieldValueSize(field);
+    if (valueLen > 255 || o + 2 + nameLen + valueLen > cap) return 0;
+
+    buf[o++] = (uint8_t)nameLen;
+    memcpy(buf + o, field.name, nameLen);
+    o += nameLen;
+    buf[o++] = (uint8_t)valueLen;
+    if (field.type == CFG_BOOL) {
+      buf[o] = *(const bool*)field.ptr ? 1 : 0;
+    } else {
+      memcpy(buf + o, field.ptr, valueLen);
+      if (field.flags & CFG_SECRET) obfuscate((char*)buf + o, valueLen);
+    }
+    o += valueLen;
+  }
+
+  ConfigHeader hdr;
+  hdr.magic = CONFIG_MAGIC;
+  hdr.version = CONFIG_VERSION;
+  hdr.reserved = 0;
+  hdr.size = o - sizeof(ConfigHeader);
+  hdr.crc = srCrc32(buf + sizeof(ConfigHeader), hdr.size);
+  memcpy(buf, &hdr, sizeof(hdr));
+  return o;
+}
+
+static void applyRecord(const uint8_t* body, size_t size) {
+  size_t i = 0;
+  while (i + 2 <= size) {
+    size_t nameLen = body[i];
+    if (i + 1 + nameLen + 1 > size) break;
+    const char* name = (const char*)body + i + 1;
+    size_t valueLen = body[i + 1 + nameLen];
+    const uint8_t* value = body + i + 2 + nameLen;
+    if (value + valueLen > body + size) break;
+    i += 2 + nameLen + valueLen;
+
+    const ConfigField* field = findConfigField(name, nameLen);
+    if (!field) continue;
+
+    switch (field->type) {
+      case CFG_STRING:
+        if (valueLen < field->size) {
+          char* dst = (char*)field->ptr;
+          memcpy(dst, value, valueLen);
+          dst[valueLen] = '\0';
+          if (field->flags & CFG_SECRET) obfuscate(dst, valueLen);
+        }
+        break;
+      case CFG_BOOL:
+        if (valueLen == 1) *(bool*)field->ptr = value[0] != 0;
+        break;
+      default:
+        if (valueLen == 4) memcpy(field->ptr, value, 4);
+        break;
+    }
+  }
+}
+
+bool loadConfigRecord() {
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, true)) return false;
+
+  size_t stored = prefs.getBytesLength(CONFIG_KEY);
+  size_t len = 0;
+  if (stored >= sizeof(ConfigHeader) && stored <= sizeof(recordBuf)) {
+    len = prefs.getBytes(CONFIG_KEY, recordBuf, stored);
+  }
+  prefs.end();
+  if (len < sizeof(ConfigHeader)) return false;
+
+  ConfigHeader hdr;
+  memcpy(&hdr, recordBuf, sizeof(hdr));
+  const uint8_t* body = recordBuf + sizeof(ConfigHeader);
+
+  if (hdr.magic != CONFIG_MAGIC || hdr.version == 0 || hdr.version > CONFIG_VERSION ||
+      sizeof(ConfigHeader) + hdr.size > len) {
+    LOG_W("Config", "NVS config: unknown format, ignoring");
+    return false;
+  }
+  if (srCrc32(body, hdr.size) != hdr.crc) {
+    LOG_W("Config", "NVS config: CRC mismatch, ignoring");
+    return false;
+  }
+
+  applyRecord(body, hdr.size);
+  return true;
+}
+
+bool saveConfig() {
+  // The record is the snapshot: /config cannot change a setting halfway
+  // through, and the slow NVS write runs without the lock
+  takeMutex(configMutex, MUTEX_CONFIG);
+  size_t len = buildRecord(recordBuf, sizeof(recordBuf));
+  xSemaphoreGive(configMutex);
+  if (len == 0) {
+    LOG_E("Config", "Config record too large");
+    return false;
+  }
+
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, false)) {
+    LOG_E("Config", "Failed to open NVS for config");
+    return false;
+  }
+  size_t written = prefs.putBytes(CONFIG_KEY, recordBuf, len);
+  prefs.end();
+
+  if (written != len) {
+    LOG_E("Config", "Failed to write config to NVS");
+    return false;
+  }
+  LOG_I("Config", "Config saved.");
+  return true;
+}
+
+// ===== Deferred saver =====
+static void configSaverTask(void* parameter) {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // Coalesce: keep waiting while more changes arrive
+    while (ulTaskNotifyTake(pdTRUE, configSaveDelayMs / portTICK_PERIOD_MS) > 0) {
+    }
+    saveConfig();
+  }
+}
+
+void startConfigSaver() {
+  if (configTaskHandle) return;
+  xTaskCreatePinnedToCore(configSaverTask, "ConfigSaver", 4096, NULL, 1, &configTaskHandle, 0);
+}
+
+void requestConfigSave() {
+  if (configTaskHandle) {
+    xTaskNotifyGive(configTaskHandle);
+  } else {
+    saveConfig();
+  }
+}
+
+void copyConfigString(char* dst, const char* src, size_t size) {
+  takeMutex(configMutex, MUTEX_CONFIG);
+  strncpy(dst, src, size - 1);
+  dst[size - 1] = '\0';
+  xSemaphoreGive(configMutex);
+}
@@ -0,0 +1,29 @@
+#ifndef SR_CONFIG_STORE_H
+#define SR_CONFIG_STORE_H
+
+#include <Arduino.h>
+
+// ===== Binary configuration record in NVS =====
+// The whole configuration is one versioned blob. NVS commits a blob
+// atomically, and the record carries its own CRC, so a power cut during a
+// save leaves the previous configuration intact.
+//
+// The record holds one name/value entry per field of the config schema
+// (SR_ConfigSchema.h). Entries are matched by name on load, so a record
+// written by older firmware simply lacks the new fields, which keep their
+// compiled-in defaults.
+
+bool loadConfigRecord();
+bool saveConfig();
+
+// Deferred saving: handlers call requestConfigSave() and return; the
+// saver task coalesces bursts and writes once things settle.
+void startConfigSaver();
+void requestConfigSave();
+
+// /config writes settings under configMutex. Tasks that use a string
+// setting (a URL, an address) copy it out with this first instead of
+// reading the global while it may be half rewritten.
+void copyConfigString(char* dst, const char* src, size_t size);
+
+#endif // SR_CONFIG_STORE_H
@@ -0,0 +1,206 @@
+#include "SR_EventRules.h"
+#include "SR_JsonWriter.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* const METRIC_NAMES[METRIC_COUNT] = {
+  "speed", "angle", "vibration", "rotations", "distance"
+};
+
+const char* ruleMetricName(RuleMetric metric) {
+  return metric < METRIC_COUNT ? METRIC_NAMES[metric] : "?";
+}
+
+const char* eventTypeName(EventType type) {
+  switch (type) {
+    case EVENT_RAISED:        return "raised";
+    case EVENT_CLEARED:       return "cleared";
+    case EVENT_SESSION_START: return "session_start";
+    case EVENT_SESSION_END:   return "session_end";
+  }
+  return "?";
+}
+
+float ruleMetricValue(RuleMetric metric, const Reading& r) {
+  switch (metric) {
+    case METRIC_SPEED:     return r.speed_mph;
+    case METRIC_ANGLE:     return r.angle;
+    case METRIC_VIBRATION: return r.vibration;
+    case METRIC_ROTATIONS: return (float)r.rotations;
+    case METRIC_DISTANCE:  return r.distance_miles;
+    default:               return 0.0f;
+  }
+}
+
+// ===== Parser =====
+static void skipSpaces(const char*& p, const char* end) {
+  while (p < end && *p == ' ') p++;
+}
+
+// Reads a decimal number, stopping before a ".." band separator
+static bool parseNumber(const char*& p, const char* end, float& out) {
+  char buf[24];
+  size_t n = 0;
+  skipSpaces(p, end);
+  while (p < end && n + 1 < sizeof(buf) &&
+         (isdigit((unsigned char)*p) || *p == '-' || *p == '+' || *p == 'e' || *p == 'E' ||
+          (*p == '.' && !(p + 1 < end && p[1] == '.')))) {
+    buf[n++] = *p++;
+  }
+  buf[n] = '\0';
+  if (n == 0) return false;
+  char* stop;
+  out = strtof(buf, &stop);
+  return *stop == '\0';
+}
+
+static bool parseRule(const char* p, const char* end, EventRule& rule) {
+  memset(&rule, 0, sizeof(rule));
+  skipSpaces(p, end);
+
+  // Optional "name="
+  const char* eq = (const char*)memchr(p, '=', end - p);
+  if (eq) {
+    size_t len = eq - p;
+    while (len > 0 && p[len - 1] == ' ') len--;
+    if (len == 0 || len >= sizeof(rule.name)) return false;
+    for (size_t i = 0; i < len; i++) {
+      if (!isalnum((unsigned char)p[i]) && p[i] != '_' && p[i] != '-') return false;
+    }
+    memcpy(rule.name, p, len);
+    p = eq + 1;
+    skipSpaces(p, end);
+  }
+
+  const char* word = p;
+  while (p < end && isalpha((unsigned char)*p)) p++;
+  size_t wordLen = p - word;
+  size_t metric = 0;
+  while (metric < METRIC_COUNT &&
+         !(strlen(METRIC_NAMES[metric]) == wordLen && strncmp(METRIC_NAMES[metric], word, wordLen) == 0)) {
+    metric++;
+  }
+  if (metric == METRIC_COUNT) return false;
+  rule.metric = (RuleMetric)metric;
+  if (!rule.name[0]) strcpy(rule.name, METRIC_NAMES[metric]);
+
+  skipSpaces(p, end);
+  if (p >= end) return false;
+  char op = *p++;
+  if (op == '>' || op == '<') {
+    rule.op = op == '>' ? RULE_ABOVE : RULE_BELOW;
+    if (!parseNumber(p, end, rule.low)) return false;
+    rule.high = rule.low;
+  } else if (op == '!') {
+    rule.op = RULE_OUTSIDE;
+    if (!parseNumber(p, end, rule.low)) return false;
+    if (end - p < 2 || p[0] != '.' || p[1] != '.') return false;
+    p += 2;
+    if (!parseNumber(p, end, rule.high) || rule.high <= rule.low) return false;
+  } else {
+    return false;
+  }
+
+  skipSpaces(p, end);
+  if (p < end && *p == '~') {
+    p++;
+    if (!parseNumber(p, end, rule.hysteresis) || rule.hysteresis < 0) return false;
+    // The band must still have a clear region once hysteresis is applied
+    if (rule.op == RULE_OUTSIDE && rule.low + rule.hysteresis >= rule.high - rule.hysteresis) return false;
+  }
+  skipSpaces(p, end);
+  if (p < end && *p == '@') {
+    p++;
+    float ms;
+    if (!parseNumber(p, end, ms) || ms < 0 || ms > 86400000.0f) return false;
+    rule.minMs = (uint32_t)ms;
+  }
+  skipSpaces(p, end);
+  return p == end;
+}
+
+int parseEventRules(const char* text, EventRule* rules, size_t maxRules, const char** errorAt) {
+  int count = 0;
+  const char* p = text;
+  while (*p) {
+    const char* end = strchr(p, ';');
+    if (!end) end = p + strlen(p);
+
+    const char* q = p;
+    skipSpaces(q, end);
+    if (q < end) {   // tolerate empty entries ("a;;b", trailing ';')
+      if ((size_t)count >= maxRules || !parseRule(p, end, rules[count])) {
+        if (errorAt) *errorAt = p;
+        return -1;
+      }
+      count++;
+    }
+    p = *end ? end + 1 : end;
+  }
+  return count;
+}
+
+// ===== Evaluation =====
+RuleTransition evaluateRule(const EventRule& rule, RuleState& state, float value, uint32_t t_ms,
+                            float* threshold) {
+  float h = rule.hysteresis;
+  if (!state.active) {
+    bool triggered;
+    float edge = rule.low;
+    switch (rule.op) {
+      case RULE_ABOVE: triggered = value > rule.low; break;
+      case RULE_BELOW: triggered = value < rule.low; break;
+      default:
+        triggered = value < rule.low || value > rule.high;
+        edge = value > rule.high ? rule.high : rule.low;
+        break;
+    }
+    if (!triggered) {
+      state.pending = false;
+      return RULE_NONE;
+    }
+    if (!state.pending) {
+      state.pending = true;
+      state.since = t_ms;
+    }
+    if (t_ms - state.since < rule.minMs) return RULE_NONE;
+    state.pending = false;
+    state.active = true;
+    if (threshold) *threshold = edge;
+    return RULE_RAISED;
+  }
+
+  bool cleared;
+  float edge = rule.low;
+  switch (rule.op) {
+    case RULE_ABOVE: cleared = value <= rule.low - h; break;
+    case RULE_BELOW: cleared = value >= rule.low + h; break;
+    default:
+      cleared = value >= rule.low + h && value <= rule.high - h;
+      edge = value > (rule.low + rule.high) / 2 ? rule.high : rule.low;
+      break;
+  }
+  if (!cleared) return RULE_NONE;
+  state.active = false;
+  if (threshold) *threshold = edge;
+  return RULE_CLEARED;
+}
+
+// ===== JSON =====
+void writeEventJson(JsonWriter& w, const Event& e) {
+  w.beginObject();
+  w.field("id", (unsigned long)e.id);
+  w.field("type", eventTypeName(e.type));
+  w.field("t_ms", (unsigned long)e.t_ms);
+  w.field("utc_ms", (unsigned long long)e.utc_ms);
+  if (e.type == EVENT_RAISED || e.type == EVENT_CLEARED) {
+    w.field("rule", e.name);
+    w.field("metric", ruleMetricName(e.metric));
+    w.field("value", e.value, 3);
+    w.field("threshold", e.threshold, 3);
+    w.field("seq", (unsigned long)e.seq);
+  }
+  w.field("job", e.job);
+  w.endObject();
+}
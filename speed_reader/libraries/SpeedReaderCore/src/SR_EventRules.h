@@ -0,0 +1,102 @@
+#ifndef SR_EVENT_RULES_H
+#define SR_EVENT_RULES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SR_Reading.h"
+
+// ===== Threshold rules =====
+// Rules are configured as one string (event_rules), `;`-separated:
+//
+//   [name=]metric op threshold[~hysteresis][@min_ms]
+//
+//   metric   speed | angle | vibration | rotations | distance
+//   op       >T        above T
+//            <T        below T
+//            !L..H     outside the band L..H
+//
+//   overspeed=speed>12~0.5@2000;tilt=angle!-5..5~1@500;shake=vibration>0.8
+//
+// A rule is raised once its condition has held for min_ms, and cleared
+// once the value is back past the threshold by the hysteresis, so a value
+// hovering at the threshold does not fire on every sample.
+//
+// No Arduino dependencies, so the parser and evaluator build on a host.
+
+const size_t EVENT_MAX_RULES = 8;
+const size_t EVENT_NAME_MAX = 16;
+
+enum RuleMetric : uint8_t {
+  METRIC_SPEED,
+  METRIC_ANGLE,
+  METRIC_VIBRATION,
+  METRIC_ROTATIONS,
+  METRIC_DISTANCE,
+  METRIC_COUNT
+};
+
+enum RuleOp : uint8_t {
+  RULE_ABOVE,
+  RULE_BELOW,
+  RULE_OUTSIDE
+};
+
+struct EventRule {
+  char name[EVENT_NAME_MAX];
+  RuleMetric metric;
+  RuleOp op;
+  float low;           // the threshold, or the band's lower edge
+  float high;          // band's upper edge
+  float hysteresis;
+  uint32_t minMs;
+};
+
+struct RuleState {
+  bool active;
+  bool pending;        // condition holds, waiting for minMs
+  uint32_t since;
+};
+
+enum RuleTransition : uint8_t {
+  RULE_NONE,
+  RULE_RAISED,
+  RULE_CLEARED
+};
+
+enum EventType : uint8_t {
+  EVENT_RAISED,
+  EVENT_CLEARED,
+  EVENT_SESSION_START,
+  EVENT_SESSION_END
+};
+
+struct Event {
+  uint32_t id;         // increases by one per event since boot
+  uint32_t t_ms;
+  uint64_t utc_ms;     // 0 if the clock was not synced
+  uint32_t seq;        // reading that triggered it (0 for session events)
+  EventType type;
+  RuleMetric metric;
+  float value;
+  float threshold;     // the edge that was crossed
+  char name[EVENT_NAME_MAX];   // rule name; empty for session events
+  char job[32];
+};
+
+// Returns the number of rules parsed (an empty string is zero rules), or
+// -1 if the text is malformed; *errorAt then points at the offending rule.
+int parseEventRules(const char* text, EventRule* rules, size_t maxRules, const char** errorAt = NULL);
+
+const char* ruleMetricName(RuleMetric metric);
+const char* eventTypeName(EventType type);
+float ruleMetricValue(RuleMetric metric, const Reading& r);
+
+// Feeds one sample to a rule. `threshold` (optional) receives the edge
+// that was crossed on a transition.
+RuleTransition evaluateRule(const EventRule& rule, RuleState& state, float value, uint32_t t_ms,
+                            float* threshold = NULL);
+
+class JsonWriter;
+void writeEventJson(JsonWriter& w, const Event& e);
+
+#endif // SR_EVENT_RULES_H
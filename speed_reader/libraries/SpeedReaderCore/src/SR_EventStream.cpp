@@ -0,0 +1,349 @@
+#include "SR_EventStream.h"
+#include <WiFi.h>
+#include "globals.h"
+#include "SR_Readings.h"
+#include "SR_ReadingCodec.h"
+#include "SR_Events.h"
+#include "SR_JsonWriter.h"
+#include "SR_Log.h"
+
+#if ENABLE_HTTP
+
+struct StreamClient {
+  WiFiClient client;
+  bool active;             // slot in use
+  bool streaming;          // request accepted, events flowing
+  char request[512];
+  size_t requestLen;
+  unsigned long acceptedMs;
+  unsigned long lastSendMs;
+  uint32_t nextSeq;
+  uint32_t intervalMs;
+  uint32_t nextEventId;
+  bool readings;           // false: alerts only
+};
+
+static const unsigned long requestTimeoutMs = 5000;
+static const unsigned long keepAliveMs = 15000;
+static const unsigned long streamPollMs = 100;
+
+static WiFiServer* streamServer = NULL;
+static StreamClient clients[streamMaxClients];
+static TaskHandle_t streamTaskHandle = NULL;
+
+// The most recently formatted event, shared by every client at that seq
+static uint32_t cachedSeq = 0;
+static char cachedEvent[384];
+static size_t cachedLen = 0;
+
+// ===== Request parsing =====
+// Finds "Name: value" in the header block (case-insensitive name)
+static bool findHeader(const char* req, const char* name, char* out, size_t cap) {
+  size_t nameLen = strlen(name);
+  const char* line = strstr(req, "\r\n");
+  while (line) {
+    line += 2;
+    if (strncasecmp(line, name, nameLen) == 0 && line[nameLen] == ':') {
+      const char* v = line + nameLen + 1;
+      while (*v == ' ') v++;
+      size_t n = 0;
+      while (v[n] && v[n] != '\r' && n + 1 < cap) {
+        out[n] = v[n];
+        n++;
+      }
+      out[n] = '\0';
+      return true;
+    }
+    line = strstr(line, "\r\n");
+  }
+  return false;
+}
+
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Finds name=value in a query string and URL-decodes the value
+static bool findQueryParam(const char* query, const char* name, char* out, size_t cap) {
+  size_t nameLen = strlen(name);
+  const char* p = query;
+  while (p && *p) {
+    if (strncmp(p, name, nameLen) == 0 && p[nameLen] == '=') {
+      p += nameLen + 1;
+      size_t n = 0;
+      while (*p && *p != '&' && n + 1 < cap) {
+        if (*p == '%' && hexDigit(p[1]) >= 0 && hexDigit(p[2]) >= 0) {
+          out[n++] = (char)(hexDigit(p[1]) * 16 + hexDigit(p[2]));
+          p += 3;
+        } else {
+          out[n++] = (*p == '+') ? ' ' : *p;
+          p++;
+        }
+      }
+      out[n] = '\0';
+      return true;
+    }
+    p = strchr(p, '&');
+    if (p) p++;
+  }
+  return false;
+}
+
+static void closeClient(StreamClient& c) {
+  c.client.stop();
+  c.active = false;
+  c.streaming = false;
+}
+
+static void sendError(StreamClient& c, const char* status, const char* message) {
+  char buf[192];
+  int bodyLen = snprintf(NULL, 0, "{\"error\":\"%s\"}", message);
+  int n = snprintf(buf, sizeof(buf),
+    "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %d\r\nConnection: close\r\n\r\n{\"error\":\"%s\"}",
+    status, bodyLen, message);
+  c.client.write((const uint8_t*)buf, n < (int)sizeof(buf) ? n : sizeof(buf) - 1);
+  closeClient(c);
+}
+
+static void beginStream(StreamClient& c) {
+  const char* req = c.request;
+  if (strncmp(req, "GET ", 4) != 0) {
+    sendError(c, "405 Method Not Allowed", "Use GET");
+    return;
+  }
+
+  // Request target, up to the next space
+  char target[256];
+  const char* t = req + 4;
+  size_t n = 0;
+  while (t[n] && t[n] != ' ' && n + 1 < sizeof(target)) {
+    target[n] = t[n];
+    n++;
+  }
+  target[n] = '\0';
+
+  char* query = strchr(target, '?');
+  if (query) *query++ = '\0';
+  if (strcmp(target, "/stream") != 0) {
+    sendError(c, "404 Not Found", "Not found");
+    return;
+  }
+
+  // Plain HTTP, so the same rules as the read-only LAN listener: clients
+  // on the device's own subnet only, and the read key (never the API key,
+  // which would travel in the clear) if one is set
+  uint32_t client = (uint32_t)c.client.remoteIP();
+  uint32_t mask = (uint32_t)WiFi.subnetMask();
+  if ((client & mask) != ((uint32_t)WiFi.localIP() & mask)) {
+    sendError(c, "403 Forbidden", "Plain HTTP is only served on the local network.");
+    return;
+  }
+
+  char value[64];
+  bool authorized = !readKey[0] ||
+                    ((findHeader(req, "X-API-Key", value, sizeof(value)) ||
+                      (query && findQueryParam(query, "key", value, sizeof(value)))) &&
+                     strcmp(value, readKey) == 0);
+  if (!authorized) {
+    sendError(c, "401 Unauthorized", "Unauthorized. Missing or invalid X-API-Key header (read key).");
+    return;
+  }
+
+  c.intervalMs = 0;
+  if (query && findQueryParam(query, "interval_ms", value, sizeof(value))) {
+    c.intervalMs = strtoul(value, NULL, 10);
+  }
+  c.readings = !(query && findQueryParam(query, "readings", value, sizeof(value)) && strcmp(value, "0") == 0);
+  c.nextEventId = latestEventId() + 1;
+
+  // Resume after the last event the client saw, if it is still in the ring
+  uint32_t latest = latestReadingSeq();
+  c.nextSeq = latest ? latest : 1;
+  if (findHeader(req, "Last-Event-ID", value, sizeof(value)) ||
+      (query && findQueryParam(query, "last_event_id", value, sizeof(value)))) {
+    uint32_t lastId = strtoul(value, NULL, 10);
+    if (lastId <= latest) {
+      c.nextSeq = lastId + 1;
+      if (c.nextSeq < oldestReadingSeq()) c.nextSeq = oldestReadingSeq();
+    }
+  }
+
+  static const char headers[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n"
+    "retry: 1000\n\n";
+  if (c.client.write((const uint8_t*)headers, sizeof(headers) - 1) != sizeof(headers) - 1) {
+    closeClient(c);
+    return;
+  }
+  c.streaming = true;
+  c.lastSendMs = millis();
+  LOG_I("SSE", "client %s streaming from seq %lu",
+    c.client.remoteIP().toString().c_str(), (unsigned long)c.nextSeq);
+}
+
+// ===== Event delivery =====
+static bool sendEvent(StreamClient& c, uint32_t seq) {
+  if (seq != cachedSeq) {
+    Reading r;
+    if (!getReading(seq, r)) return true;  // overwritten meanwhile, skip it
+    int n = snprintf(cachedEvent, sizeof(cachedEvent), "id: %lu\nevent: reading\ndata: ",
+                     (unsigned long)seq);
+    size_t json = formatReadingJson(r, cachedEvent + n, sizeof(cachedEvent) - n - 2);
+    if (json == 0) return true;
+    n += json;
+    cachedEvent[n++] = '\n';
+    cachedEvent[n++] = '\n';
+    cachedLen = n;
+    cachedSeq = seq;
+  }
+  return c.client.write((const uint8_t*)cachedEvent, cachedLen) == cachedLen;
+}
+
+static bool sendPending(StreamClient& c, unsigned long now) {
+  uint32_t latest = latestReadingSeq();
+  if (latest == 0 || c.nextSeq > latest) return true;
+
+  if (c.intervalMs > 0) {
+    // Rate-limited clients only ever get the newest reading
+    if (now - c.lastSendMs < c.intervalMs) return true;
+    c.nextSeq = latest;
+  } else if (c.nextSeq < oldestReadingSeq()) {
+    c.nextSeq = oldestReadingSeq();
+  }
+
+  while (c.nextSeq <= latest) {
+    if (!sendEvent(c, c.nextSeq)) return false;
+    c.nextSeq++;
+  }
+  c.lastSendMs = now;
+  return true;
+}
+
+// Rule and session events, without an id so Last-Event-ID keeps tracking
+// the reading sequence
+static bool sendAlerts(StreamClient& c, unsigned long now) {
+  uint32_t latest = latestEventId();
+  if (c.nextEventId < oldestEventId()) c.nextEventId = oldestEventId();
+  while (c.nextEventId <= latest) {
+    Event e;
+    if (getEvent(c.nextEventId++, e)) {
+      char buf[320];
+      int n = snprintf(buf, sizeof(buf), "event: alert\ndata: ");
+      JsonWriter w(buf + n, sizeof(buf) - n - 2);
+      writeEventJson(w, e);
+      if (w.overflow()) continue;
+      n += w.length();
+      buf[n++] = '\n';
+      buf[n++] = '\n';
+      if (c.client.write((const uint8_t*)buf, n) != (size_t)n) return false;
+      c.lastSendMs = now;
+    }
+  }
+  return true;
+}
+
+static void serviceClient(StreamClient& c, unsigned long now) {
+  if (!c.client.connected()) {
+    closeClient(c);
+    return;
+  }
+
+  if (!c.streaming) {
+    // Collect the request headers
+    if (c.client.available()) {
+      int n = c.client.read((uint8_t*)c.request + c.requestLen, sizeof(c.request) - 1 - c.requestLen);
+      if (n > 0) c.requestLen += n;
+    }
+    c.request[c.requestLen] = '\0';
+
+    if (strstr(c.request, "\r\n\r\n")) {
+      beginStream(c);
+    } else if (c.requestLen + 1 >= sizeof(c.request)) {
+      sendError(c, "431 Request Header Fields Too Large", "Request too large");
+    } else if (now - c.acceptedMs > requestTimeoutMs) {
+      closeClient(c);
+    }
+    return;
+  }
+
+  // Nothing is expected from the client once streaming; discard it
+  uint8_t discard[64];
+  while (c.client.available() && c.client.read(discard, sizeof(discard)) > 0) {
+  }
+
+  bool ok = (!c.readings || sendPending(c, now)) && sendAlerts(c, now);
+  if (ok && now - c.lastSendMs >= keepAliveMs) {
+    static const char ping[] = ": keepalive\n\n";
+    ok = c.client.write((const uint8_t*)ping, sizeof(ping) - 1) == sizeof(ping) - 1;
+    c.lastSendMs = now;
+  }
+  if (!ok) {
+    LOG_I("SSE", "client dropped");
+    closeClient(c);
+  }
+}
+
+static void acceptClients(unsigned long now) {
+  WiFiClient incoming = streamServer->accept();
+  while (incoming) {
+    StreamClient* slot = NULL;
+    for (int i = 0; i < streamMaxClients && !slot; i++) {
+      if (!clients[i].active) slot = &clients[i];
+    }
+    if (slot) {
+      slot->client = incoming;
+      slot->client.setNoDelay(true);
+      slot->active = true;
+      slot->streaming = false;
+      slot->requestLen = 0;
+      slot->acceptedMs = now;
+    } else {
+      static const char busy[] =
+        "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+      incoming.write((const uint8_t*)busy, sizeof(busy) - 1);
+      incoming.stop();
+    }
+    incoming = streamServer->accept();
+  }
+}
+
+static void eventStreamTask(void* parameter) {
+  subscribeReadings(xTaskGetCurrentTaskHandle());
+
+  while (true) {
+    // Woken by every published reading, or by the poll timeout to pick up
+    // new connections
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(streamPollMs));
+
+    unsigned long now = millis();
+    acceptClients(now);
+    for (int i = 0; i < streamMaxClients; i++) {
+      if (clients[i].active) serviceClient(clients[i], now);
+    }
+  }
+}
+
+void startEventStream() {
+  if (streamTaskHandle) return;
+
+  streamServer = new WiFiServer(streamPort, streamMaxClients);
+  streamServer->begin();
+  streamServer->setNoDelay(true);
+
+  xTaskCreatePinnedToCore(eventStreamTask, "EventStream", 4096, NULL, 1, &streamTaskHandle, 1);
+  LOG_I("SSE", "SSE stream ready on port %u (/stream)", streamPort);
+}
+
+#else
+
+void startEventStream() {}
+
+#endif // ENABLE_HTTP
@@ -0,0 +1,33 @@
+#ifndef SR_EVENT_STREAM_H
+#define SR_EVENT_STREAM_H
+
+#include <Arduino.h>
+
+// ===== Server-Sent Events /stream =====
+// GET http://<device>:<streamPort>/stream keeps the connection open and
+// pushes each published reading as an SSE event whose id is the reading's
+// sequence number:
+//
+//   id: 1234
+//   event: reading
+//   data: {...same object as /readings...}
+//
+// Query parameters:
+//   key=<read key>       alternative to the X-API-Key header (EventSource
+//                        cannot set headers)
+//   interval_ms=<n>      send the latest reading at most every n ms instead
+//                        of every reading
+//   last_event_id=<seq>  alternative to the Last-Event-ID header
+//
+// A client that reconnects with Last-Event-ID resumes after that reading
+// if it is still in the readings ring, so short drops lose nothing.
+//
+// Plain HTTP, so access follows the read-only LAN listener: local subnet
+// only, and the read key if one is set. The API key is never accepted.
+//
+// The stream runs on its own port and task: a handler on the main server
+// would hold its only loop for as long as the client stayed connected.
+
+void startEventStream();
+
+#endif // SR_EVENT_STREAM_H
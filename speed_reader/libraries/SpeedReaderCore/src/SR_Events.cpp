@@ -0,0 +1,215 @@
+#include "SR_Events.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "globals.h"
+#include "SR_Readings.h"
+#include "SR_JsonWriter.h"
+#include "SR_Time.h"
+#include "SR_ConfigStore.h"
+#include "SR_Log.h"
+#include "SR_Metrics.h"
+
+static EventRule rules[EVENT_MAX_RULES];
+static RuleState ruleStates[EVENT_MAX_RULES];
+static size_t ruleCount = 0;
+static char activeRules[sizeof(eventRules)] = "";   // text of `rules`
+static uint32_t lastCheckedSeq = 0;
+static portMUX_TYPE rulesMux = portMUX_INITIALIZER_UNLOCKED;
+
+static Event history[EVENT_HISTORY];
+static uint32_t lastEventId = 0;
+static portMUX_TYPE eventsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t webhookTaskHandle = NULL;
+static volatile bool webhookResume = false;
+
+// ===== Event log =====
+static void appendEvent(Event& e) {
+  portENTER_CRITICAL(&eventsMux);
+  e.id = ++lastEventId;
+  history[e.id % EVENT_HISTORY] = e;
+  portEXIT_CRITICAL(&eventsMux);
+
+  if (webhookTaskHandle) xTaskNotifyGive(webhookTaskHandle);
+}
+
+uint32_t latestEventId() {
+  portENTER_CRITICAL(&eventsMux);
+  uint32_t id = lastEventId;
+  portEXIT_CRITICAL(&eventsMux);
+  return id;
+}
+
+uint32_t oldestEventId() {
+  uint32_t latest = latestEventId();
+  return latest > EVENT_HISTORY ? latest - EVENT_HISTORY + 1 : 1;
+}
+
+bool getEvent(uint32_t id, Event& out) {
+  portENTER_CRITICAL(&eventsMux);
+  bool ok = id != 0 && id <= lastEventId && lastEventId - id < EVENT_HISTORY;
+  if (ok) out = history[id % EVENT_HISTORY];
+  portEXIT_CRITICAL(&eventsMux);
+  return ok;
+}
+
+void logSessionEvent(EventType type, const char* job) {
+  Event e;
+  memset(&e, 0, sizeof(e));
+  e.type = type;
+  e.t_ms = millis();
+  e.utc_ms = utcMs();
+  strncpy(e.job, job, sizeof(e.job) - 1);
+  appendEvent(e);
+}
+
+// ===== Rules =====
+bool reloadEventRules() {
+  if (strcmp(eventRules, activeRules) == 0) return true;
+
+  EventRule parsed[EVENT_MAX_RULES];
+  const char* errorAt = NULL;
+  int n = parseEventRules(eventRules, parsed, EVENT_MAX_RULES, &errorAt);
+  if (n < 0) {
+    LOG_W("Events", "bad rule at '%s', keeping previous rules", errorAt ? errorAt : "");
+    strcpy(eventRules, activeRules);
+    return false;
+  }
+
+  portENTER_CRITICAL(&rulesMux);
+  memcpy(rules, parsed, sizeof(EventRule) * n);
+  memset(ruleStates, 0, sizeof(ruleStates));
+  ruleCount = n;
+  portEXIT_CRITICAL(&rulesMux);
+  strcpy(activeRules, eventRules);
+
+  LOG_I("Events", "%d rule(s)%s%s", n, n ? ": " : "", eventRules);
+  return true;
+}
+
+void checkEventRules() {
+  uint32_t seq = latestReadingSeq();
+  if (seq == lastCheckedSeq || ruleCount == 0) return;
+  lastCheckedSeq = seq;
+
+  Reading r;
+  if (!getReading(seq, r)) return;
+
+  // Collected first: appendEvent notifies a task, which is not allowed
+  // inside the critical section
+  Event fired[EVENT_MAX_RULES];
+  size_t firedCount = 0;
+
+  portENTER_CRITICAL(&rulesMux);
+  for (size_t i = 0; i < ruleCount; i++) {
+    float value = ruleMetricValue(rules[i].metric, r);
+    float threshold = 0;
+    RuleTransition t = evaluateRule(rules[i], ruleStates[i], value, r.t_ms, &threshold);
+    if (t == RULE_NONE) continue;
+
+    Event& e = fired[firedCount++];
+    memset(&e, 0, sizeof(e));
+    e.type = t == RULE_RAISED ? EVENT_RAISED : EVENT_CLEARED;
+    e.t_ms = r.t_ms;
+    e.utc_ms = r.utc_ms;
+    e.seq = r.seq;
+    e.metric = rules[i].metric;
+    e.value = value;
+    e.threshold = threshold;
+    memcpy(e.name, rules[i].name, sizeof(e.name));
+    memcpy(e.job, r.job, sizeof(e.job));
+  }
+  portEXIT_CRITICAL(&rulesMux);
+
+  for (size_t i = 0; i < firedCount; i++) appendEvent(fired[i]);
+}
+
+// ===== Webhook =====
+static const size_t WEBHOOK_BATCH = 8;
+static const unsigned long webhookBackoffMinMs = 2000;
+static const unsigned long webhookBackoffMaxMs = 60000;
+
+static int postEvents(const char* url, uint32_t firstId, uint32_t lastId, uint32_t& sentThrough) {
+  static char body[2048];
+  JsonWriter w(body, sizeof(body));
+  w.beginObject();
+  w.field("device", deviceName);
+  w.field("station", station);
+  w.key("events").beginArray();
+  sentThrough = firstId - 1;
+  for (uint32_t id = firstId; id <= lastId && id - firstId < WEBHOOK_BATCH; id++) {
+    Event e;
+    if (!getEvent(id, e)) continue;
+    writeEventJson(w, e);
+    sentThrough = id;
+  }
+  w.endArray();
+  w.endObject();
+  if (w.overflow() || sentThrough < firstId) return 0;
+
+  HTTPClient http;
+  http.setConnectTimeout(uploadTimeoutMs);
+  http.setTimeout(uploadTimeoutMs);
+  if (!http.begin(url)) return HTTPC_ERROR_CONNECTION_REFUSED;
+  http.addHeader("Content-Type", "application/json");
+  int code = http.POST((uint8_t*)body, w.length());
+  http.end();
+  return code;
+}
+
+static void webhookTask(void* parameter) {
+  uint32_t delivered = latestEventId();
+  unsigned long backoffMs = 0;
+  unsigned long retryAtMs = 0;
+  char url[sizeof(eventWebhook)];
+
+  while (true) {
+    // Woken by each new event; the timeout drives retries
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    if (webhookResume) {
+      webhookResume = false;
+      backoffMs = 0;
+    }
+
+    uint32_t latest = latestEventId();
+    copyConfigString(url, eventWebhook, sizeof(url));
+    if (delivered >= latest || url[0] == '\0' || WiFi.status() != WL_CONNECTED) continue;
+    if (backoffMs && (long)(millis() - retryAtMs) < 0) continue;
+
+    uint32_t oldest = oldestEventId();
+    if (delivered + 1 < oldest) {
+      LOG_W("Events", "webhook missed %lu event(s)", (unsigned long)(oldest - delivered - 1));
+      delivered = oldest - 1;
+    }
+
+    uint32_t sentThrough;
+    int code = postEvents(url, delivered + 1, latest, sentThrough);
+    if (code >= 200 && code < 300) {
+      delivered = sentThrough;
+      backoffMs = 0;
+      if (delivered < latest) xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+    } else {
+      backoffMs = backoffMs ? backoffMs * 2 : webhookBackoffMinMs;
+      if (backoffMs > webhookBackoffMaxMs) backoffMs = webhookBackoffMaxMs;
+      retryAtMs = millis() + backoffMs;
+      LOG_W("Events", "webhook POST failed (%d), retry in %lu ms", code, backoffMs);
+    }
+  }
+}
+
+void resumeEventWebhook() {
+  webhookResume = true;
+  if (webhookTaskHandle) xTaskNotifyGive(webhookTaskHandle);
+}
+
+void startEvents() {
+  takeMutex(configMutex, MUTEX_CONFIG);
+  reloadEventRules();
+  xSemaphoreGive(configMutex);
+  char url[sizeof(eventWebhook)];
+  copyConfigString(url, eventWebhook, sizeof(url));
+  if (url[0] == '\0' || webhookTaskHandle) return;
+
+  xTaskCreatePinnedToCore(webhookTask, "EventHook", uploaderTaskStack, NULL, 1, &webhookTaskHandle, 0);
+  LOG_I("Events", "webhook %s", url);
+}
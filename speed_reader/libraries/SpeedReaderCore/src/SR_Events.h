@@ -0,0 +1,43 @@
+#ifndef SR_EVENTS_H
+#define SR_EVENTS_H
+
+#include <Arduino.h>
+#include "SR_EventRules.h"
+
+// ===== Event engine =====
+// The rules in event_rules (syntax in SR_EventRules.h) are evaluated on
+// every published reading in the sensor task. Rule transitions, plus
+// session start and end, are appended to an in-RAM event log of the last
+// EVENT_HISTORY events, which is read by:
+//
+//   GET /events?since=<id>   the log, oldest first
+//   /stream                  `event: alert` messages next to the readings
+//   event_webhook            one POST per batch of new events,
+//                            {"device":..,"station":..,"events":[...]},
+//                            retried with backoff while they are in the log
+//
+// Rule changes through /config take effect immediately and reset every
+// rule to inactive; a malformed rule string is rejected as a whole.
+
+const size_t EVENT_HISTORY = 32;
+
+void startEvents();
+
+// Re-parses event_rules after a /config change. On a syntax error the
+// previous rules (and their text) are restored and false is returned.
+// Call with configMutex held, since it may rewrite eventRules.
+bool reloadEventRules();
+
+// Sensor task, after publishReading()
+void checkEventRules();
+
+void logSessionEvent(EventType type, const char* job);
+
+// WiFi manager, on every connect: retries pending deliveries at once
+void resumeEventWebhook();
+
+uint32_t latestEventId();   // 0 before the first event
+uint32_t oldestEventId();
+bool getEvent(uint32_t id, Event& out);
+
+#endif // SR_EVENTS_H
@@ -2,11 +2,31 @@
 #include "SR_Session.h"
 #include "SR_SpeedSensor.h"
 #include "SR_WiFiLoader.h"
+#include "SR_ConfigStore.h"
+#include "SR_ConfigSchema.h"
+#include "SR_Json.h"
+#include "SR_JsonWriter.h"
+#include "SR_SessionLog.h"
+#include "SR_Readings.h"
+#include "SR_ServerTask.h"
+#include "SR_TLSServer.h"
+#include "SR_CertStore.h"
+#include "SR_Uploader.h"
+#include "SR_Events.h"
+#include "SR_Time.h"
+#include "SR_WiFiManager.h"
+#include "SR_WebSocket.h"
+#include "SR_Metrics.h"
+#include "SR_Profiler.h"
+#include "SR_Log.h"
+#include <esp_timer.h>
 #include <WiFi.h>
 #include <SPIFFS.h>
 
 #if ENABLE_HTTP
 
+static CertSource certSource = CERT_NONE;
+
 void handleRoot(HTTPRequest * req, HTTPResponse * res) {
   res->setHeader("Content-Type", "text/plain");
   res->println("HTTPS/HTTP server OK.\nTry /readings or /start");
@@ -19,85 +39,94 @@ void handleStart(HTTPRequest * req, HTTPResponse * res) {
     return;
   }
   
-  String job = "";
-  char buffer[256];
-  size_t len = req->readChars(buffer, 255);
-  buffer[len] = '\0';
-  String body = String(buffer);
+  char body[256];
+  size_t len = req->readChars(body, sizeof(body) - 1);
+  body[len] = '\0';
   
-  ResourceParameters *params = req->getParams();
-
-  if (body.length() > 0 && body.startsWith("{")) {
-    job = getJsonValue(body, "job");
+  char job[32] = "";
+  bool tooLong = false;
+  
+  if (len > 0 && body[0] == '{') {
+    JsonToken value;
+    if (jsonFind(body, len, "job", value) && value.len > 0) {
+      tooLong = !value.copyTo(job, sizeof(job));
+    }
   } else {
+    ResourceParameters *params = req->getParams();
     if (params->isQueryParameterSet("job")) {
        std::string jstr;
        params->getQueryParameter("job", jstr);
-       job = String(jstr.c_str());
+       tooLong = jstr.length() >= sizeof(job);
+       if (!tooLong) strcpy(job, jstr.c_str());
     }
   }
   
-  if (job.length() == 0) {
+  if (tooLong) {
     res->setStatusCode(400);
     res->setHeader("Content-Type", "application/json");
-    res->print("{\"error\":\"Missing 'job' parameter\"}");
+    res->print("{\"error\":\"Job name too long (max 31 chars)\"}");
     return;
   }
   
-  if (job.length() > 31) {
+  if (job[0] == '\0') {
     res->setStatusCode(400);
     res->setHeader("Content-Type", "application/json");
-    res->print("{\"error\":\"Job name too long (max 31 chars)\"}");
+    res->print("{\"error\":\"Missing 'job' parameter\"}");
     return;
   }
   
   startSession(job);
   
-  char response[128];
-  snprintf(response, sizeof(response), "{\"status\":\"started\",\"job\":\"%s\"}", job.c_str());
   res->setHeader("Content-Type", "application/json");
-  res->print(response);
+  JsonWriter w(*res);
+  w.beginObject().field("status", "started").field("job", job).endObject();
 }
 
 void handleReadings(HTTPRequest * req, HTTPResponse * res) {
-  float speed_mph = getCurrentSpeed();
-  
-  unsigned long rc = 0;
-  float dist_miles = 0.0f;
-  float max_mph = 0.0f;
-  float max_ang = 0.0f;
-  float min_ang = 0.0f;
-  float vib = 0.0f;
-  float max_vib = 0.0f;
-  
-  char safeJob[32] = "";
-  
-  if (xSemaphoreTake(dataMutex, portMAX_DELAY) == pdTRUE) {
-    rc = rotationCount;
-    totalDistance_miles = (float)rc * distancePerRotation_miles;
-    dist_miles = totalDistance_miles;
-    max_mph = maxSpeed_mph;
-    max_ang = maxAngle;
-    min_ang = minAngle;
-    vib = currentVibration;
-    max_vib = maxVibration;
-    strncpy(safeJob, currentJob, sizeof(safeJob) - 1);
-    safeJob[sizeof(safeJob) - 1] = '\0';
-    xSemaphoreGive(dataMutex);
-  } else {
-    res->setStatusCode(500);
+  // Binary formats on request; JSON otherwise
+  std::string accept = req->getHeader("Accept");
+  ReadingFormat format = READING_JSON;
+  const char* contentType = "application/json";
+  if (accept.find("application/cbor") != std::string::npos) {
+    format = READING_CBOR;
+    contentType = "application/cbor";
+  } else if (accept.find("application/octet-stream") != std::string::npos) {
+    format = READING_PACKED;
+    contentType = "application/octet-stream";
+  }
+  
+  // Rendered once per publish tick by the sensor task; no mutex here
+  uint8_t buf[READING_RENDER_MAX];
+  size_t len = readRenderedReading(format, buf, sizeof(buf));
+  if (len == 0) {
+    res->setStatusCode(503);
     res->setHeader("Content-Type", "application/json");
-    res->print("{\"error\":\"Mutex timeout\"}");
+    res->print("{\"error\":\"No readings yet\"}");
     return;
   }
   
-  char buf[256];
-  snprintf(buf, sizeof(buf), 
-    "{\"rotations\":%lu,\"distance_miles\":%.4f,\"speed_mph\":%.2f,\"max_speed\":%.2f,\"angle\":%.1f,\"max_angle\":%.1f,\"min_angle\":%.1f,\"vibration\":%.3f,\"max_vibration\":%.3f,\"job\":\"%s\"}", 
-    rc, dist_miles, speed_mph, max_mph, currentAngle, max_ang, min_ang, vib, max_vib, safeJob);
-  
-  res->setHeader("Content-Type", "application/json");
-  res->print(buf);
+  res->setHeader("Vary", "Accept");
+  res->setHeader("Content-Type", contentType);
+  res->write(buf, len);
+}
+
+// Applies one /config field through the config schema. Shared by the JSON
+// and form/query paths. Unknown keys are ignored; returns the field if its
+// value was rejected (wrong type, too long or out of range).
+static const ConfigField* applyConfigField(const JsonToken& key, const JsonToken& value) {
+  const ConfigField* field = findConfigField(key);
+  if (!field) return NULL;
+  ConfigSetResult r = configFieldSet(*field, value);
+  return (r == CFG_SET_OK || r == CFG_SET_EMPTY) ? NULL : field;
+}
+
+static JsonToken stringToken(const std::string& s) {
+  JsonToken t;
+  t.p = s.c_str();
+  t.len = s.length();
+  t.type = JSON_STRING;
+  t.escaped = false;
+  return t;
 }
 
 void handleConfig(HTTPRequest * req, HTTPResponse * res) {
@@ -107,163 +136,328 @@ void handleConfig(HTTPRequest * req, HTTPResponse * res) {
     return;
   }
   
-  char buffer[1024]; 
-  size_t len = req->readChars(buffer, 1023);
-  buffer[len] = '\0';
-  String body = String(buffer);
+  char body[1024]; 
+  size_t len = req->readChars(body, sizeof(body) - 1);
+  body[len] = '\0';
   
-  bool isJson = (body.length() > 0 && body.startsWith("{"));
+  bool isJson = (len > 0 && body[0] == '{');
   ResourceParameters *params = req->getParams();
   
-  auto getParam = [&](const char* key, String &target) {
-     if (params->isQueryParameterSet(key)) {
-         std::string s; params->getQueryParameter(key, s);
-         target = String(s.c_str());
-     }
-  };
-
-  String pass = "";
+  // Tokenize the body once. Tokens point into body, so nothing is copied
+  // until the password has been checked. Room for every schema field;
+  // a body with more members is refused rather than cut short.
+  const size_t maxFields = CONFIG_MAX_FIELDS;
+  JsonToken keys[maxFields];
+  JsonToken values[maxFields];
+  size_t fieldCount = 0;
+  bool authorized = false;
+  
   if (isJson) {
-      pass = getJsonValue(body, "device_password");
-  } else {
-      getParam("device_password", pass);
+    JsonScanner scanner(body, len);
+    JsonToken key, value;
+    bool tooMany = false;
+    while (scanner.next(key, value)) {
+      if (fieldCount == maxFields) {
+        tooMany = true;
+        break;
+      }
+      if (key.equals("device_password")) authorized = value.equals(devicePassword);
+      keys[fieldCount] = key;
+      values[fieldCount] = value;
+      fieldCount++;
+    }
+    if (scanner.error()) {
+      res->setStatusCode(400);
+      res->setHeader("Content-Type", "application/json");
+      res->print("{\"error\":\"Malformed JSON body\"}");
+      return;
+    }
+    if (tooMany) {
+      res->setStatusCode(400);
+      res->setHeader("Content-Type", "application/json");
+      res->printf("{\"error\":\"Too many fields (at most %u)\"}", (unsigned)maxFields);
+      return;
+    }
+  } else if (params->isQueryParameterSet("device_password")) {
+    std::string pass;
+    params->getQueryParameter("device_password", pass);
+    authorized = (pass == devicePassword);
   }
-
-  if (pass != String(devicePassword)) {
+  
+  if (!authorized) {
     res->setStatusCode(401);
     res->setHeader("Content-Type", "application/json");
     res->print("{\"error\":\"Unauthorized. Invalid 'password' in request body.\"}");
     return;
   }
-   
+  
+  // Rejected fields, reported back to the caller
+  const ConfigField* rejected[maxFields];
+  size_t rejectedCount = 0;
+  const ConfigField* bad;
+  // Tasks that use a setting copy it out under the same lock
+  takeMutex(configMutex, MUTEX_CONFIG);
   if (isJson) {
-      String val;
-      val = getJsonValue(body, "ssid"); if (val.length() > 0) strncpy(wifiSSID, val.c_str(), sizeof(wifiSSID) - 1);
-      val = getJsonValue(body, "wifi_password"); if (val.length() > 0) strncpy(wifiPassword, val.c_str(), sizeof(wifiPassword) - 1);
-      val = getJsonValue(body, "name"); if (val.length() > 0) strncpy(deviceName, val.c_str(), sizeof(deviceName) - 1);
-      
-      val = getJsonValue(body, "speed_offset"); if (val.length() > 0) speedOffset = val.toFloat();
-      val = getJsonValue(body, "speed_scale"); if (val.length() > 0) speedScale = val.toFloat();
-      val = getJsonValue(body, "pulses_per_rotation"); if (val.length() > 0) pulsesPerRotation = val.toInt();
-      val = getJsonValue(body, "distance_offset"); if (val.length() > 0) distanceOffset = val.toFloat();
-      val = getJsonValue(body, "angle_offset"); if (val.length() > 0) angleOffset = val.toFloat();
-      val = getJsonValue(body, "accel_offset"); if (val.length() > 0) accelOffset = val.toFloat();
-      val = getJsonValue(body, "accel_scale"); if (val.length() > 0) accelScale = val.toFloat();
-      val = getJsonValue(body, "vibration_offset"); if (val.length() > 0) vibrationOffset = val.toFloat();
-      
-      val = getJsonValue(body, "api_key");
-      if (val.length() > 0 && val.length() < 64) {
-         strncpy(apiKey, val.c_str(), sizeof(apiKey) - 1);
-      }
-      
-      val = getJsonValue(body, "device_password");
-      if (val.length() > 0 && val.length() < 32) {
-         strncpy(devicePassword, val.c_str(), sizeof(devicePassword) - 1);
-      }
-      
-      val = getJsonValue(body, "register_url");
-      if (val.length() > 0) strncpy(registerUrl, val.c_str(), sizeof(registerUrl) - 1);
-      
-      val = getJsonValue(body, "station");
-      if (val.length() > 0) strncpy(station, val.c_str(), sizeof(station) - 1);
-      
-      val = getJsonValue(body, "use_https");
-      if (val.length() > 0) useHTTPS = (val == "true" || val == "1");
-
+    for (size_t i = 0; i < fieldCount; i++) {
+      if ((bad = applyConfigField(keys[i], values[i]))) rejected[rejectedCount++] = bad;
+    }
   } else {
-      String s;
-      getParam("ssid", s); if(s.length()>0) strncpy(wifiSSID, s.c_str(), sizeof(wifiSSID)-1);
-      getParam("wifi_password", s); if(s.length()>0) strncpy(wifiPassword, s.c_str(), sizeof(wifiPassword)-1);
-      getParam("name", s); if(s.length()>0) strncpy(deviceName, s.c_str(), sizeof(deviceName)-1);
-      
-      getParam("speed_offset", s); if(s.length()>0) speedOffset = s.toFloat();
-      getParam("speed_scale", s); if(s.length()>0) speedScale = s.toFloat();
-      getParam("pulses_per_rotation", s); if(s.length()>0) pulsesPerRotation = s.toInt();
-      getParam("distance_offset", s); if(s.length()>0) distanceOffset = s.toFloat();
-      getParam("angle_offset", s); if(s.length()>0) angleOffset = s.toFloat();
-      getParam("accel_offset", s); if(s.length()>0) accelOffset = s.toFloat();
-      getParam("accel_scale", s); if(s.length()>0) accelScale = s.toFloat();
-      getParam("vibration_offset", s); if(s.length()>0) vibrationOffset = s.toFloat();
-      
-      getParam("api_key", s);
-      if (s.length() > 0 && s.length() < 64) {
-        strncpy(apiKey, s.c_str(), sizeof(apiKey) - 1);
-      }
-      
-      getParam("device_password", s);
-      if (s.length() > 0 && s.length() < 32) {
-        strncpy(devicePassword, s.c_str(), sizeof(devicePassword) - 1);
-      }
+    for (auto it = params->beginQueryParameters(); it != params->endQueryParameters(); ++it) {
+      bad = applyConfigField(stringToken(it->first), stringToken(it->second));
+      if (bad && rejectedCount < maxFields) rejected[rejectedCount++] = bad;
+    }
+  }
+  // The rule string is checked as a whole; a bad one keeps the old rules,
+  // restored before the saver can see the rejected text
+  if (!reloadEventRules() && rejectedCount < maxFields) {
+    rejected[rejectedCount++] = findConfigField("event_rules", strlen("event_rules"));
+  }
+  xSemaphoreGive(configMutex);
+  
+  // No-op unless ntp_server or ntp_interval_s changed
+  startTimeSync();
+  
+  // Persisted in the background so the response is not held up by flash
+  requestConfigSave();
+  
+  IPAddress local = WiFi.localIP();
+  char ip[16];
+  snprintf(ip, sizeof(ip), "%u.%u.%u.%u", local[0], local[1], local[2], local[3]);
+  
+  res->setHeader("Content-Type", "application/json");
+  JsonWriter w(*res);
+  w.beginObject();
+  w.field("status", "ok");
+  
+  w.key("device").beginObject();
+  w.field("name", deviceName);
+  w.field("ip", ip);
+  w.field("uptime_min", millis() / 60000.0f, 2);
+  w.field("heap_free", (unsigned long)ESP.getFreeHeap());
+  w.field("chip_model", ESP.getChipModel());
+  w.field("use_https", useHTTPS);
+  w.endObject();
+  
+  w.key("security").beginObject();
+  w.field("https_enabled", useHTTPS);
+  w.field("server_running", serverStarted);
+  w.field("lan_http_running", lanServer != NULL && lanServer->isRunning());
+  // Secrets are never echoed; some show their first 4 chars for identification
+  for (size_t i = 0; i < configFieldCount(); i++) {
+    const ConfigField& field = configFieldAt(i);
+    if (!(field.flags & CFG_SECRET)) continue;
+    const char* secret = (const char*)field.ptr;
+    char masked[9];
+    if ((field.flags & CFG_SHOW_PREFIX) && strlen(secret) >= 4) {
+      snprintf(masked, sizeof(masked), "%.4s****", secret);
+    } else {
+      strcpy(masked, (field.flags & CFG_SHOW_PREFIX) ? "****" : "(hidden)");
+    }
+    w.field(field.name, masked);
+  }
+  w.field("cert_size", cert ? (unsigned long)cert->getCertLength() : 0UL);
+  w.field("key_size", cert ? (unsigned long)cert->getPKLength() : 0UL);
+  w.field("cert_source", certSourceName(certSource));
+  TLSStats tls;
+  if (getTLSStats(tls)) {
+    w.key("tls").beginObject();
+    w.field("key_type", keyTypeName(tls.keyType));
+    w.field("max_connections", (unsigned)tls.maxConnections);
+    w.field("open_connections", (unsigned)tls.openConnections);
+    w.field("handshakes", (unsigned long)tls.handshakes);
+    w.field("handshake_failures", (unsigned long)tls.failures);
+    w.field("resumed", (unsigned long)tls.resumed);
+    w.field("handshake_last_ms", (unsigned long)tls.lastMs);
+    w.field("handshake_max_ms", (unsigned long)tls.maxMs);
+    w.field("handshake_avg_ms", (unsigned long)(tls.handshakes ? tls.totalMs / tls.handshakes : 0));
+    w.field("heap_per_connection", (unsigned long)tls.heapPerConnection);
+    w.field("handshake_heap_peak", (unsigned long)tls.heapPeak);
+    w.field("deferred", (unsigned long)tls.deferred);
+    w.field("rejected", (unsigned long)tls.rejected);
+    w.field("evicted", (unsigned long)tls.evicted);
+    w.endObject();
+  }
+  w.endObject();
+  
+  WiFiStats wifi;
+  getWiFiStats(wifi);
+  w.key("wifi").beginObject();
+  w.field("connected", wifi.connected);
+  w.field("rssi", (int)WiFi.RSSI());
+  w.field("channel", (int)WiFi.channel());
+  w.field("static_ip", wifiIp[0] != '\0');
+  w.field("connects", (unsigned long)wifi.connects);
+  w.field("fast_connects", (unsigned long)wifi.fastConnects);
+  w.field("disconnects", (unsigned long)wifi.disconnects);
+  w.field("failed_attempts", (unsigned long)wifi.failedAttempts);
+  w.field("last_connect_ms", (unsigned long)wifi.lastConnectMs);
+  w.field("boot_connect_ms", (unsigned long)wifi.bootConnectMs);
+  w.field("last_reason", (unsigned)wifi.lastReason);
+  w.endObject();
+  
+  UploadStats upload;
+  if (getUploadStats(upload)) {
+    w.key("upload").beginObject();
+    w.field("uploaded", (unsigned long)upload.uploaded);
+    w.field("batches", (unsigned long)upload.batches);
+    w.field("failures", (unsigned long)upload.failures);
+    w.field("rejected", (unsigned long)upload.rejected);
+    w.field("dropped", (unsigned long)upload.dropped);
+    w.field("queued_ram", (unsigned long)upload.queuedRam);
+    w.field("queued_flash", (unsigned long)upload.queuedFlash);
+    w.field("backoff_ms", (unsigned long)upload.backoffMs);
+    w.field("last_status", upload.lastStatus);
+    w.endObject();
+  }
+  
+  w.key("config").beginObject();
+  for (size_t i = 0; i < configFieldCount(); i++) {
+    const ConfigField& field = configFieldAt(i);
+    if (field.flags & CFG_SECRET) continue;
+    writeConfigField(w.key(field.name), field);
+  }
+  w.endObject();
+  
+  w.key("rejected").beginArray();
+  for (size_t i = 0; i < rejectedCount; i++) w.value(rejected[i]->name);
+  w.endArray();
+  
+  w.endObject();
+}
 
-      getParam("register_url", s);
-      if (s.length() > 0) strncpy(registerUrl, s.c_str(), sizeof(registerUrl) - 1);
+static void printSessionInfo(const SessionInfo& info, void* ctx) {
+  JsonWriter& w = *(JsonWriter*)ctx;
+  w.beginObject();
+  w.field("id", (unsigned long)info.id);
+  w.field("job", info.job);
+  w.field("start_ms", (unsigned long)info.startMs);
+  w.field("bytes", (unsigned long)info.bytes);
+  w.field("complete", info.complete);
+  w.field("active", info.active);
+  w.endObject();
+}
 
-      getParam("station", s);
-      if (s.length() > 0) strncpy(station, s.c_str(), sizeof(station) - 1);
+void handleSessions(HTTPRequest * req, HTTPResponse * res) {
+  res->setHeader("Content-Type", "application/json");
+  JsonWriter w(*res);
+  w.beginObject();
+  w.key("sessions").beginArray();
+  sessionLogList(&printSessionInfo, &w);
+  w.endArray();
+  w.field("dropped_records", (unsigned long)sessionLogDropped());
+  w.endObject();
+}
 
-      getParam("use_https", s);
-      if (s.length() > 0) useHTTPS = (s == "true" || s == "1");
+void handleEvents(HTTPRequest * req, HTTPResponse * res) {
+  uint32_t since = 0;
+  ResourceParameters *params = req->getParams();
+  if (params->isQueryParameterSet("since")) {
+    std::string s;
+    params->getQueryParameter("since", s);
+    since = strtoul(s.c_str(), NULL, 10);
   }
   
-  saveConfig();
-  
-  String json = "{";
-  json += "\"status\":\"ok\",";
-  json += "\"device\":{";
-  json += "\"name\":\"" + String(deviceName) + "\",";
-  json += "\"ip\":\"" + WiFi.localIP().toString() + "\",";
-  json += "\"uptime_min\":" + String(millis() / 60000.0f, 2) + ",";
-  json += "\"heap_free\":" + String(ESP.getFreeHeap()) + ",";
-  json += "\"chip_model\":\"" + String(ESP.getChipModel()) + "\",";
-  json += "\"use_https\":" + String(useHTTPS ? "true" : "false");
-  json += "},";
-  json += "\"security\":{";
-  json += "\"https_enabled\":" + String(useHTTPS ? "true" : "false") + ",";
-  json += "\"server_running\":" + String(serverStarted ? "true" : "false") + ",";
-  json += "\"wifi_password\":\"(hidden)\",";
-  json += "\"device_password\":\"(hidden)\",";
-  
-  // Mask API key but show first 4 chars for identification
-  String maskedKey = "";
-  if (strlen(apiKey) >= 4) {
-    char firstFour[5];
-    strncpy(firstFour, apiKey, 4);
-    firstFour[4] = '\0';
-    maskedKey = String(firstFour) + "****";
-  } else {
-    maskedKey = "****";
-  }
-  json += "\"api_key\":\"" + maskedKey + "\",";
-  if (cert) {
-    json += "\"cert_size\":" + String(cert->getCertLength()) + ",";
-    json += "\"key_size\":" + String(cert->getPKLength());
-  } else {
-    json += "\"cert_size\":0,";
-    json += "\"key_size\":0";
+  uint32_t latest = latestEventId();
+  uint32_t first = since + 1 < oldestEventId() ? oldestEventId() : since + 1;
+  
+  res->setHeader("Content-Type", "application/json");
+  JsonWriter w(*res);
+  w.beginObject();
+  w.key("events").beginArray();
+  for (uint32_t id = first; id <= latest; id++) {
+    Event e;
+    if (getEvent(id, e)) writeEventJson(w, e);
   }
-  json += "},";
-  json += "\"config\":{";
-  json += "\"ssid\":\"" + String(wifiSSID) + "\",";
-  json += "\"speed_offset\":" + String(speedOffset) + ",";
-  json += "\"speed_scale\":" + String(speedScale) + ",";
-  json += "\"pulses_per_rotation\":" + String(pulsesPerRotation) + ",";
-  json += "\"distance_offset\":" + String(distanceOffset) + ",";
-  json += "\"angle_offset\":" + String(angleOffset) + ",";
-  json += "\"accel_offset\":" + String(accelOffset) + ",";
-  json += "\"accel_scale\":" + String(accelScale) + ",";
-  json += "\"register_url\":\"" + String(registerUrl) + "\",";
-  json += "\"station\":\"" + String(station) + "\",";
-  json += "\"vibration_offset\":" + String(vibrationOffset);
-  json += "}";
-  json += "}";
+  w.endArray();
+  w.field("latest_id", (unsigned long)latest);
+  // Events between `since` and the oldest still held were overwritten
+  w.field("missed", (unsigned long)(first - since - 1));
+  w.endObject();
+}
+
+void handleTime(HTTPRequest * req, HTTPResponse * res) {
+  TimeStats t;
+  getTimeStats(t);
+  uint64_t mono = monoUs();
+  uint64_t utc = utcMs();
   
   res->setHeader("Content-Type", "application/json");
-  res->print(json);
+  JsonWriter w(*res);
+  w.beginObject();
+  w.field("utc_ms", (unsigned long long)utc);
+  w.field("mono_us", (unsigned long long)mono);
+  w.field("t_ms", (unsigned long)millis());
+  w.field("synced", t.synced);
+  w.field("server", ntpServer);
+  w.field("interval_s", ntpIntervalS);
+  w.field("syncs", (unsigned long)t.syncs);
+  w.field("last_offset_ms", t.lastOffsetUs / 1000.0f, 3);
+  w.field("drift_ppm", t.driftPpb / 1000.0f, 3);
+  w.field("since_sync_s", t.synced ? (unsigned long)((mono - t.lastSyncUs) / 1000000) : 0UL);
+  w.endObject();
+}
+
+void handleSessionDownload(HTTPRequest * req, HTTPResponse * res) {
+  std::string idStr;
+  req->getParams()->getPathParameter(0, idStr);
+  uint32_t id = strtoul(idStr.c_str(), NULL, 10);
+  
+  char path[40];
+  File file;
+  if (sessionLogPath(id, path, sizeof(path)) && SPIFFS.exists(path)) {
+    file = SPIFFS.open(path, FILE_READ);
+  }
+  if (!file) {
+    res->setStatusCode(404);
+    res->setHeader("Content-Type", "application/json");
+    res->print("{\"error\":\"Session not found\"}");
+    return;
+  }
+  
+  char lenStr[12];
+  snprintf(lenStr, sizeof(lenStr), "%u", (unsigned)file.size());
+  res->setHeader("Content-Type", "application/octet-stream");
+  res->setHeader("Content-Length", lenStr);
+  
+  // Stream in fixed-size chunks; the session never has to fit in RAM
+  uint8_t chunk[512];
+  size_t n;
+  while ((n = file.read(chunk, sizeof(chunk))) > 0) {
+    res->write(chunk, n);
+  }
+  file.close();
+}
+
+void handleMetrics(HTTPRequest * req, HTTPResponse * res) {
+  res->setHeader("Content-Type", "text/plain; version=0.0.4");
+  writeMetrics(*res);
+}
+
+#if ENABLE_PROFILER
+void handleProfile(HTTPRequest * req, HTTPResponse * res) {
+  std::string value;
+  bool reset = req->getParams()->getQueryParameter("reset", value) && value == "1";
+  res->setHeader("Content-Type", "text/plain");
+  writeProfile(*res, reset);
+}
+#endif
+
+// Outermost middleware, so rejected requests are counted too
+void middlewareMetrics(HTTPRequest * req, HTTPResponse * res, std::function<void()> next) {
+  PROFILE_SCOPE(PROF_HTTP_REQUEST);
+  int64_t start = esp_timer_get_time();
+  next();
+  recordHttpRequest(req->getRequestString().c_str(), res->getStatusCode(),
+                    (uint32_t)(esp_timer_get_time() - start));
 }
 
 void middlewareAuthentication(HTTPRequest * req, HTTPResponse * res, std::function<void()> next) {
-  // All requests require X-API-Key header
+  // All requests require X-API-Key header. Browsers cannot set headers on
+  // a WebSocket, so the /ws upgrade may pass it as ?key= instead.
   std::string headerKey = req->getHeader("X-API-Key");
+  if (headerKey.empty() && isWebSocketUpgrade(req)) {
+    req->getParams()->getQueryParameter("key", headerKey);
+  }
   
   if (headerKey == std::string(apiKey)) {
     next();
@@ -274,104 +468,148 @@ void middlewareAuthentication(HTTPRequest * req, HTTPResponse * res, std::functi
   }
 }
 
+// Read-only listener: clients on the device's own subnet only, and the
+// read key (never the API key, which would travel in the clear) if set
+void middlewareLanReadOnly(HTTPRequest * req, HTTPResponse * res, std::function<void()> next) {
+  uint32_t client = (uint32_t)req->getClientIP();
+  uint32_t mask = (uint32_t)WiFi.subnetMask();
+  if ((client & mask) != ((uint32_t)WiFi.localIP() & mask)) {
+    res->setStatusCode(403);
+    res->setHeader("Content-Type", "application/json");
+    res->print("{\"error\":\"Plain HTTP is only served on the local network.\"}");
+    return;
+  }
+  if (readKey[0] && req->getHeader("X-API-Key") != std::string(readKey)) {
+    res->setStatusCode(401);
+    res->setHeader("Content-Type", "application/json");
+    res->print("{\"error\":\"Unauthorized. Missing or invalid X-API-Key header (read key).\"}");
+    return;
+  }
+  next();
+}
+
+void handleHTTPSRequired(HTTPRequest * req, HTTPResponse * res) {
+  req->discardRequestBody();
+  res->setStatusCode(403);
+  res->setHeader("Content-Type", "application/json");
+  res->printf("{\"error\":\"Use HTTPS (port %d) for this endpoint.\"}", httpsPort);
+}
+
+static void registerReadNodes(HTTPServer *srv) {
+  srv->registerNode(new ResourceNode("/", "GET", &handleRoot));
+  srv->registerNode(new ResourceNode("/readings", "GET", &handleReadings));
+  srv->registerNode(new ResourceNode("/events", "GET", &handleEvents));
+  srv->registerNode(new ResourceNode("/time", "GET", &handleTime));
+  srv->registerNode(new ResourceNode("/metrics", "GET", &handleMetrics));
+  srv->registerNode(new ResourceNode("/sessions", "GET", &handleSessions));
+  srv->registerNode(new ResourceNode("/sessions/*", "GET", &handleSessionDownload));
+}
+
 void registerRoutes(HTTPServer *srv) {
   // Register authentication middleware globally
+  srv->addMiddleware(&middlewareMetrics);
   srv->addMiddleware(&middlewareAuthentication);
 
-  ResourceNode * nodeRoot = new ResourceNode("/", "GET", &handleRoot);
-  ResourceNode * nodeStart = new ResourceNode("/start", "POST", &handleStart);
-  ResourceNode * nodeReadings = new ResourceNode("/readings", "GET", &handleReadings);
-  ResourceNode * nodeConfig = new ResourceNode("/config", "POST", &handleConfig);
+  registerReadNodes(srv);
+  srv->registerNode(new ResourceNode("/start", "POST", &handleStart));
+  srv->registerNode(new ResourceNode("/config", "POST", &handleConfig));
+  #if ENABLE_PROFILER
+  // ?reset=1 clears the accumulators, so the API key is required
+  srv->registerNode(new ResourceNode("/profile", "GET", &handleProfile));
+  #endif
+  registerWebSocket(srv);
+}
+
+void registerReadOnlyRoutes(HTTPServer *srv) {
+  srv->addMiddleware(&middlewareMetrics);
+  srv->addMiddleware(&middlewareLanReadOnly);
 
-  srv->registerNode(nodeRoot);
-  srv->registerNode(nodeStart);
-  srv->registerNode(nodeReadings);
-  srv->registerNode(nodeConfig);
+  registerReadNodes(srv);
+  srv->registerNode(new ResourceNode("/start", "POST", &handleHTTPSRequired));
+  srv->registerNode(new ResourceNode("/config", "POST", &handleHTTPSRequired));
+  #if ENABLE_PROFILER
+  srv->registerNode(new ResourceNode("/profile", "GET", &handleHTTPSRequired));
+  #endif
 }
 
 void setupHTTPServer() {
-  Serial.println("Setting up HTTP Server (port 80)...");
-  server = new HTTPServer(80);
+  LOG_I("HTTP", "Setting up HTTP Server (port %d)...", httpPort);
+  TaskServer<PlainServer>* srv = new TaskServer<PlainServer>(httpPort);
+  server = srv;
   
   if (server) {
     registerRoutes(server);
+    srv->onTick(pollWebSockets);
     server->start();
-    if (server->isRunning()) {
+    if (server->isRunning() && srv->startTask("HTTPServer")) {
         serverStarted = true;
-        Serial.println("HTTP Server Ready on port 80");
+        LOG_I("HTTP", "HTTP Server Ready on port %d", httpPort);
     } else {
-        Serial.println("ERROR: HTTP Server failed to start!");
+        LOG_E("HTTP", "HTTP Server failed to start!");
     }
   }
 }
 
+// Plain HTTP next to HTTPS, for high-rate reads without TLS cost
+void setupLanServer() {
+  if (httpPort == httpsPort) {
+    LOG_E("HTTP", "http_port and https_port are the same, LAN HTTP disabled");
+    return;
+  }
+  LOG_I("HTTP", "Setting up read-only LAN HTTP Server (port %d)...", httpPort);
+  TaskServer<HTTPServer>* srv = new TaskServer<HTTPServer>(httpPort);
+  lanServer = srv;
+
+  registerReadOnlyRoutes(lanServer);
+  lanServer->start();
+  if (lanServer->isRunning() && srv->startTask("LANServer", lanTaskStack)) {
+    LOG_I("HTTP", "LAN HTTP Server Ready on port %d (read-only)", httpPort);
+  } else {
+    LOG_E("HTTP", "LAN HTTP Server failed to start!");
+  }
+}
+
 void setupHTTPSServer() {
-  Serial.printf("Free heap before HTTPS setup: %u bytes\n", ESP.getFreeHeap());
-  Serial.println("Setting up HTTPS Server (port 443)...");
+  LOG_I("HTTP", "Free heap before HTTPS setup: %u bytes", ESP.getFreeHeap());
+  LOG_I("HTTP", "Setting up HTTPS Server (port %d)...", httpsPort);
   
   // Try to allocate certificate
   cert = new SSLCert();
   if (!cert) {
-    Serial.println("ERROR: Failed to allocate SSLCert - out of memory!");
+    LOG_E("HTTP", "Failed to allocate SSLCert - out of memory!");
     return;
   }
   
-  bool hasCert = false;
-  if (SPIFFS.exists("/cert.der") && SPIFFS.exists("/key.der")) {
-    Serial.println("Loading cert from SPIFFS...");
-    File certFile = SPIFFS.open("/cert.der", "r");
-    File keyFile = SPIFFS.open("/key.der", "r");
-    
-    if (certFile && keyFile) {
-       uint16_t certLen = certFile.size();
-       uint16_t keyLen = keyFile.size();
-       
-       Serial.printf("Cert size: %d bytes, Key size: %d bytes\n", certLen, keyLen);
-       
-       uint8_t * cData = new uint8_t[certLen];
-       uint8_t * kData = new uint8_t[keyLen];
-       
-       if (cData && kData) {
-         certFile.read(cData, certLen);
-         keyFile.read(kData, keyLen);
-         
-         *cert = SSLCert(cData, certLen, kData, keyLen);
-         hasCert = true;
-         Serial.println("Cert loaded from SPIFFS successfully.");
-       } else {
-         Serial.println("ERROR: Failed to allocate cert buffers!");
-         if (cData) delete[] cData;
-         if (kData) delete[] kData;
-       }
-    }
-    certFile.close();
-    keyFile.close();
+  certSource = loadCertificate(*cert);
+  bool hasCert = certSource != CERT_NONE;
+  if (hasCert) {
+    LOG_I("HTTP", "Cert: %u bytes, key: %u bytes, from %s",
+          cert->getCertLength(), cert->getPKLength(), certSourceName(certSource));
   }
   
   if (!hasCert) {
-      Serial.println("");
-      Serial.println("====== CERTIFICATE REQUIRED ======");
-      Serial.println("No certificate found in SPIFFS!");
-      Serial.println("");
-      Serial.println("This device requires a pre-generated certificate");
-      Serial.println("due to memory constraints.");
-      Serial.println("");
-      Serial.println("Please generate using OpenSSL (see guide)");
-      Serial.println("===================================");
+      LOG_E("HTTP", "CERTIFICATE REQUIRED: no certificate found in flash or SPIFFS");
+      LOG_E("HTTP", "This device requires a pre-generated certificate due to memory constraints.");
+      LOG_E("HTTP", "Please generate using OpenSSL (see guide)");
       return;
   }
   
-  // Create HTTPS server on port 443, limiting to 1 connection to save memory
-  server = new HTTPSServer(cert, 443, 1);
+  // Connection slots follow the heap left after setup; admission is
+  // re-checked against the heap for every new client
+  uint8_t maxConnections = TLSServer::connectionBudget();
+  LOG_I("HTTP", "HTTPS connection slots: %u", maxConnections);
+  TaskServer<TLSServer>* srv = new TaskServer<TLSServer>(cert, httpsPort, maxConnections);
+  server = srv;
   
   if (server) {
     registerRoutes(server);
+    srv->onTick(pollWebSockets);
     server->start();
-    if (server->isRunning()) {
+    if (server->isRunning() && srv->startTask("HTTPSServer")) {
         serverStarted = true;
-        Serial.println("HTTPS Server Ready on port 443");
+        LOG_I("HTTP", "HTTPS Server Ready on port %d", httpsPort);
     } else {
-        Serial.println("ERROR: HTTPS Server failed to start!");
+        LOG_E("HTTP", "HTTPS Server failed to start!");
     }
   }
 }
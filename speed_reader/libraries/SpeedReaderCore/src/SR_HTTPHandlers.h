@@ -18,10 +18,21 @@ void handleRoot(HTTPRequest * req, HTTPResponse * res);
 void handleStart(HTTPRequest * req, HTTPResponse * res);
 void handleReadings(HTTPRequest * req, HTTPResponse * res);
 void handleConfig(HTTPRequest * req, HTTPResponse * res);
+void handleSessions(HTTPRequest * req, HTTPResponse * res);
+void handleEvents(HTTPRequest * req, HTTPResponse * res);
+void handleTime(HTTPRequest * req, HTTPResponse * res);
+void handleMetrics(HTTPRequest * req, HTTPResponse * res);
+void handleProfile(HTTPRequest * req, HTTPResponse * res);
+void handleSessionDownload(HTTPRequest * req, HTTPResponse * res);
+void handleHTTPSRequired(HTTPRequest * req, HTTPResponse * res);
+void middlewareMetrics(HTTPRequest * req, HTTPResponse * res, std::function<void()> next);
 void middlewareAuthentication(HTTPRequest * req, HTTPResponse * res, std::function<void()> next);
+void middlewareLanReadOnly(HTTPRequest * req, HTTPResponse * res, std::function<void()> next);
 void registerRoutes(HTTPServer *srv);
+void registerReadOnlyRoutes(HTTPServer *srv);
 void setupHTTPServer();
 void setupHTTPSServer();
+void setupLanServer();
 #endif
 
 #endif // SR_HTTP_HANDLERS_H
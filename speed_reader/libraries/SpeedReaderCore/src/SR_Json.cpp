@@ -0,0 +1,277 @@
+#include "SR_Json.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+// ===== Token helpers =====
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Decodes one escape sequence starting after the backslash. Writes up to
+// 4 bytes (UTF-8) to out and returns how many; *in is advanced.
+static size_t decodeEscape(const char*& in, const char* end, char* out) {
+  if (in >= end) return 0;
+  char c = *in++;
+  switch (c) {
+    case 'b': out[0] = '\b'; return 1;
+    case 'f': out[0] = '\f'; return 1;
+    case 'n': out[0] = '\n'; return 1;
+    case 'r': out[0] = '\r'; return 1;
+    case 't': out[0] = '\t'; return 1;
+    case 'u': {
+      if (end - in < 4) return 0;
+      uint32_t cp = 0;
+      for (int i = 0; i < 4; i++) {
+        int h = hexValue(in[i]);
+        if (h < 0) return 0;
+        cp = (cp << 4) | (uint32_t)h;
+      }
+      in += 4;
+      if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+      } else if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+      }
+      out[0] = (char)(0xE0 | (cp >> 12));
+      out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+      out[2] = (char)(0x80 | (cp & 0x3F));
+      return 3;
+    }
+    default:  // \" \\ \/ and anything else taken literally
+      out[0] = c;
+      return 1;
+  }
+}
+
+bool JsonToken::equals(const char* s) const {
+  if (!escaped) {
+    return strlen(s) == len && memcmp(p, s, len) == 0;
+  }
+  const char* in = p;
+  const char* end = p + len;
+  char buf[4];
+  while (in < end) {
+    size_t n = 1;
+    if (*in == '\\') {
+      in++;
+      n = decodeEscape(in, end, buf);
+      if (n == 0) return false;
+    } else {
+      buf[0] = *in++;
+    }
+    for (size_t i = 0; i < n; i++) {
+      if (*s++ != buf[i]) return false;
+    }
+  }
+  return *s == '\0';
+}
+
+bool JsonToken::copyTo(char* out, size_t cap) const {
+  if (cap == 0) return false;
+  size_t o = 0;
+  const char* in = p;
+  const char* end = p + len;
+  char buf[4];
+  while (in < end) {
+    size_t n = 1;
+    if (escaped && *in == '\\') {
+      in++;
+      n = decodeEscape(in, end, buf);
+      if (n == 0) {   // bad or truncated escape
+        out[o] = '\0';
+        return false;
+      }
+    } else {
+      buf[0] = *in++;
+    }
+    if (o + n >= cap) {
+      out[o] = '\0';
+      return false;
+    }
+    memcpy(out + o, buf, n);
+    o += n;
+  }
+  out[o] = '\0';
+  return true;
+}
+
+// The conversions take the whole token or nothing: trailing characters
+// ("12abc", an int written as 5e9) and values out of range are rejected.
+bool JsonToken::toFloat(float& out) const {
+  char buf[32];
+  if ((type != JSON_NUMBER && type != JSON_STRING) || !copyTo(buf, sizeof(buf))) return false;
+  char* endp;
+  errno = 0;
+  float v = strtof(buf, &endp);
+  if (endp == buf || *endp != '\0' || errno == ERANGE) return false;
+  out = v;
+  return true;
+}
+
+bool JsonToken::toLong(long& out) const {
+  char buf[24];
+  if ((type != JSON_NUMBER && type != JSON_STRING) || !copyTo(buf, sizeof(buf))) return false;
+  char* endp;
+  errno = 0;
+  long v = strtol(buf, &endp, 10);
+  if (endp == buf || *endp != '\0' || errno == ERANGE) return false;
+  out = v;
+  return true;
+}
+
+bool JsonToken::toUInt64(uint64_t& out) const {
+  char buf[24];
+  if ((type != JSON_NUMBER && type != JSON_STRING) || !copyTo(buf, sizeof(buf)) || buf[0] == '-') return false;
+  char* endp;
+  errno = 0;
+  unsigned long long v = strtoull(buf, &endp, 10);
+  if (endp == buf || *endp != '\0' || errno == ERANGE) return false;
+  out = v;
+  return true;
+}
+
+bool JsonToken::toBool(bool& out) const {
+  if (equals("true") || equals("1")) { out = true; return true; }
+  if (equals("false") || equals("0")) { out = false; return true; }
+  if (type == JSON_NUMBER) {
+    float f;
+    if (!toFloat(f)) return false;
+    out = (f != 0.0f);
+    return true;
+  }
+  return false;
+}
+
+// ===== Scanner =====
+JsonScanner::JsonScanner(const char* json, size_t len)
+  : _p(json), _end(json + len), _started(false), _done(false), _error(false) {
+}
+
+bool JsonScanner::skipWs() {
+  while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r')) _p++;
+  return _p < _end;
+}
+
+bool JsonScanner::scanString(JsonToken& tok) {
+  // _p is on the opening quote
+  _p++;
+  tok.p = _p;
+  tok.type = JSON_STRING;
+  tok.escaped = false;
+  while (_p < _end) {
+    char c = *_p;
+    if (c == '\\') {
+      tok.escaped = true;
+      _p += 2;
+      continue;
+    }
+    if (c == '"') {
+      tok.len = _p - tok.p;
+      _p++;
+      return true;
+    }
+    _p++;
+  }
+  return false;
+}
+
+bool JsonScanner::skipNested() {
+  // _p is on '{' or '['; strings may contain brackets, so track them
+  int depth = 0;
+  while (_p < _end) {
+    char c = *_p;
+    if (c == '"') {
+      JsonToken ignored;
+      if (!scanString(ignored)) return false;
+      continue;
+    }
+    if (c == '{' || c == '[') depth++;
+    else if (c == '}' || c == ']') {
+      depth--;
+      if (depth == 0) {
+        _p++;
+        return true;
+      }
+    }
+    _p++;
+  }
+  return false;
+}
+
+bool JsonScanner::scanValue(JsonToken& tok) {
+  if (!skipWs()) return false;
+  char c = *_p;
+  tok.escaped = false;
+
+  if (c == '"') return scanString(tok);
+
+  if (c == '{' || c == '[') {
+    tok.type = (c == '{') ? JSON_OBJECT : JSON_ARRAY;
+    tok.p = _p;
+    if (!skipNested()) return false;
+    tok.len = _p - tok.p;
+    return true;
+  }
+
+  // Bare literal: number, true/false, null
+  tok.p = _p;
+  while (_p < _end && *_p != ',' && *_p != '}' && *_p != ']' &&
+         *_p != ' ' && *_p != '\t' && *_p != '\n' && *_p != '\r') {
+    _p++;
+  }
+  tok.len = _p - tok.p;
+  if (tok.len == 0) return false;
+
+  if (c == 't' || c == 'f') tok.type = JSON_BOOL;
+  else if (c == 'n') tok.type = JSON_NULL;
+  else tok.type = JSON_NUMBER;
+  return true;
+}
+
+bool JsonScanner::next(JsonToken& key, JsonToken& value) {
+  if (_done || _error) return false;
+
+  if (!_started) {
+    _started = true;
+    if (!skipWs() || *_p != '{') {
+      _error = true;
+      return false;
+    }
+    _p++;
+    if (skipWs() && *_p == '}') {
+      _done = true;
+      return false;
+    }
+  } else {
+    // After a value: expect ',' or '}'
+    if (!skipWs()) { _error = true; return false; }
+    if (*_p == '}') {
+      _done = true;
+      return false;
+    }
+    if (*_p != ',') { _error = true; return false; }
+    _p++;
+  }
+
+  if (!skipWs() || *_p != '"' || !scanString(key)) { _error = true; return false; }
+  if (!skipWs() || *_p != ':') { _error = true; return false; }
+  _p++;
+  if (!scanValue(value)) { _error = true; return false; }
+  return true;
+}
+
+bool jsonFind(const char* json, size_t len, const char* key, JsonToken& value) {
+  JsonScanner scanner(json, len);
+  JsonToken k;
+  while (scanner.next(k, value)) {
+    if (k.equals(key)) return true;
+  }
+  return false;
+}
@@ -0,0 +1,71 @@
+#ifndef SR_JSON_H
+#define SR_JSON_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== Single-pass JSON object scanner =====
+// Walks the members of one JSON object in a single pass over a
+// const char* / length, without allocating. Keys and values are returned
+// as spans into the input; escapes are only decoded when a string is
+// copied out. Nested objects and arrays are skipped as whole values.
+//
+// Free of Arduino dependencies so it can be built and exercised on a host.
+
+enum JsonType : uint8_t {
+  JSON_NONE,
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_BOOL,
+  JSON_NULL,
+  JSON_OBJECT,
+  JSON_ARRAY
+};
+
+struct JsonToken {
+  const char* p;    // for strings: first char after the opening quote
+  size_t len;       // raw length (escapes not decoded)
+  JsonType type;
+  bool escaped;     // string contains backslash escapes
+
+  // Compares a key or string value with a plain C string
+  bool equals(const char* s) const;
+
+  // Decodes the string (or copies the raw token) into out, always
+  // NUL-terminated. Returns false if it did not fit or has a bad escape.
+  bool copyTo(char* out, size_t cap) const;
+
+  bool toFloat(float& out) const;
+  bool toLong(long& out) const;
+  bool toUInt64(uint64_t& out) const;
+  bool toBool(bool& out) const;  // true/false, or a number (non-zero = true)
+};
+
+class JsonScanner {
+public:
+  JsonScanner(const char* json, size_t len);
+
+  // Advances to the next member of the top-level object. Returns false at
+  // the end of the object or on malformed input (check error()).
+  bool next(JsonToken& key, JsonToken& value);
+
+  bool error() const { return _error; }
+
+private:
+  bool skipWs();
+  bool scanString(JsonToken& tok);
+  bool scanValue(JsonToken& tok);
+  bool skipNested();
+
+  const char* _p;
+  const char* _end;
+  bool _started;
+  bool _done;
+  bool _error;
+};
+
+// Convenience for one-off lookups. Prefer iterating with JsonScanner when
+// several keys are needed.
+bool jsonFind(const char* json, size_t len, const char* key, JsonToken& value);
+
+#endif // SR_JSON_H
@@ -0,0 +1,203 @@
+#include "SR_JsonWriter.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef ARDUINO
+#include <Print.h>
+
+static size_t printSink(void* ctx, const char* data, size_t len) {
+  return ((Print*)ctx)->write((const uint8_t*)data, len);
+}
+
+JsonWriter::JsonWriter(Print& out) : JsonWriter(&printSink, &out) {
+}
+#endif
+
+JsonWriter::JsonWriter(char* buf, size_t cap)
+  : _buf(buf), _cap(cap), _len(0), _sink(NULL), _ctx(NULL), _total(0),
+    _hasItems(0), _depth(0), _afterKey(false), _overflow(cap == 0) {
+  if (cap > 0) buf[0] = '\0';
+}
+
+JsonWriter::JsonWriter(JsonSink sink, void* ctx)
+  : _buf(_stage), _cap(STAGE_SIZE), _len(0), _sink(sink), _ctx(ctx), _total(0),
+    _hasItems(0), _depth(0), _afterKey(false), _overflow(false) {
+}
+
+// ===== Output =====
+void JsonWriter::put(const char* s, size_t n) {
+  _total += n;
+  if (_sink) {
+    while (n > 0) {
+      if (_len == STAGE_SIZE) flush();
+      size_t c = STAGE_SIZE - _len;
+      if (c > n) c = n;
+      memcpy(_stage + _len, s, c);
+      _len += c;
+      s += c;
+      n -= c;
+    }
+    return;
+  }
+
+  // Fixed buffer: keep room for the terminator
+  if (_overflow || _len + n >= _cap) {
+    _overflow = true;
+    return;
+  }
+  memcpy(_buf + _len, s, n);
+  _len += n;
+  _buf[_len] = '\0';
+}
+
+void JsonWriter::flush() {
+  if (!_sink || _len == 0) return;
+  if (_sink(_ctx, _stage, _len) != _len) _overflow = true;
+  _len = 0;
+}
+
+void JsonWriter::putEscaped(const char* s, size_t n) {
+  // Copy runs of plain characters in one go
+  size_t run = 0;
+  for (size_t i = 0; i < n; i++) {
+    unsigned char c = (unsigned char)s[i];
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      run++;
+      continue;
+    }
+    put(s + i - run, run);
+    run = 0;
+
+    char esc[7] = { '\\', 0 };
+    switch (c) {
+      case '"':  esc[1] = '"'; break;
+      case '\\': esc[1] = '\\'; break;
+      case '\n': esc[1] = 'n'; break;
+      case '\r': esc[1] = 'r'; break;
+      case '\t': esc[1] = 't'; break;
+      case '\b': esc[1] = 'b'; break;
+      case '\f': esc[1] = 'f'; break;
+      default:
+        snprintf(esc, sizeof(esc), "\\u%04x", c);
+        put(esc, 6);
+        continue;
+    }
+    put(esc, 2);
+  }
+  put(s + n - run, run);
+}
+
+// ===== Structure =====
+void JsonWriter::separator() {
+  if (_afterKey) {
+    _afterKey = false;
+    return;
+  }
+  uint16_t bit = (uint16_t)(1u << _depth);
+  if (_hasItems & bit) put(',');
+  _hasItems |= bit;
+}
+
+JsonWriter& JsonWriter::beginObject() {
+  separator();
+  put('{');
+  if (_depth + 1 < MAX_DEPTH) _depth++;
+  _hasItems &= (uint16_t)~(1u << _depth);
+  return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+  put('}');
+  if (_depth > 0) _depth--;
+  return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+  separator();
+  put('[');
+  if (_depth + 1 < MAX_DEPTH) _depth++;
+  _hasItems &= (uint16_t)~(1u << _depth);
+  return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+  put(']');
+  if (_depth > 0) _depth--;
+  return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* k) {
+  separator();
+  put('"');
+  putEscaped(k, strlen(k));
+  put("\":", 2);
+  _afterKey = true;
+  return *this;
+}
+
+// ===== Values =====
+JsonWriter& JsonWriter::value(const char* s) {
+  return value(s, s ? strlen(s) : 0);
+}
+
+JsonWriter& JsonWriter::value(const char* s, size_t len) {
+  separator();
+  put('"');
+  if (s) putEscaped(s, len);
+  put('"');
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+  separator();
+  if (b) put("true", 4);
+  else put("false", 5);
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(long v) {
+  char num[24];
+  int n = snprintf(num, sizeof(num), "%ld", v);
+  separator();
+  put(num, n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long v) {
+  char num[24];
+  int n = snprintf(num, sizeof(num), "%lu", v);
+  separator();
+  put(num, n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long long v) {
+  char num[24];
+  int n = snprintf(num, sizeof(num), "%llu", v);
+  separator();
+  put(num, n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(float f, int decimals) {
+  if (isnan(f) || isinf(f)) return null();
+  char num[32];
+  int n = snprintf(num, sizeof(num), "%.*f", decimals, (double)f);
+  if (n < 0 || n >= (int)sizeof(num)) return null();
+  separator();
+  put(num, n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+  separator();
+  put("null", 4);
+  return *this;
+}
+
+JsonWriter& JsonWriter::raw(const char* json, size_t len) {
+  separator();
+  put(json, len);
+  return *this;
+}
@@ -0,0 +1,95 @@
+#ifndef SR_JSON_WRITER_H
+#define SR_JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+class Print;
+#endif
+
+// ===== Streaming JSON writer =====
+// Writes JSON into a caller-provided buffer, or streams it to a sink
+// (HTTPResponse, File, ...) through a small internal staging buffer.
+// Commas and string escaping are handled here; nothing is allocated.
+//
+//   JsonWriter w(*res);
+//   w.beginObject();
+//   w.field("status", "ok");
+//   w.key("device").beginObject().field("uptime_min", 1.5f, 2).endObject();
+//   w.endObject();
+//   w.flush();
+//
+// The core has no Arduino dependencies so it can be built on a host; the
+// Print constructor is only available on the device.
+
+typedef size_t (*JsonSink)(void* ctx, const char* data, size_t len);
+
+class JsonWriter {
+public:
+  // Fixed buffer, always NUL-terminated. Output that does not fit sets
+  // overflow() and is dropped.
+  JsonWriter(char* buf, size_t cap);
+
+  // Streams to sink(ctx, ...) in chunks of up to STAGE_SIZE bytes.
+  JsonWriter(JsonSink sink, void* ctx);
+
+#ifdef ARDUINO
+  explicit JsonWriter(Print& out);
+#endif
+
+  ~JsonWriter() { flush(); }
+
+  JsonWriter& beginObject();
+  JsonWriter& endObject();
+  JsonWriter& beginArray();
+  JsonWriter& endArray();
+  JsonWriter& key(const char* k);
+
+  JsonWriter& value(const char* s);
+  JsonWriter& value(const char* s, size_t len);
+  JsonWriter& value(bool b);
+  JsonWriter& value(int v) { return value((long)v); }
+  JsonWriter& value(long v);
+  JsonWriter& value(unsigned int v) { return value((unsigned long)v); }
+  JsonWriter& value(unsigned long v);
+  JsonWriter& value(unsigned long long v);
+  JsonWriter& value(float f, int decimals = 2);
+  JsonWriter& null();
+
+  // Already-valid JSON (e.g. a pre-rendered object) as a value
+  JsonWriter& raw(const char* json, size_t len);
+
+  template <typename T>
+  JsonWriter& field(const char* k, T v) { return key(k).value(v); }
+  JsonWriter& field(const char* k, float f, int decimals) { return key(k).value(f, decimals); }
+
+  // Pushes staged output to the sink. Called by the destructor.
+  void flush();
+
+  size_t length() const { return _total; }  // bytes produced so far
+  bool overflow() const { return _overflow; }
+
+  static const size_t STAGE_SIZE = 64;
+  static const int MAX_DEPTH = 16;
+
+private:
+  void separator();
+  void put(const char* s, size_t n);
+  void put(char c) { put(&c, 1); }
+  void putEscaped(const char* s, size_t n);
+
+  char* _buf;
+  size_t _cap;
+  size_t _len;
+  JsonSink _sink;
+  void* _ctx;
+  char _stage[STAGE_SIZE];
+  size_t _total;
+  uint16_t _hasItems;   // bit per depth: a value was written at this level
+  int8_t _depth;
+  bool _afterKey;
+  bool _overflow;
+};
+
+#endif // SR_JSON_WRITER_H
@@ -1,9 +1,11 @@
 #include "SR_LCDDisplay.h"
 #include "globals.h"
+#include "SR_Metrics.h"
+#include "SR_Profiler.h"
 
 // ===== LCD Display Functions =====
 void updateLCD(const char* line1, const char* line2) {
-  if (xSemaphoreTake(lcdMutex, portMAX_DELAY) != pdTRUE) return;
+  if (!takeMutex(lcdMutex, MUTEX_LCD)) return;
 
   // Pad strings to 16 chars to overwrite old content without clearing
   char padded1[17];
@@ -40,6 +42,7 @@ void showJob(const String& job) {
 }
 
 void showSpeed(float speed_mph) {
+  PROFILE_SCOPE(PROF_SHOW_SPEED);
   char line1[17], line2[17];
   
   unsigned long rc = 0;
@@ -48,7 +51,7 @@ void showSpeed(float speed_mph) {
   float angle = 0.0f;
   
   // Get shared data safely
-  if (xSemaphoreTake(dataMutex, portMAX_DELAY) == pdTRUE) {
+  if (takeMutex(dataMutex, MUTEX_DATA)) {
     rc = rotationCount;
     active = sessionActive;
     angle = currentAngle;
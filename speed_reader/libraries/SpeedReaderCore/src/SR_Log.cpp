@@ -0,0 +1,104 @@
+#include "SR_Log.h"
+#include <stdarg.h>
+#include "SR_SerialTelemetry.h"
+
+// Bounded multi-producer queue with a sequence number per slot (Vyukov):
+// a producer claims a slot by advancing enqueuePos with a CAS, fills it
+// and publishes it by storing its sequence; the drain task is the only
+// consumer. Sequences are stored minus the slot index so the zeroed
+// ring is already initialised and logging works before startLog().
+static_assert((logRingSlots & (logRingSlots - 1)) == 0, "logRingSlots must be a power of two");
+
+struct LogSlot {
+  uint32_t seq;
+  uint32_t ms;
+  const char* tag;
+  LogLevel level;
+  char text[logLineMax];
+};
+
+static LogSlot ring[logRingSlots];
+static uint32_t enqueuePos = 0;
+static uint32_t dequeuePos = 0;     // drain task only
+static uint32_t dropped = 0;
+
+static TaskHandle_t logTaskHandle = NULL;
+
+static uint32_t slotSeq(uint32_t idx) {
+  return __atomic_load_n(&ring[idx].seq, __ATOMIC_ACQUIRE) + idx;
+}
+
+static void setSlotSeq(uint32_t idx, uint32_t seq) {
+  __atomic_store_n(&ring[idx].seq, seq - idx, __ATOMIC_RELEASE);
+}
+
+void logWrite(LogLevel level, const char* tag, const char* fmt, ...) {
+  uint32_t pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+  uint32_t idx;
+  while (true) {
+    idx = pos & (logRingSlots - 1);
+    int32_t diff = (int32_t)(slotSeq(idx) - pos);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&enqueuePos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+      // pos was reloaded by the failed CAS
+    } else if (diff < 0) {
+      // Full: the drain task has not freed this slot yet
+      __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+      return;
+    } else {
+      pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+    }
+  }
+
+  LogSlot& slot = ring[idx];
+  slot.ms = millis();
+  slot.tag = tag;
+  slot.level = level;
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(slot.text, sizeof(slot.text), fmt, args);
+  va_end(args);
+  setSlotSeq(idx, pos + 1);
+}
+
+uint32_t logDropped() {
+  return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
+
+// ===== Drain =====
+static bool drainOne() {
+  uint32_t idx = dequeuePos & (logRingSlots - 1);
+  if (slotSeq(idx) != dequeuePos + 1) return false;
+
+  const LogSlot& slot = ring[idx];
+  // Text, or a log frame in binary serial mode
+  serialConsoleLog(slot.ms, slot.level, slot.tag, slot.text);
+  setSlotSeq(idx, dequeuePos + logRingSlots);
+  dequeuePos++;
+  return true;
+}
+
+static void logTask(void* parameter) {
+  uint32_t reportedDropped = 0;
+  while (true) {
+    while (drainOne()) {}
+
+    uint32_t now = logDropped();
+    if (now != reportedDropped) {
+      char text[48];
+      snprintf(text, sizeof(text), "%lu messages dropped, ring full",
+               (unsigned long)(now - reportedDropped));
+      serialConsoleLog(millis(), LOG_LEVEL_WARN, "log", text);
+      reportedDropped = now;
+    }
+    vTaskDelay(pdMS_TO_TICKS(logDrainIdleMs));
+  }
+}
+
+void startLog() {
+  if (logTaskHandle) return;
+  xTaskCreatePinnedToCore(logTask, "LogDrain", 3072, NULL, 1, &logTaskHandle, 1);
+}
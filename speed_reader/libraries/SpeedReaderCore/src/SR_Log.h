@@ -0,0 +1,46 @@
+#ifndef SR_LOG_H
+#define SR_LOG_H
+
+#include <Arduino.h>
+#include "globals.h"
+
+// ===== Asynchronous log =====
+// Producers format into a slot of a lock-free ring and return; a
+// low-priority task drains the ring to Serial. A task that logs never
+// waits on the UART, and a full ring drops the message (counted and
+// reported) instead of blocking.
+//
+//   LOG_I("Sensor", "rot:%lu speed_mph:%.2f", rc, speed);
+//
+// Messages above LOG_COMPILE_LEVEL (config.h) are compiled out; the rest
+// are filtered at runtime by log_level. The tag names the module. Not for
+// use from ISRs.
+
+enum LogLevel : uint8_t {
+  LOG_LEVEL_OFF,
+  LOG_LEVEL_ERROR,
+  LOG_LEVEL_WARN,
+  LOG_LEVEL_INFO,
+  LOG_LEVEL_DEBUG
+};
+
+#define SR_LOG(level, tag, ...)                                               \
+  do {                                                                        \
+    if ((level) <= LOG_COMPILE_LEVEL && (level) <= logLevel) logWrite(level, tag, __VA_ARGS__); \
+  } while (0)
+
+#define LOG_E(tag, ...) SR_LOG(LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define LOG_W(tag, ...) SR_LOG(LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define LOG_I(tag, ...) SR_LOG(LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define LOG_D(tag, ...) SR_LOG(LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+
+// tag must outlive the message (a string literal)
+void logWrite(LogLevel level, const char* tag, const char* fmt, ...)
+  __attribute__((format(printf, 3, 4)));
+
+// Starts the drain task. Messages logged before are kept in the ring.
+void startLog();
+
+uint32_t logDropped();
+
+#endif // SR_LOG_H
@@ -0,0 +1,250 @@
+#include "SR_Metrics.h"
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include "globals.h"
+#include "SR_Log.h"
+
+#if ENABLE_HTTP
+#include "SR_TLSServer.h"
+#endif
+
+// ===== Tables =====
+// Endpoints are matched by path prefix; anything else counts as "other"
+static const char* const ENDPOINTS[] = {
+  "/", "/readings", "/events", "/time", "/metrics", "/sessions", "/sessions/*",
+  "/start", "/config", "/ws", "/profile", "other"
+};
+static const size_t ENDPOINT_COUNT = sizeof(ENDPOINTS) / sizeof(ENDPOINTS[0]);
+static const size_t ENDPOINT_SESSION_FILE = 6;
+static const size_t ENDPOINT_OTHER = ENDPOINT_COUNT - 1;
+
+// Upper bounds in microseconds; the last bucket is +Inf
+static const uint32_t LATENCY_BUCKETS_US[] = {
+  1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000
+};
+static const size_t BUCKET_COUNT = sizeof(LATENCY_BUCKETS_US) / sizeof(LATENCY_BUCKETS_US[0]);
+
+static const char* const MUTEX_NAMES[MUTEX_COUNT] = { "data", "lcd", "session_log", "config", "console" };
+
+struct EndpointStats {
+  uint32_t byClass[5];              // 1xx..5xx
+  uint32_t buckets[BUCKET_COUNT + 1];
+  uint64_t sumUs;
+};
+
+struct MutexStats {
+  uint32_t takes;
+  uint32_t contended;               // had to wait, or a try-take failed
+  uint64_t waitUs;
+  uint32_t maxWaitUs;
+};
+
+static EndpointStats endpoints[ENDPOINT_COUNT];
+static MutexStats mutexes[MUTEX_COUNT];
+static uint64_t overheadUs = 0;
+static uint32_t lastScrapeUs = 0;
+static portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== Recording =====
+bool takeMutex(SemaphoreHandle_t mutex, MutexId id, TickType_t wait) {
+  if (xSemaphoreTake(mutex, 0) == pdTRUE) {
+    portENTER_CRITICAL(&metricsMux);
+    mutexes[id].takes++;
+    portEXIT_CRITICAL(&metricsMux);
+    return true;
+  }
+
+  int64_t start = esp_timer_get_time();
+  bool taken = wait > 0 && xSemaphoreTake(mutex, wait) == pdTRUE;
+  uint32_t waited = (uint32_t)(esp_timer_get_time() - start);
+
+  portENTER_CRITICAL(&metricsMux);
+  MutexStats& m = mutexes[id];
+  if (taken) m.takes++;
+  m.contended++;
+  m.waitUs += waited;
+  if (waited > m.maxWaitUs) m.maxWaitUs = waited;
+  portEXIT_CRITICAL(&metricsMux);
+  return taken;
+}
+
+static size_t endpointIndex(const char* path) {
+  size_t len = strcspn(path, "?");
+  if (len > 10 && strncmp(path, "/sessions/", 10) == 0) return ENDPOINT_SESSION_FILE;
+  for (size_t i = 0; i < ENDPOINT_OTHER; i++) {
+    if (strlen(ENDPOINTS[i]) == len && strncmp(ENDPOINTS[i], path, len) == 0) return i;
+  }
+  return ENDPOINT_OTHER;
+}
+
+void recordHttpRequest(const char* path, uint16_t status, uint32_t micros) {
+  int64_t start = esp_timer_get_time();
+  size_t e = endpointIndex(path);
+  size_t bucket = 0;
+  while (bucket < BUCKET_COUNT && micros > LATENCY_BUCKETS_US[bucket]) bucket++;
+  size_t cls = (status >= 100 && status < 600) ? status / 100 - 1 : 4;
+
+  portENTER_CRITICAL(&metricsMux);
+  EndpointStats& s = endpoints[e];
+  s.byClass[cls]++;
+  s.buckets[bucket]++;
+  s.sumUs += micros;
+  overheadUs += (uint64_t)(esp_timer_get_time() - start);
+  portEXIT_CRITICAL(&metricsMux);
+}
+
+// ===== Exposition =====
+static void header(Print& out, const char* name, const char* type, const char* help) {
+  out.printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void gauge(Print& out, const char* name, const char* help, double value) {
+  header(out, name, "gauge", help);
+  out.printf("%s %.6g\n", name, value);
+}
+
+static void counter(Print& out, const char* name, const char* help, double value) {
+  header(out, name, "counter", help);
+  out.printf("%s %.10g\n", name, value);
+}
+
+static void writeTasks(Print& out) {
+  header(out, "sr_task_stack_free_min_bytes", "gauge",
+         "Least free stack each task has had (high-water mark)");
+#if configUSE_TRACE_FACILITY
+  UBaseType_t count = uxTaskGetNumberOfTasks() + 2;   // room for tasks created meanwhile
+  TaskStatus_t* tasks = (TaskStatus_t*)malloc(count * sizeof(TaskStatus_t));
+  if (!tasks) return;
+  count = uxTaskGetSystemState(tasks, count, NULL);
+  for (UBaseType_t i = 0; i < count; i++) {
+    out.printf("sr_task_stack_free_min_bytes{task=\"%s\"} %u\n", tasks[i].pcTaskName,
+               (unsigned)tasks[i].usStackHighWaterMark);
+  }
+  free(tasks);
+#else
+  // Without the trace facility only our own tasks can be looked up
+  static const char* const TASKS[] = {
+    "SensorTask", "DisplayTask", "HTTPSServer", "HTTPServer", "LANServer", "EventStream",
+    "WiFiManager", "Worker", "SessionLog", "ConfigSaver", "Uploader", "EventHook",
+    "UdpTelemetry", "BleTelemetry", "Profiler"
+  };
+  for (size_t i = 0; i < sizeof(TASKS) / sizeof(TASKS[0]); i++) {
+    TaskHandle_t task = xTaskGetHandle(TASKS[i]);
+    if (!task) continue;
+    out.printf("sr_task_stack_free_min_bytes{task=\"%s\"} %u\n", TASKS[i],
+               (unsigned)uxTaskGetStackHighWaterMark(task));
+  }
+#endif
+}
+
+static void writeHttp(Print& out) {
+  // Too big for the LAN server's stack
+  EndpointStats* snap = (EndpointStats*)malloc(sizeof(endpoints));
+  if (!snap) return;
+  portENTER_CRITICAL(&metricsMux);
+  memcpy(snap, endpoints, sizeof(endpoints));
+  portEXIT_CRITICAL(&metricsMux);
+
+  header(out, "sr_http_requests_total", "counter", "Requests by endpoint and status class");
+  for (size_t e = 0; e < ENDPOINT_COUNT; e++) {
+    for (int c = 0; c < 5; c++) {
+      if (snap[e].byClass[c] == 0) continue;
+      out.printf("sr_http_requests_total{endpoint=\"%s\",code=\"%dxx\"} %lu\n", ENDPOINTS[e],
+                 c + 1, (unsigned long)snap[e].byClass[c]);
+    }
+  }
+
+  header(out, "sr_http_request_duration_seconds", "histogram",
+         "Time in the handler chain, response writes included");
+  for (size_t e = 0; e < ENDPOINT_COUNT; e++) {
+    uint32_t total = 0;
+    for (size_t b = 0; b <= BUCKET_COUNT; b++) total += snap[e].buckets[b];
+    if (total == 0) continue;
+
+    uint32_t cumulative = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+      cumulative += snap[e].buckets[b];
+      out.printf("sr_http_request_duration_seconds_bucket{endpoint=\"%s\",le=\"%g\"} %lu\n",
+                 ENDPOINTS[e], LATENCY_BUCKETS_US[b] / 1e6, (unsigned long)cumulative);
+    }
+    out.printf("sr_http_request_duration_seconds_bucket{endpoint=\"%s\",le=\"+Inf\"} %lu\n",
+               ENDPOINTS[e], (unsigned long)total);
+    out.printf("sr_http_request_duration_seconds_sum{endpoint=\"%s\"} %.6f\n", ENDPOINTS[e],
+               snap[e].sumUs / 1e6);
+    out.printf("sr_http_request_duration_seconds_count{endpoint=\"%s\"} %lu\n", ENDPOINTS[e],
+               (unsigned long)total);
+  }
+  free(snap);
+}
+
+static void writeMutexes(Print& out) {
+  MutexStats snap[MUTEX_COUNT];
+  portENTER_CRITICAL(&metricsMux);
+  memcpy(snap, mutexes, sizeof(snap));
+  portEXIT_CRITICAL(&metricsMux);
+
+  header(out, "sr_mutex_takes_total", "counter", "Successful mutex takes");
+  for (int i = 0; i < MUTEX_COUNT; i++) {
+    out.printf("sr_mutex_takes_total{mutex=\"%s\"} %lu\n", MUTEX_NAMES[i], (unsigned long)snap[i].takes);
+  }
+  header(out, "sr_mutex_contended_total", "counter", "Takes that had to wait, or try-takes that failed");
+  for (int i = 0; i < MUTEX_COUNT; i++) {
+    out.printf("sr_mutex_contended_total{mutex=\"%s\"} %lu\n", MUTEX_NAMES[i], (unsigned long)snap[i].contended);
+  }
+  header(out, "sr_mutex_wait_seconds_total", "counter", "Time spent waiting for the mutex");
+  for (int i = 0; i < MUTEX_COUNT; i++) {
+    out.printf("sr_mutex_wait_seconds_total{mutex=\"%s\"} %.6f\n", MUTEX_NAMES[i], snap[i].waitUs / 1e6);
+  }
+  header(out, "sr_mutex_wait_max_seconds", "gauge", "Longest single wait since boot");
+  for (int i = 0; i < MUTEX_COUNT; i++) {
+    out.printf("sr_mutex_wait_max_seconds{mutex=\"%s\"} %.6f\n", MUTEX_NAMES[i], snap[i].maxWaitUs / 1e6);
+  }
+}
+
+#if ENABLE_HTTP
+static void writeTls(Print& out) {
+  TLSStats tls;
+  if (!getTLSStats(tls)) return;
+  counter(out, "sr_tls_handshakes_total", "Completed TLS handshakes", tls.handshakes);
+  counter(out, "sr_tls_handshake_failures_total", "Failed TLS handshakes", tls.failures);
+  counter(out, "sr_tls_resumed_total", "Handshakes resumed from the session cache", tls.resumed);
+  counter(out, "sr_tls_handshake_seconds_total", "Time spent in handshakes", tls.totalMs / 1e3);
+  gauge(out, "sr_tls_handshake_max_seconds", "Longest handshake since boot", tls.maxMs / 1e3);
+  counter(out, "sr_tls_deferred_total", "Clients that waited for heap before their handshake", tls.deferred);
+  counter(out, "sr_tls_rejected_total", "Clients dropped after waiting for heap", tls.rejected);
+  counter(out, "sr_tls_evicted_total", "Idle keep-alive connections closed for a new client", tls.evicted);
+  gauge(out, "sr_tls_open_connections", "Open HTTPS connections", tls.openConnections);
+  gauge(out, "sr_tls_max_connections", "HTTPS connection slots", tls.maxConnections);
+  gauge(out, "sr_tls_heap_per_connection_bytes", "Heap held by the last connection after its handshake",
+        tls.heapPerConnection);
+  gauge(out, "sr_tls_handshake_heap_peak_bytes", "Largest heap drop during a handshake", tls.heapPeak);
+}
+#endif
+
+void writeMetrics(Print& out) {
+  int64_t start = esp_timer_get_time();
+
+  gauge(out, "sr_uptime_seconds", "Time since boot", esp_timer_get_time() / 1e6);
+  gauge(out, "sr_heap_free_bytes", "Free heap", ESP.getFreeHeap());
+  gauge(out, "sr_heap_min_free_bytes", "Lowest free heap since boot", ESP.getMinFreeHeap());
+  gauge(out, "sr_heap_largest_free_block_bytes", "Largest allocatable block", ESP.getMaxAllocHeap());
+  writeTasks(out);
+  writeHttp(out);
+  writeMutexes(out);
+  counter(out, "sr_log_dropped_total", "Log messages dropped because the log ring was full", logDropped());
+#if ENABLE_HTTP
+  writeTls(out);
+#endif
+
+  portENTER_CRITICAL(&metricsMux);
+  uint64_t overhead = overheadUs;
+  uint32_t scrape = lastScrapeUs;
+  portEXIT_CRITICAL(&metricsMux);
+  counter(out, "sr_metrics_overhead_seconds_total", "Time spent recording request metrics", overhead / 1e6);
+  gauge(out, "sr_metrics_scrape_duration_seconds", "Time the previous /metrics took to render", scrape / 1e6);
+
+  uint32_t took = (uint32_t)(esp_timer_get_time() - start);
+  portENTER_CRITICAL(&metricsMux);
+  lastScrapeUs = took;
+  portEXIT_CRITICAL(&metricsMux);
+}
@@ -0,0 +1,37 @@
+#ifndef SR_METRICS_H
+#define SR_METRICS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// ===== Metrics =====
+// Counters behind GET /metrics (Prometheus text format): heap, task stack
+// high-water marks, per-endpoint request counts and latency histograms,
+// mutex contention and TLS handshakes.
+//
+// Recording is a few counter updates under a spinlock. The time spent in
+// it is itself measured and exported (sr_metrics_overhead_seconds_total),
+// next to the time each scrape takes to render.
+
+enum MutexId : uint8_t {
+  MUTEX_DATA,
+  MUTEX_LCD,
+  MUTEX_SESSION_LOG,
+  MUTEX_CONFIG,
+  MUTEX_CONSOLE,
+  MUTEX_COUNT
+};
+
+// xSemaphoreTake that records contention: an uncontended take costs one
+// extra try and a counter update; a contended one is timed.
+bool takeMutex(SemaphoreHandle_t mutex, MutexId id, TickType_t wait = portMAX_DELAY);
+
+// One finished HTTP request: path as requested (query is ignored), final
+// status code and time spent in the handler chain
+void recordHttpRequest(const char* path, uint16_t status, uint32_t micros);
+
+// Writes every metric in the Prometheus text exposition format
+void writeMetrics(Print& out);
+
+#endif // SR_METRICS_H
@@ -0,0 +1,182 @@
+#include "SR_Profiler.h"
+
+#if ENABLE_PROFILER
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "SR_Log.h"
+
+// Bucket 0 is < 1 us; bucket i >= 1 covers [2^(i-1), 2^i) us
+static const int PROFILE_BUCKETS = 20;
+static const int PROFILE_MAX_TASKS = 32;
+
+static const char* const SITE_NAMES[PROF_SITE_COUNT] = {
+  "onRotation", "updateAngle", "showSpeed", "publishReading",
+  "sensorLoop", "sensorPeriod", "httpRequest"
+};
+
+struct SiteStats {
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t sumCycles;
+  uint32_t buckets[PROFILE_BUCKETS];
+};
+
+static SiteStats sites[PROF_SITE_COUNT];
+static uint32_t cyclesPerUs = 240;
+static portMUX_TYPE profileMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Run-time counters at the previous dump, for CPU use over the interval
+static uint32_t prevTaskNumber[PROFILE_MAX_TASKS];
+static uint32_t prevTaskRunTime[PROFILE_MAX_TASKS];
+static int prevTaskCount = 0;
+static uint32_t prevTotalRunTime = 0;
+
+static TaskHandle_t profilerTaskHandle = NULL;
+
+// ===== Recording =====
+void IRAM_ATTR profileRecord(ProfileSite site, uint32_t cycles) {
+  uint32_t us = cycles / cyclesPerUs;
+  int bucket = us ? 32 - __builtin_clz(us) : 0;
+  if (bucket >= PROFILE_BUCKETS) bucket = PROFILE_BUCKETS - 1;
+
+  portENTER_CRITICAL_SAFE(&profileMux);
+  SiteStats& s = sites[site];
+  if (s.count == 0 || cycles < s.minCycles) s.minCycles = cycles;
+  if (cycles > s.maxCycles) s.maxCycles = cycles;
+  s.count++;
+  s.sumCycles += cycles;
+  s.buckets[bucket]++;
+  portEXIT_CRITICAL_SAFE(&profileMux);
+}
+
+// ===== Dump =====
+static void writeSites(Print& out, bool reset) {
+  SiteStats snap[PROF_SITE_COUNT];
+  portENTER_CRITICAL(&profileMux);
+  memcpy(snap, sites, sizeof(snap));
+  if (reset) memset(sites, 0, sizeof(sites));
+  portEXIT_CRITICAL(&profileMux);
+
+  out.printf("%-15s %9s %10s %10s %10s  histogram (us: count)\n",
+             "site", "count", "min_us", "avg_us", "max_us");
+  float perUs = (float)cyclesPerUs;
+  for (int i = 0; i < PROF_SITE_COUNT; i++) {
+    const SiteStats& s = snap[i];
+    if (s.count == 0) {
+      out.printf("%-15s %9u\n", SITE_NAMES[i], 0u);
+      continue;
+    }
+    out.printf("%-15s %9lu %10.2f %10.2f %10.2f ", SITE_NAMES[i], (unsigned long)s.count,
+               s.minCycles / perUs, (float)(s.sumCycles / s.count) / perUs, s.maxCycles / perUs);
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+      if (s.buckets[b] == 0) continue;
+      if (b == 0) out.printf(" <1:%lu", (unsigned long)s.buckets[b]);
+      else out.printf(" %lu:%lu", 1UL << (b - 1), (unsigned long)s.buckets[b]);
+    }
+    out.println();
+  }
+}
+
+static void writeTasks(Print& out) {
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+  UBaseType_t count = uxTaskGetNumberOfTasks() + 2;
+  if (count > PROFILE_MAX_TASKS) count = PROFILE_MAX_TASKS;
+  TaskStatus_t* tasks = (TaskStatus_t*)malloc(count * sizeof(TaskStatus_t));
+  if (!tasks) return;
+  uint32_t total = 0;
+  count = uxTaskGetSystemState(tasks, count, &total);
+
+  uint32_t prevNumber[PROFILE_MAX_TASKS];
+  uint32_t prevRunTime[PROFILE_MAX_TASKS];
+  portENTER_CRITICAL(&profileMux);
+  int prevCount = prevTaskCount;
+  uint32_t prevTotal = prevTotalRunTime;
+  memcpy(prevNumber, prevTaskNumber, sizeof(prevNumber));
+  memcpy(prevRunTime, prevTaskRunTime, sizeof(prevRunTime));
+  for (UBaseType_t i = 0; i < count; i++) {
+    prevTaskNumber[i] = tasks[i].xTaskNumber;
+    prevTaskRunTime[i] = tasks[i].ulRunTimeCounter;
+  }
+  prevTaskCount = count;
+  prevTotalRunTime = total;
+  portEXIT_CRITICAL(&profileMux);
+
+  // The run-time counter is per core, so 100% is one core fully busy
+  uint32_t interval = total - prevTotal;
+  out.printf("\n%-16s %4s %8s  (%s, %.1f s)\n", "task", "core", "cpu_%",
+             prevCount ? "since last dump" : "since boot", interval / 1e6f);
+  for (UBaseType_t i = 0; i < count; i++) {
+    uint32_t runTime = tasks[i].ulRunTimeCounter;
+    for (int j = 0; j < prevCount; j++) {
+      if (prevNumber[j] == tasks[i].xTaskNumber) {
+        runTime -= prevRunTime[j];
+        break;
+      }
+    }
+    int core = tasks[i].xCoreID > 1 ? -1 : (int)tasks[i].xCoreID;   // -1: not pinned
+    out.printf("%-16s %4d %8.2f\n", tasks[i].pcTaskName, core,
+               interval ? runTime * 100.0f / interval : 0.0f);
+  }
+  free(tasks);
+#else
+  out.println("\n(per-task CPU needs configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS)");
+#endif
+}
+
+void writeProfile(Print& out, bool reset) {
+  out.printf("uptime %.1f s, cpu %lu MHz\n", millis() / 1000.0f, (unsigned long)cyclesPerUs);
+  writeSites(out, reset);
+  writeTasks(out);
+}
+
+// Hands the dump to the log a line at a time, so it reaches Serial through
+// the drain task (framed in binary serial mode) like any other message.
+// Lines longer than a log slot continue on the next message.
+class ProfileLogPrint : public Print {
+ public:
+  size_t write(uint8_t c) override {
+    if (c == '\n' || len == sizeof(line) - 1) flushLine();
+    if (c != '\n') line[len++] = (char)c;
+    return 1;
+  }
+
+  void flushLine() {
+    if (len == 0) return;
+    line[len] = '\0';
+    LOG_I("Profile", "%s", line);
+    len = 0;
+    // The ring is smaller than a full dump; let the drain task keep up
+    vTaskDelay(1);
+  }
+
+ private:
+  char line[logLineMax];
+  size_t len = 0;
+};
+
+static void profilerTask(void* parameter) {
+  ProfileLogPrint out;
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(profileDumpMs));
+    writeProfile(out, false);
+    out.flushLine();
+  }
+}
+
+void startProfiler() {
+  if (profilerTaskHandle) return;
+  cyclesPerUs = ESP.getCpuFreqMHz();
+  xTaskCreatePinnedToCore(profilerTask, "Profiler", 4096, NULL, 1, &profilerTaskHandle, 0);
+  LOG_I("Profile", "dump every %lu ms, GET /profile", profileDumpMs);
+}
+
+#else
+
+void startProfiler() {}
+
+void writeProfile(Print& out, bool reset) {
+  out.println("Profiler not built; set ENABLE_PROFILER to 1");
+}
+
+#endif // ENABLE_PROFILER
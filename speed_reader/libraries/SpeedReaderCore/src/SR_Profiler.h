@@ -0,0 +1,55 @@
+#ifndef SR_PROFILER_H
+#define SR_PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ===== Cycle-counter profiler (ENABLE_PROFILER) =====
+// Times instrumented sites with the CPU cycle counter and keeps, per site,
+// count, min, max, sum and a log2 histogram of microseconds. Per-task CPU
+// time comes from the FreeRTOS run-time stats. Both are logged every
+// profileDumpMs and served at GET /profile.
+//
+// The cycle counter is per core: a site must start and end on the same
+// core, which holds for ISRs and for our tasks, all pinned. With the flag
+// off every PROFILE_SCOPE compiles to nothing.
+
+enum ProfileSite : uint8_t {
+  PROF_ON_ROTATION,     // rotation ISR
+  PROF_UPDATE_ANGLE,    // accelerometer read + filter
+  PROF_SHOW_SPEED,      // LCD stats screen
+  PROF_PUBLISH,         // snapshot + render of one reading
+  PROF_SENSOR_LOOP,     // sensorTask work per pass, delay excluded
+  PROF_SENSOR_PERIOD,   // sensorTask start-to-start; the spread is jitter
+  PROF_HTTP_REQUEST,    // handler chain of one request
+  PROF_SITE_COUNT
+};
+
+#if ENABLE_PROFILER
+
+// Safe from ISRs and any task
+void IRAM_ATTR profileRecord(ProfileSite site, uint32_t cycles);
+
+struct ProfileScope {
+  ProfileSite site;
+  uint32_t start;
+  explicit ProfileScope(ProfileSite s) : site(s), start(ESP.getCycleCount()) {}
+  ~ProfileScope() { profileRecord(site, ESP.getCycleCount() - start); }
+};
+
+#define PROFILE_SCOPE(site) ProfileScope profileScope_(site)
+
+#else
+
+#define PROFILE_SCOPE(site) do {} while (0)
+
+#endif // ENABLE_PROFILER
+
+// Starts the periodic dump to the log; does nothing without ENABLE_PROFILER
+void startProfiler();
+
+// Writes the site table and per-task CPU use since the previous dump.
+// reset clears the site accumulators afterwards.
+void writeProfile(Print& out, bool reset);
+
+#endif // SR_PROFILER_H
@@ -0,0 +1,24 @@
+#ifndef SR_READING_H
+#define SR_READING_H
+
+#include <stdint.h>
+
+// Snapshot of everything /readings reports. Kept free of Arduino types so
+// the same struct can be shared with host-side tools.
+struct Reading {
+  uint32_t seq;           // 0 for an unpublished snapshot
+  uint32_t t_ms;
+  uint64_t utc_ms;        // Unix time in ms; 0 until the clock has been synced
+  uint32_t rotations;
+  float distance_miles;
+  float speed_mph;
+  float max_speed;
+  float angle;
+  float max_angle;
+  float min_angle;
+  float vibration;
+  float max_vibration;
+  char job[32];
+};
+
+#endif // SR_READING_H
@@ -0,0 +1,342 @@
+#include "SR_ReadingCodec.h"
+#include "SR_JsonWriter.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// ===== JSON =====
+void writeReadingFields(JsonWriter& w, const Reading& r) {
+  w.field("rotations", (unsigned long)r.rotations);
+  w.field("distance_miles", r.distance_miles, 4);
+  w.field("speed_mph", r.speed_mph, 2);
+  w.field("max_speed", r.max_speed, 2);
+  w.field("angle", r.angle, 1);
+  w.field("max_angle", r.max_angle, 1);
+  w.field("min_angle", r.min_angle, 1);
+  w.field("vibration", r.vibration, 3);
+  w.field("max_vibration", r.max_vibration, 3);
+  w.field("job", r.job);
+  w.field("utc_ms", (unsigned long long)r.utc_ms);
+}
+
+size_t formatReadingJson(const Reading& r, char* out, size_t cap) {
+  JsonWriter w(out, cap);
+  w.beginObject();
+  writeReadingFields(w, r);
+  w.endObject();
+  return w.overflow() ? 0 : w.length();
+}
+
+// ===== Packed struct =====
+size_t encodeReadingPacket(const Reading& r, uint8_t* out, size_t cap) {
+  if (cap < sizeof(ReadingPacket)) return 0;
+
+  ReadingPacket p;
+  memset(&p, 0, sizeof(p));
+  p.version = READING_PACKET_VERSION;
+  p.size = sizeof(ReadingPacket);
+  p.seq = r.seq;
+  p.t_ms = r.t_ms;
+  p.rotations = r.rotations;
+  p.distance_miles = r.distance_miles;
+  p.speed_mph = r.speed_mph;
+  p.max_speed = r.max_speed;
+  p.angle = r.angle;
+  p.max_angle = r.max_angle;
+  p.min_angle = r.min_angle;
+  p.vibration = r.vibration;
+  p.max_vibration = r.max_vibration;
+  memcpy(p.job, r.job, sizeof(p.job));
+  p.job[sizeof(p.job) - 1] = '\0';
+  p.utc_ms = r.utc_ms;
+
+  memcpy(out, &p, sizeof(p));
+  return sizeof(p);
+}
+
+size_t decodeReadingPacket(const uint8_t* in, size_t len, Reading& r) {
+  ReadingPacket p;
+  if (len < 4) return 0;
+  uint16_t size = (uint16_t)(in[2] | (in[3] << 8));
+  if (in[0] < 1 || size < READING_PACKET_BASE_SIZE || len < size) return 0;
+
+  // Older writers send a shorter struct; the missing tail reads as zero
+  memset(&p, 0, sizeof(p));
+  memcpy(&p, in, size < sizeof(p) ? size : sizeof(p));
+  r.seq = p.seq;
+  r.t_ms = p.t_ms;
+  r.rotations = p.rotations;
+  r.distance_miles = p.distance_miles;
+  r.speed_mph = p.speed_mph;
+  r.max_speed = p.max_speed;
+  r.angle = p.angle;
+  r.max_angle = p.max_angle;
+  r.min_angle = p.min_angle;
+  r.vibration = p.vibration;
+  r.max_vibration = p.max_vibration;
+  memcpy(r.job, p.job, sizeof(r.job));
+  r.job[sizeof(r.job) - 1] = '\0';
+  r.utc_ms = p.utc_ms;
+  return size;
+}
+
+// ===== Compact fixed-point =====
+static int16_t toFixed16(float v, float scale) {
+  float s = roundf(v * scale);
+  if (!(s > -32768.0f)) return -32768;   // also NaN
+  if (s > 32767.0f) return 32767;
+  return (int16_t)s;
+}
+
+static uint32_t toFixedU32(float v, float scale, uint32_t max) {
+  float s = roundf(v * scale);
+  if (!(s > 0.0f)) return 0;
+  if (s >= (float)max) return max;
+  return (uint32_t)s;
+}
+
+size_t encodeReadingCompact(const Reading& r, uint8_t* out, size_t cap) {
+  if (cap < sizeof(CompactReading)) return 0;
+
+  CompactReading c;
+  c.version = READING_COMPACT_VERSION;
+  c.flags = r.job[0] ? COMPACT_SESSION_ACTIVE : 0;
+  c.seq = (uint16_t)r.seq;
+  c.rotations = r.rotations;
+  c.distance = toFixedU32(r.distance_miles, 10000.0f, 0xFFFFFFFFu);
+  c.speed = toFixed16(r.speed_mph, 100.0f);
+  c.maxSpeed = toFixed16(r.max_speed, 100.0f);
+  c.angle = toFixed16(r.angle, 100.0f);
+  c.vibration = (uint16_t)toFixedU32(r.vibration, 1000.0f, 0xFFFF);
+
+  memcpy(out, &c, sizeof(c));
+  return sizeof(c);
+}
+
+size_t decodeReadingCompact(const uint8_t* in, size_t len, Reading& r) {
+  CompactReading c;
+  if (len < sizeof(c) || in[0] < 1) return 0;
+  memcpy(&c, in, sizeof(c));
+
+  memset(&r, 0, sizeof(r));
+  r.seq = c.seq;
+  r.rotations = c.rotations;
+  r.distance_miles = c.distance / 10000.0f;
+  r.speed_mph = c.speed / 100.0f;
+  r.max_speed = c.maxSpeed / 100.0f;
+  r.angle = c.angle / 100.0f;
+  r.vibration = c.vibration / 1000.0f;
+  return sizeof(c);
+}
+
+// ===== CBOR (RFC 8949) =====
+// A definite-length map with the same keys as the JSON object plus seq
+// and t_ms. Integers are unsigned, floats are float32.
+
+enum ReadingKeyKind : uint8_t { KEY_U32, KEY_U64, KEY_FLOAT };
+
+struct ReadingKey {
+  const char* name;
+  size_t offset;
+  ReadingKeyKind kind;
+};
+
+static const ReadingKey READING_KEYS[] = {
+  { "seq",            offsetof(Reading, seq),            KEY_U32 },
+  { "t_ms",           offsetof(Reading, t_ms),           KEY_U32 },
+  { "rotations",      offsetof(Reading, rotations),      KEY_U32 },
+  { "distance_miles", offsetof(Reading, distance_miles), KEY_FLOAT },
+  { "speed_mph",      offsetof(Reading, speed_mph),      KEY_FLOAT },
+  { "max_speed",      offsetof(Reading, max_speed),      KEY_FLOAT },
+  { "angle",          offsetof(Reading, angle),          KEY_FLOAT },
+  { "max_angle",      offsetof(Reading, max_angle),      KEY_FLOAT },
+  { "min_angle",      offsetof(Reading, min_angle),      KEY_FLOAT },
+  { "vibration",      offsetof(Reading, vibration),      KEY_FLOAT },
+  { "max_vibration",  offsetof(Reading, max_vibration),  KEY_FLOAT },
+  { "utc_ms",         offsetof(Reading, utc_ms),         KEY_U64 },
+};
+static const size_t READING_KEY_COUNT = sizeof(READING_KEYS) / sizeof(READING_KEYS[0]);
+
+enum CborMajor : uint8_t {
+  CBOR_UINT = 0,
+  CBOR_NEGINT = 1,
+  CBOR_TEXT = 3,
+  CBOR_MAP = 5,
+  CBOR_SIMPLE = 7
+};
+
+struct CborWriter {
+  uint8_t* out;
+  size_t cap;
+  size_t len;
+
+  bool put(const void* data, size_t n) {
+    if (len + n > cap) return false;
+    memcpy(out + len, data, n);
+    len += n;
+    return true;
+  }
+
+  bool head(uint8_t major, uint64_t v) {
+    uint8_t buf[9];
+    size_t n;
+    if (v < 24) {
+      buf[0] = (uint8_t)((major << 5) | v);
+      n = 1;
+    } else if (v <= 0xFF) {
+      buf[0] = (uint8_t)((major << 5) | 24);
+      buf[1] = (uint8_t)v;
+      n = 2;
+    } else if (v <= 0xFFFF) {
+      buf[0] = (uint8_t)((major << 5) | 25);
+      buf[1] = (uint8_t)(v >> 8);
+      buf[2] = (uint8_t)v;
+      n = 3;
+    } else if (v <= 0xFFFFFFFF) {
+      buf[0] = (uint8_t)((major << 5) | 26);
+      buf[1] = (uint8_t)(v >> 24);
+      buf[2] = (uint8_t)(v >> 16);
+      buf[3] = (uint8_t)(v >> 8);
+      buf[4] = (uint8_t)v;
+      n = 5;
+    } else {
+      buf[0] = (uint8_t)((major << 5) | 27);
+      for (int i = 0; i < 8; i++) buf[1 + i] = (uint8_t)(v >> (56 - 8 * i));
+      n = 9;
+    }
+    return put(buf, n);
+  }
+
+  bool text(const char* s) {
+    size_t n = strlen(s);
+    return head(CBOR_TEXT, (uint32_t)n) && put(s, n);
+  }
+
+  bool f32(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, 4);
+    uint8_t buf[5] = { (uint8_t)((CBOR_SIMPLE << 5) | 26), (uint8_t)(bits >> 24),
+                       (uint8_t)(bits >> 16), (uint8_t)(bits >> 8), (uint8_t)bits };
+    return put(buf, sizeof(buf));
+  }
+};
+
+size_t encodeReadingCbor(const Reading& r, uint8_t* out, size_t cap) {
+  CborWriter w = { out, cap, 0 };
+  bool ok = w.head(CBOR_MAP, READING_KEY_COUNT + 1);
+
+  for (size_t i = 0; i < READING_KEY_COUNT && ok; i++) {
+    const ReadingKey& k = READING_KEYS[i];
+    const uint8_t* field = (const uint8_t*)&r + k.offset;
+    ok = w.text(k.name);
+    if (k.kind == KEY_U32) {
+      uint32_t v;
+      memcpy(&v, field, 4);
+      ok = ok && w.head(CBOR_UINT, v);
+    } else if (k.kind == KEY_U64) {
+      uint64_t v;
+      memcpy(&v, field, 8);
+      ok = ok && w.head(CBOR_UINT, v);
+    } else {
+      float f;
+      memcpy(&f, field, 4);
+      ok = ok && w.f32(f);
+    }
+  }
+  ok = ok && w.text("job") && w.text(r.job);
+  return ok ? w.len : 0;
+}
+
+struct CborReader {
+  const uint8_t* in;
+  size_t len;
+  size_t pos;
+  uint64_t arg;   // full argument of the last head, for float64 and uint64
+
+  // Reads an item head. Only float64 and unsigned integers may use a
+  // 64-bit argument.
+  bool head(uint8_t& major, uint8_t& info, uint32_t& v) {
+    if (pos >= len) return false;
+    major = in[pos] >> 5;
+    info = in[pos] & 0x1F;
+    pos++;
+    size_t n = (info < 24) ? 0 : (info == 24) ? 1 : (info == 25) ? 2 : (info == 26) ? 4 : 8;
+    if (info > 27 || pos + n > len) return false;
+    arg = (n == 0) ? info : 0;
+    for (size_t i = 0; i < n; i++) arg = (arg << 8) | in[pos++];
+    if (n == 8 && major != CBOR_SIMPLE && major != CBOR_UINT) return false;
+    v = (uint32_t)arg;
+    return true;
+  }
+};
+
+static float halfToFloat(uint16_t h) {
+  int exp = (h >> 10) & 0x1F;
+  int mant = h & 0x3FF;
+  float v;
+  if (exp == 0) v = ldexpf((float)mant, -24);
+  else if (exp == 31) v = mant ? NAN : INFINITY;
+  else v = ldexpf((float)(mant + 1024), exp - 25);
+  return (h & 0x8000) ? -v : v;
+}
+
+size_t decodeReadingCbor(const uint8_t* in, size_t len, Reading& r) {
+  CborReader rd = { in, len, 0, 0 };
+  uint8_t major, info;
+  uint32_t count;
+  if (!rd.head(major, info, count) || major != CBOR_MAP) return 0;
+
+  memset(&r, 0, sizeof(r));
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t n;
+    if (!rd.head(major, info, n) || major != CBOR_TEXT || rd.pos + n > len) return 0;
+    const char* key = (const char*)in + rd.pos;
+    size_t keyLen = n;
+    rd.pos += n;
+
+    uint32_t v;
+    if (!rd.head(major, info, v)) return 0;
+
+    if (major == CBOR_TEXT) {
+      if (rd.pos + v > len) return 0;
+      if (keyLen == 3 && memcmp(key, "job", 3) == 0) {
+        size_t c = v < sizeof(r.job) - 1 ? v : sizeof(r.job) - 1;
+        memcpy(r.job, in + rd.pos, c);
+        r.job[c] = '\0';
+      }
+      rd.pos += v;
+      continue;
+    }
+
+    // Numbers: unsigned, negative or float of any width
+    float f;
+    if (major == CBOR_UINT) f = (float)rd.arg;
+    else if (major == CBOR_NEGINT) f = -1.0f - (float)v;
+    else if (major == CBOR_SIMPLE && info == 25) f = halfToFloat((uint16_t)v);
+    else if (major == CBOR_SIMPLE && info == 26) memcpy(&f, &v, 4);
+    else if (major == CBOR_SIMPLE && info == 27) {
+      double d;
+      memcpy(&d, &rd.arg, 8);
+      f = (float)d;
+    }
+    else if (major == CBOR_SIMPLE && info < 24) continue;  // true/false/null
+    else return 0;
+
+    for (size_t k = 0; k < READING_KEY_COUNT; k++) {
+      const ReadingKey& rk = READING_KEYS[k];
+      if (strlen(rk.name) != keyLen || memcmp(rk.name, key, keyLen) != 0) continue;
+      uint8_t* field = (uint8_t*)&r + rk.offset;
+      if (rk.kind == KEY_U32) {
+        uint32_t u = (major == CBOR_UINT) ? v : (uint32_t)f;
+        memcpy(field, &u, 4);
+      } else if (rk.kind == KEY_U64) {
+        uint64_t u = (major == CBOR_UINT) ? rd.arg : (uint64_t)f;
+        memcpy(field, &u, 8);
+      } else {
+        memcpy(field, &f, 4);
+      }
+      break;
+    }
+  }
+  return rd.pos;
+}
@@ -0,0 +1,81 @@
+#ifndef SR_READING_CODEC_H
+#define SR_READING_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SR_Reading.h"
+
+// ===== /readings wire formats =====
+// JSON (default), CBOR (Accept: application/cbor) and a fixed-layout packed
+// struct (Accept: application/octet-stream). The binary forms avoid float
+// formatting on the device and float parsing on the client. A 20-byte
+// fixed-point form serves links with small frames (BLE).
+//
+// No Arduino dependencies, so host tools link the same code.
+
+const uint8_t READING_PACKET_VERSION = 1;
+
+// Packed format, little-endian. `size` is sizeof(ReadingPacket) for the
+// writer's version; fields are only ever appended, so a decoder can read
+// the prefix it knows and skip the rest, and fields missing from an older
+// writer's packet read as zero.
+struct __attribute__((packed)) ReadingPacket {
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t size;
+  uint32_t seq;
+  uint32_t t_ms;
+  uint32_t rotations;
+  float distance_miles;
+  float speed_mph;
+  float max_speed;
+  float angle;
+  float max_angle;
+  float min_angle;
+  float vibration;
+  float max_vibration;
+  char job[32];           // NUL-padded
+  uint64_t utc_ms;        // appended; 0 = clock not synced
+};
+
+// Size of the first version of the struct, before utc_ms
+const size_t READING_PACKET_BASE_SIZE = 80;
+
+const size_t READING_CBOR_MAX_SIZE = 256;
+
+const uint8_t READING_COMPACT_VERSION = 1;
+const uint8_t COMPACT_SESSION_ACTIVE = 0x01;
+
+// Fixed-point, little-endian, sized to one BLE notification at the default
+// ATT MTU. Out-of-range values saturate. Decoding fills in only these
+// fields, and seq only its low 16 bits (enough to count gaps).
+struct __attribute__((packed)) CompactReading {
+  uint8_t version;
+  uint8_t flags;          // COMPACT_SESSION_ACTIVE: a job is running
+  uint16_t seq;           // low 16 bits
+  uint32_t rotations;
+  uint32_t distance;      // 0.0001 miles
+  int16_t speed;          // 0.01 mph
+  int16_t maxSpeed;       // 0.01 mph
+  int16_t angle;          // 0.01 degree
+  uint16_t vibration;     // 0.001
+};
+
+class JsonWriter;
+
+// The /readings JSON members, for embedding in a larger object
+void writeReadingFields(JsonWriter& w, const Reading& r);
+
+// Each returns the number of bytes written, or 0 if `cap` is too small.
+size_t formatReadingJson(const Reading& r, char* out, size_t cap);
+size_t encodeReadingPacket(const Reading& r, uint8_t* out, size_t cap);
+size_t encodeReadingCbor(const Reading& r, uint8_t* out, size_t cap);
+size_t encodeReadingCompact(const Reading& r, uint8_t* out, size_t cap);
+
+// Each returns the number of bytes consumed, or 0 if the input is
+// malformed or truncated.
+size_t decodeReadingPacket(const uint8_t* in, size_t len, Reading& r);
+size_t decodeReadingCbor(const uint8_t* in, size_t len, Reading& r);
+size_t decodeReadingCompact(const uint8_t* in, size_t len, Reading& r);
+
+#endif // SR_READING_CODEC_H
@@ -0,0 +1,153 @@
+#include "SR_Readings.h"
+#include "SR_SpeedSensor.h"
+#include "SR_ReadingCodec.h"
+#include "globals.h"
+#include "SR_Time.h"
+#include "SR_Metrics.h"
+#include "SR_Profiler.h"
+
+// Pre-rendered latest reading. Two copies: the sensor task renders into
+// the back one and then flips `renderedFront`. Readers check `gen` (odd
+// while being written) before and after copying and retry on a change,
+// so they never block the writer or each other.
+struct RenderedReading {
+  volatile uint32_t gen;
+  uint32_t seq;
+  uint16_t len[READING_FORMAT_COUNT];
+  uint8_t data[READING_FORMAT_COUNT][READING_RENDER_MAX];
+};
+
+static RenderedReading rendered[2];
+static volatile uint8_t renderedFront = 0;
+
+static Reading ring[READING_HISTORY];
+static uint32_t lastSeq = 0;
+static TaskHandle_t subscribers[READING_MAX_SUBSCRIBERS];
+static portMUX_TYPE readingsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== Snapshot =====
+bool takeReading(Reading& r) {
+  // getCurrentSpeed() also ends a timed-out session, so call it first
+  r.speed_mph = getCurrentSpeed();
+  r.seq = 0;
+  r.t_ms = millis();
+  r.utc_ms = utcMs();
+
+  if (!takeMutex(dataMutex, MUTEX_DATA)) return false;
+  r.rotations = rotationCount;
+  totalDistance_miles = (float)r.rotations * distancePerRotation_miles;
+  r.distance_miles = totalDistance_miles;
+  r.max_speed = maxSpeed_mph;
+  r.angle = currentAngle;
+  r.max_angle = maxAngle;
+  r.min_angle = minAngle;
+  r.vibration = currentVibration;
+  r.max_vibration = maxVibration;
+  strncpy(r.job, currentJob, sizeof(r.job) - 1);
+  r.job[sizeof(r.job) - 1] = '\0';
+  xSemaphoreGive(dataMutex);
+  return true;
+}
+
+// ===== Rendered cache =====
+static void renderReading(const Reading& r) {
+  uint8_t back = renderedFront ^ 1;
+  RenderedReading& b = rendered[back];
+
+  b.gen++;
+  __sync_synchronize();
+  b.seq = r.seq;
+  b.len[READING_JSON] = formatReadingJson(r, (char*)b.data[READING_JSON], READING_RENDER_MAX);
+  b.len[READING_CBOR] = encodeReadingCbor(r, b.data[READING_CBOR], READING_RENDER_MAX);
+  b.len[READING_PACKED] = encodeReadingPacket(r, b.data[READING_PACKED], READING_RENDER_MAX);
+  __sync_synchronize();
+  b.gen++;
+
+  renderedFront = back;
+}
+
+size_t readRenderedReading(ReadingFormat format, uint8_t* out, size_t cap, uint32_t* seq) {
+  for (int attempt = 0; attempt < 4; attempt++) {
+    const RenderedReading& b = rendered[renderedFront];
+    uint32_t gen = b.gen;
+    __sync_synchronize();
+    if (gen & 1) continue;  // flipped and being rewritten; front has moved on
+
+    size_t len = b.len[format];
+    uint32_t s = b.seq;
+    if (s == 0 || len > cap) return 0;
+    memcpy(out, b.data[format], len);
+    __sync_synchronize();
+
+    if (b.gen == gen) {
+      if (seq) *seq = s;
+      return len;
+    }
+  }
+  return 0;
+}
+
+// ===== Ring =====
+void publishReading() {
+  PROFILE_SCOPE(PROF_PUBLISH);
+  Reading r;
+  if (!takeReading(r)) return;
+
+  TaskHandle_t notify[READING_MAX_SUBSCRIBERS];
+  portENTER_CRITICAL(&readingsMux);
+  r.seq = lastSeq + 1;
+  ring[r.seq % READING_HISTORY] = r;
+  lastSeq = r.seq;
+  memcpy(notify, subscribers, sizeof(notify));
+  portEXIT_CRITICAL(&readingsMux);
+
+  renderReading(r);
+
+  for (size_t i = 0; i < READING_MAX_SUBSCRIBERS; i++) {
+    if (notify[i]) xTaskNotifyGive(notify[i]);
+  }
+}
+
+uint32_t latestReadingSeq() {
+  portENTER_CRITICAL(&readingsMux);
+  uint32_t seq = lastSeq;
+  portEXIT_CRITICAL(&readingsMux);
+  return seq;
+}
+
+uint32_t oldestReadingSeq() {
+  uint32_t latest = latestReadingSeq();
+  return latest > READING_HISTORY ? latest - READING_HISTORY + 1 : 1;
+}
+
+bool getReading(uint32_t seq, Reading& out) {
+  bool ok = false;
+  portENTER_CRITICAL(&readingsMux);
+  if (seq != 0 && seq <= lastSeq && lastSeq - seq < READING_HISTORY) {
+    out = ring[seq % READING_HISTORY];
+    ok = true;
+  }
+  portEXIT_CRITICAL(&readingsMux);
+  return ok;
+}
+
+bool subscribeReadings(TaskHandle_t task) {
+  bool ok = false;
+  portENTER_CRITICAL(&readingsMux);
+  for (size_t i = 0; i < READING_MAX_SUBSCRIBERS && !ok; i++) {
+    if (subscribers[i] == NULL || subscribers[i] == task) {
+      subscribers[i] = task;
+      ok = true;
+    }
+  }
+  portEXIT_CRITICAL(&readingsMux);
+  return ok;
+}
+
+void unsubscribeReadings(TaskHandle_t task) {
+  portENTER_CRITICAL(&readingsMux);
+  for (size_t i = 0; i < READING_MAX_SUBSCRIBERS; i++) {
+    if (subscribers[i] == task) subscribers[i] = NULL;
+  }
+  portEXIT_CRITICAL(&readingsMux);
+}
@@ -0,0 +1,49 @@
+#ifndef SR_READINGS_H
+#define SR_READINGS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "SR_Reading.h"
+
+// ===== Published readings =====
+// The sensor task takes one snapshot of the readings per publish tick and
+// stores it, with a sequence number, in a small ring. Streaming consumers
+// read from the ring instead of each taking dataMutex, and can pick up
+// where they left off as long as the sequence is still in the ring.
+
+const size_t READING_HISTORY = 64;        // ~3 s at the publish rate
+const size_t READING_MAX_SUBSCRIBERS = 4;
+const size_t READING_RENDER_MAX = 320;
+
+// Formats the latest reading is pre-rendered in
+enum ReadingFormat : uint8_t {
+  READING_JSON,
+  READING_CBOR,
+  READING_PACKED,
+  READING_FORMAT_COUNT
+};
+
+// Fresh snapshot of the current readings. Returns false on mutex timeout.
+bool takeReading(Reading& r);
+
+// Sensor task: snapshot, append to the ring, render the latest reading
+// in every format and notify subscribers.
+void publishReading();
+
+// Copies the latest pre-rendered reading without taking any lock. Returns
+// the length, or 0 if nothing has been published yet (or cap is too small).
+size_t readRenderedReading(ReadingFormat format, uint8_t* out, size_t cap, uint32_t* seq = NULL);
+
+uint32_t latestReadingSeq();   // 0 before the first publish
+uint32_t oldestReadingSeq();
+
+// Copies a published reading. Returns false if seq is not (or no longer)
+// in the ring.
+bool getReading(uint32_t seq, Reading& out);
+
+// Subscribed tasks get a task notification (xTaskNotifyGive) per publish.
+bool subscribeReadings(TaskHandle_t task);
+void unsubscribeReadings(TaskHandle_t task);
+
+#endif // SR_READINGS_H
@@ -0,0 +1,16 @@
+#ifndef SR_SAMPLE_H
+#define SR_SAMPLE_H
+
+#include <stdint.h>
+
+// One captured reading. Kept free of Arduino types so the same layout can
+// be shared with host-side tools.
+struct Sample {
+  uint32_t t_ms;        // millis() at capture
+  uint32_t rotations;   // cumulative rotations in the session
+  float speed_mph;
+  float angle;
+  float vibration;
+};
+
+#endif // SR_SAMPLE_H
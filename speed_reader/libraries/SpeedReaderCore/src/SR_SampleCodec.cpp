@@ -0,0 +1,147 @@
+#include "SR_SampleCodec.h"
+#include <math.h>
+
+// ===== Varint / zigzag primitives =====
+namespace {
+
+struct ByteWriter {
+  uint8_t* p;
+  uint8_t* end;
+  bool ok;
+
+  void put(uint8_t b) {
+    if (p < end) *p++ = b;
+    else ok = false;
+  }
+
+  void varint(uint64_t v) {
+    while (v >= 0x80) {
+      put((uint8_t)(v | 0x80));
+      v >>= 7;
+    }
+    put((uint8_t)v);
+  }
+
+  void zigzag(int64_t v) {
+    varint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+  }
+};
+
+struct ByteReader {
+  const uint8_t* p;
+  const uint8_t* end;
+  bool ok;
+
+  uint8_t get() {
+    if (p < end) return *p++;
+    ok = false;
+    return 0;
+  }
+
+  uint64_t varint() {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t b = get();
+      v |= (uint64_t)(b & 0x7F) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    ok = false;
+    return 0;
+  }
+
+  int64_t zigzag() {
+    uint64_t v = varint();
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+  }
+};
+
+inline int32_t quantize(float v, float scale) {
+  return (int32_t)lroundf(v * scale);
+}
+
+// Writes one float column as scaled integer deltas
+void encodeFloatColumn(ByteWriter& w, const Sample* s, size_t count, float Sample::*field, float scale) {
+  int64_t prev = 0;
+  for (size_t i = 0; i < count; i++) {
+    int64_t q = quantize(s[i].*field, scale);
+    w.zigzag(q - prev);
+    prev = q;
+  }
+}
+
+void decodeFloatColumn(ByteReader& r, Sample* s, size_t count, float Sample::*field, float scale) {
+  int64_t prev = 0;
+  for (size_t i = 0; i < count; i++) {
+    prev += r.zigzag();
+    s[i].*field = (float)prev / scale;
+  }
+}
+
+} // namespace
+
+// ===== Block encoder =====
+size_t encodeSampleBlock(const Sample* samples, size_t count, uint8_t* out, size_t outCap) {
+  if (count == 0 || count > SAMPLE_BLOCK_MAX_COUNT) return 0;
+
+  ByteWriter w = { out, out + outCap, true };
+  w.put(SAMPLE_CODEC_VERSION);
+  w.varint(count);
+
+  // Timestamps: first value, first delta, then delta-of-delta
+  int64_t prevT = samples[0].t_ms;
+  int64_t prevDelta = 0;
+  w.varint(samples[0].t_ms);
+  for (size_t i = 1; i < count; i++) {
+    int64_t t = samples[i].t_ms;
+    int64_t delta = t - prevT;
+    w.zigzag(delta - prevDelta);
+    prevDelta = delta;
+    prevT = t;
+  }
+
+  // Rotations: first value, then deltas
+  int64_t prevR = 0;
+  for (size_t i = 0; i < count; i++) {
+    int64_t r = samples[i].rotations;
+    w.zigzag(r - prevR);
+    prevR = r;
+  }
+
+  encodeFloatColumn(w, samples, count, &Sample::speed_mph, SAMPLE_SPEED_SCALE);
+  encodeFloatColumn(w, samples, count, &Sample::angle, SAMPLE_ANGLE_SCALE);
+  encodeFloatColumn(w, samples, count, &Sample::vibration, SAMPLE_VIBRATION_SCALE);
+
+  return w.ok ? (size_t)(w.p - out) : 0;
+}
+
+// ===== Block decoder =====
+size_t decodeSampleBlock(const uint8_t* in, size_t len, Sample* out, size_t outCap, size_t* consumed) {
+  ByteReader r = { in, in + len, true };
+
+  if (r.get() != SAMPLE_CODEC_VERSION) return 0;
+  uint64_t count = r.varint();
+  if (!r.ok || count == 0 || count > SAMPLE_BLOCK_MAX_COUNT || count > outCap) return 0;
+
+  int64_t t = (int64_t)r.varint();
+  int64_t delta = 0;
+  out[0].t_ms = (uint32_t)t;
+  for (size_t i = 1; i < count; i++) {
+    delta += r.zigzag();
+    t += delta;
+    out[i].t_ms = (uint32_t)t;
+  }
+
+  int64_t rot = 0;
+  for (size_t i = 0; i < count; i++) {
+    rot += r.zigzag();
+    out[i].rotations = (uint32_t)rot;
+  }
+
+  decodeFloatColumn(r, out, count, &Sample::speed_mph, SAMPLE_SPEED_SCALE);
+  decodeFloatColumn(r, out, count, &Sample::angle, SAMPLE_ANGLE_SCALE);
+  decodeFloatColumn(r, out, count, &Sample::vibration, SAMPLE_VIBRATION_SCALE);
+
+  if (!r.ok) return 0;
+  if (consumed) *consumed = (size_t)(r.p - in);
+  return (size_t)count;
+}
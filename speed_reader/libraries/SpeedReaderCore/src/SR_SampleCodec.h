@@ -0,0 +1,43 @@
+#ifndef SR_SAMPLE_CODEC_H
+#define SR_SAMPLE_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SR_Sample.h"
+
+// ===== Compact columnar sample encoding =====
+// A block holds up to SAMPLE_BLOCK_MAX_COUNT samples, stored column by column:
+//   u8 version, varint count,
+//   t_ms:      varint first, zigzag first delta, zigzag delta-of-delta...
+//   rotations: varint first, zigzag deltas
+//   speed/angle/vibration: scaled to integers, zigzag first, zigzag deltas
+// Steady sampling makes most timestamp entries a single 0 byte, and slowly
+// changing readings give 1-2 byte deltas, so a sample costs ~5-8 bytes
+// instead of 20 raw or ~200 as JSON.
+//
+// Encode and decode work on caller-provided buffers only (no allocation)
+// and have no Arduino dependencies, so host tools link the same code.
+
+const uint8_t SAMPLE_CODEC_VERSION = 1;
+const size_t SAMPLE_BLOCK_MAX_COUNT = 255;
+
+// Quantization applied to float columns
+const float SAMPLE_SPEED_SCALE = 100.0f;      // 0.01 mph
+const float SAMPLE_ANGLE_SCALE = 100.0f;      // 0.01 degree
+const float SAMPLE_VIBRATION_SCALE = 1000.0f; // 0.001 g
+
+// Upper bound on the encoded size of a block of `count` samples
+inline size_t sampleBlockMaxSize(size_t count) {
+  return 2 + count * 5 * 10;
+}
+
+// Returns the number of bytes written, or 0 if `out` is too small or
+// count is out of range.
+size_t encodeSampleBlock(const Sample* samples, size_t count, uint8_t* out, size_t outCap);
+
+// Decodes one block. Returns the number of samples written to `out`, or
+// 0 if the block is malformed or does not fit in `outCap`. When `consumed`
+// is given it receives the number of input bytes used.
+size_t decodeSampleBlock(const uint8_t* in, size_t len, Sample* out, size_t outCap, size_t* consumed = NULL);
+
+#endif // SR_SAMPLE_CODEC_H
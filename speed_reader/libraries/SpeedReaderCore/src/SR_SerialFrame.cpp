@@ -0,0 +1,87 @@
+#include "SR_SerialFrame.h"
+#include <string.h>
+#include "SR_Crc.h"
+
+// ===== COBS =====
+// Each run of up to 254 non-zero bytes is prefixed with its length + 1; a
+// code below 0xFF also stands for the zero that followed the run.
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out, size_t cap) {
+  if (cap == 0) return 0;
+  size_t codePos = 0;
+  size_t o = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < len; i++) {
+    if (in[i] == 0) {
+      out[codePos] = code;
+      codePos = o++;
+      code = 1;
+    } else {
+      if (o >= cap) return 0;
+      out[o++] = in[i];
+      if (++code == 0xFF) {
+        out[codePos] = code;
+        codePos = o++;
+        code = 1;
+      }
+    }
+    if (o > cap) return 0;
+  }
+  out[codePos] = code;
+  return o;
+}
+
+size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out, size_t cap) {
+  size_t o = 0;
+  size_t i = 0;
+  while (i < len) {
+    uint8_t code = in[i++];
+    if (code == 0 || i + code - 1 > len) return 0;
+    for (uint8_t k = 1; k < code; k++) {
+      if (in[i] == 0 || o >= cap) return 0;
+      out[o++] = in[i++];
+    }
+    // The implied zero, except after a full run or at the end
+    if (code != 0xFF && i < len) {
+      if (o >= cap) return 0;
+      out[o++] = 0;
+    }
+  }
+  return o;
+}
+
+// ===== Frames =====
+size_t encodeSerialFrame(SerialFrameType type, uint32_t seq, uint32_t tUs,
+                         const uint8_t* payload, size_t len, uint8_t* out, size_t cap) {
+  if (len > SERIAL_FRAME_MAX_PAYLOAD || cap < 2) return 0;
+
+  uint8_t raw[SERIAL_FRAME_MAX_RAW];
+  SerialFrameHeader h = { SERIAL_FRAME_VERSION, type, seq, tUs };
+  memcpy(raw, &h, sizeof(h));
+  memcpy(raw + sizeof(h), payload, len);
+  size_t n = sizeof(h) + len;
+  uint32_t crc = srCrc32(raw, n);
+  memcpy(raw + n, &crc, sizeof(crc));
+  n += sizeof(crc);
+
+  out[0] = 0;
+  size_t encoded = cobsEncode(raw, n, out + 1, cap - 2);
+  if (encoded == 0) return 0;
+  out[1 + encoded] = 0;
+  return encoded + 2;
+}
+
+bool decodeSerialFrame(const uint8_t* in, size_t len, uint8_t* scratch, size_t cap,
+                       SerialFrameHeader& h, const uint8_t*& payload, size_t& payloadLen) {
+  size_t n = cobsDecode(in, len, scratch, cap);
+  if (n < sizeof(h) + 4) return false;
+
+  uint32_t crc;
+  memcpy(&crc, scratch + n - 4, sizeof(crc));
+  if (srCrc32(scratch, n - 4) != crc) return false;
+
+  memcpy(&h, scratch, sizeof(h));
+  if (h.version != SERIAL_FRAME_VERSION) return false;
+  payload = scratch + sizeof(h);
+  payloadLen = n - 4 - sizeof(h);
+  return true;
+}
@@ -0,0 +1,57 @@
+#ifndef SR_SERIAL_FRAME_H
+#define SR_SERIAL_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== Binary serial telemetry frames =====
+// On the wire every frame is
+//
+//   0x00, COBS(SerialFrameHeader, payload, CRC-32 little-endian), 0x00
+//
+// COBS (consistent overhead byte stuffing) removes every zero from the
+// frame for one byte of overhead per 254, so 0x00 only ever marks a frame
+// boundary: a receiver that opens the port mid-stream or loses bytes picks
+// up again at the next zero. The leading zero also closes whatever came
+// before the first frame, such as the boot ROM banner after a reset, so
+// it cannot corrupt that frame. The CRC (SR_Crc.h) covers header and
+// payload.
+//
+// No Arduino dependencies; tools/sr_serial.cpp links the same code.
+
+enum SerialFrameType : uint8_t {
+  SERIAL_FRAME_SAMPLE = 1,   // payload: CompactReading (SR_ReadingCodec.h)
+  SERIAL_FRAME_LOG = 2       // payload: level (LogLevel), then "tag: text"
+};
+
+const uint8_t SERIAL_FRAME_VERSION = 1;
+
+struct __attribute__((packed)) SerialFrameHeader {
+  uint8_t version;
+  uint8_t type;
+  uint32_t seq;     // per type, from 1; a gap in sample frames is a lost sample
+  uint32_t t_us;    // device monotonic clock, low 32 bits (wraps every ~71 min)
+};
+
+const size_t SERIAL_FRAME_MAX_PAYLOAD = 240;
+const size_t SERIAL_FRAME_MAX_RAW = sizeof(SerialFrameHeader) + SERIAL_FRAME_MAX_PAYLOAD + 4;
+// Both delimiters plus the COBS overhead
+const size_t SERIAL_FRAME_MAX_ENCODED = SERIAL_FRAME_MAX_RAW + SERIAL_FRAME_MAX_RAW / 254 + 3;
+
+// Each returns the number of bytes written, or 0 if `cap` is too small
+// (or, for decoding, the input is not valid COBS).
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out, size_t cap);
+size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out, size_t cap);
+
+// Builds a complete frame, delimiters included. Returns its length, or 0
+// if the payload is over SERIAL_FRAME_MAX_PAYLOAD or `cap` is too small.
+size_t encodeSerialFrame(SerialFrameType type, uint32_t seq, uint32_t tUs,
+                         const uint8_t* payload, size_t len, uint8_t* out, size_t cap);
+
+// Decodes the bytes between two delimiters into `scratch` (at least
+// SERIAL_FRAME_MAX_RAW bytes). On success `payload` points into scratch.
+// False if the frame is malformed, of an unknown version or fails the CRC.
+bool decodeSerialFrame(const uint8_t* in, size_t len, uint8_t* scratch, size_t cap,
+                       SerialFrameHeader& h, const uint8_t*& payload, size_t& payloadLen);
+
+#endif // SR_SERIAL_FRAME_H
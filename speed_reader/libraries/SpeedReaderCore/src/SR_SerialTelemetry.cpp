@@ -0,0 +1,126 @@
+#include "SR_SerialTelemetry.h"
+#include <freertos/queue.h>
+#include <esp_log.h>
+#include "globals.h"
+#include "SR_Readings.h"
+#include "SR_ReadingCodec.h"
+#include "SR_SerialFrame.h"
+#include "SR_Time.h"
+#include "SR_Metrics.h"
+
+struct SerialSample {
+  uint32_t seq;
+  uint32_t tUs;
+  uint8_t reading[sizeof(CompactReading)];
+};
+
+static QueueHandle_t sampleQueue = NULL;
+static volatile bool active = false;
+static uint32_t sampleSeq = 0;   // sensorTask only
+static uint32_t logSeq = 0;      // log drain task only
+
+bool serialTelemetryActive() {
+  return active;
+}
+
+void serialTelemetrySample() {
+  if (!active) return;
+
+  SerialSample s;
+  s.tUs = (uint32_t)monoUs();
+  Reading r;
+  if (!takeReading(r)) return;
+  s.seq = ++sampleSeq;
+  r.seq = s.seq;
+  encodeReadingCompact(r, s.reading, sizeof(s.reading));
+  // A full queue drops the sample; the host sees the gap in seq
+  xQueueSend(sampleQueue, &s, 0);
+}
+
+// Every frame goes out in a single write(); the UART driver holds its lock
+// for the whole call, so sample and log frames from the two tasks never
+// interleave.
+static void writeLogFrame(uint32_t ms, LogLevel level, const char* tag, const char* text) {
+  static uint8_t payload[SERIAL_FRAME_MAX_PAYLOAD];
+  static uint8_t frame[SERIAL_FRAME_MAX_ENCODED];
+  payload[0] = level;
+  int n = snprintf((char*)payload + 1, sizeof(payload) - 1, "%s: %s", tag, text);
+  if (n < 0) n = 0;
+  if ((size_t)n > sizeof(payload) - 2) n = sizeof(payload) - 2;   // truncated
+
+  size_t len = encodeSerialFrame(SERIAL_FRAME_LOG, ++logSeq, ms * 1000, payload, 1 + n,
+                                 frame, sizeof(frame));
+  if (len) Serial.write(frame, len);
+}
+
+// consoleMutex keeps the baud switch from landing inside a text line
+void serialConsoleLog(uint32_t ms, LogLevel level, const char* tag, const char* text) {
+  static const char LEVEL_CHARS[] = "-EWID";
+  takeMutex(consoleMutex, MUTEX_CONSOLE);
+  if (active) {
+    writeLogFrame(ms, level, tag, text);
+  } else {
+    Serial.printf("[%6lu.%03lu] %c %s: %s\n", (unsigned long)(ms / 1000),
+                  (unsigned long)(ms % 1000), LEVEL_CHARS[level], tag, text);
+  }
+  xSemaphoreGive(consoleMutex);
+}
+
+// ESP-IDF components print "E (1234) tag: text" to the console UART on
+// their own; in binary mode those lines join the log ring instead
+static int systemLogToRing(const char* fmt, va_list args) {
+  char line[logLineMax];
+  int n = vsnprintf(line, sizeof(line), fmt, args);
+  if (n <= 0) return n;
+  size_t len = strlen(line);
+  while (len && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+  const char* p = line;
+  if (*p == '\033') {                       // colour escape
+    const char* m = strchr(p, 'm');
+    p = m ? m + 1 : p;
+  }
+  if (*p == '\0') return n;
+
+  LogLevel level = LOG_LEVEL_INFO;
+  if (*p == 'E') level = LOG_LEVEL_ERROR;
+  else if (*p == 'W') level = LOG_LEVEL_WARN;
+  else if (*p == 'D' || *p == 'V') level = LOG_LEVEL_DEBUG;
+  SR_LOG(level, "IDF", "%s", p);
+  return n;
+}
+
+static void serialTelemetryTask(void* parameter) {
+  uint8_t frame[SERIAL_FRAME_MAX_ENCODED];
+  SerialSample s;
+  while (true) {
+    if (xQueueReceive(sampleQueue, &s, portMAX_DELAY) != pdTRUE) continue;
+    size_t len = encodeSerialFrame(SERIAL_FRAME_SAMPLE, s.seq, s.tUs, s.reading,
+                                   sizeof(s.reading), frame, sizeof(frame));
+    if (len) Serial.write(frame, len);
+  }
+}
+
+void startSerialTelemetry() {
+  if (!serialBinary || active) return;
+
+  sampleQueue = xQueueCreate(serialQueueDepth, sizeof(SerialSample));
+  if (!sampleQueue) {
+    LOG_E("Serial", "Binary telemetry: no memory for the sample queue");
+    return;
+  }
+  LOG_I("Serial", "Switching to binary telemetry at %d baud, %d ms per sample",
+        serialBaud, serialIntervalMs);
+
+  // Give the log drain a moment to print the boot log as text; anything
+  // still in the ring after the switch goes out as log frames
+  delay(logDrainIdleMs * 5);
+  Serial.setDebugOutput(false);
+  esp_log_set_vprintf(systemLogToRing);
+
+  takeMutex(consoleMutex, MUTEX_CONSOLE);
+  Serial.flush();
+  Serial.updateBaudRate(serialBaud);
+  active = true;
+  xSemaphoreGive(consoleMutex);
+  xTaskCreatePinnedToCore(serialTelemetryTask, "SerialTelemetry", serialTaskStack, NULL, 1, NULL, 1);
+}
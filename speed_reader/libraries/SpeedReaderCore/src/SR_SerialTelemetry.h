@@ -0,0 +1,34 @@
+#ifndef SR_SERIAL_TELEMETRY_H
+#define SR_SERIAL_TELEMETRY_H
+
+#include <Arduino.h>
+#include "SR_Log.h"
+
+// ===== Binary serial telemetry =====
+// With serial_binary set, the console switches to serial_baud at the end
+// of begin() and carries SR_SerialFrame.h frames instead of text: a sample
+// frame (CompactReading) for every sensorTask pass, which then runs every
+// serial_interval_ms instead of every sensorLoopMs, and each log line as a
+// log frame. Meant for bench captures over a cable at a few hundred Hz
+// without WiFi; tools/sr_serial decodes the stream.
+//
+// sensorTask only queues the sample; the SerialTelemetry task frames and
+// writes it, so a slow or absent host drops samples (a gap in seq) instead
+// of stalling the sensor loop. serial_binary and serial_baud are read at
+// boot; serial_interval_ms applies to the next pass.
+//
+// After the switch nothing but the log drain and the SerialTelemetry task
+// writes to the port: the core's debug output is turned off and ESP-IDF
+// log lines are routed into the log ring with the tag "IDF".
+
+void startSerialTelemetry();
+bool serialTelemetryActive();
+
+// sensorTask, once per pass
+void serialTelemetrySample();
+
+// Log drain task only: prints the line as text, or sends it as a log frame
+// once binary mode is on
+void serialConsoleLog(uint32_t ms, LogLevel level, const char* tag, const char* text);
+
+#endif // SR_SERIAL_TELEMETRY_H
@@ -0,0 +1,36 @@
+#include "SR_ServerTask.h"
+
+#if ENABLE_HTTP
+
+static bool skippable = false;   // a SkippableWrite is in scope
+static bool decided = false;     // its first write has been checked
+static bool skipping = false;    // and the socket could not take it
+
+SkippableWrite::SkippableWrite() {
+  skippable = true;
+  decided = false;
+  skipping = false;
+}
+
+SkippableWrite::~SkippableWrite() {
+  skippable = false;
+}
+
+bool SkippableWrite::skipped() const {
+  return skipping;
+}
+
+bool SkippableWrite::allow(int fd) {
+  if (!skippable) return true;
+  if (!decided) {
+    decided = true;
+    fd_set writable;
+    FD_ZERO(&writable);
+    FD_SET(fd, &writable);
+    timeval tv = { 0, 0 };
+    skipping = fd < 0 || select(fd + 1, NULL, &writable, NULL, &tv) <= 0 || !FD_ISSET(fd, &writable);
+  }
+  return !skipping;
+}
+
+#endif // ENABLE_HTTP
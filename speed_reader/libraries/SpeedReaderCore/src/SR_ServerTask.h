@@ -0,0 +1,131 @@
+#ifndef SR_SERVER_TASK_H
+#define SR_SERVER_TASK_H
+
+#include "globals.h"
+
+#if ENABLE_HTTP
+#include <HTTPServer.hpp>
+#include <HTTPSServer.hpp>
+#include <HTTPConnection.hpp>
+#include <lwip/sockets.h>
+
+// ===== Dedicated server task =====
+// Runs the server loop in its own task (core, priority and stack from
+// config.h) instead of the Arduino loop with a fixed delay(10).
+//
+// While no connection is open the task blocks in select() on the listening
+// socket, so a new client is picked up within a tick and an idle server
+// costs nothing. While connections are open it runs the loop every tick;
+// the library does not expose connection sockets to wait on.
+//
+// Base::loop() is called by name, so a base that hides loop() (TLSServer)
+// gets its own version.
+//
+// An optional tick function runs after every loop pass, on the server
+// task, for work that must share it (writing to WebSocket connections).
+typedef void (*ServerTickFn)();
+
+// ===== Skippable writes =====
+// Data that may be dropped (a WebSocket reading) must not block the
+// server task on a peer that stopped reading. While a SkippableWrite is
+// in scope, the connection checks with select() that its socket can take
+// data before the first write; if it cannot, that write and every later
+// one in the scope are dropped, so a frame goes out whole or not at all.
+// Server task only.
+class SkippableWrite {
+public:
+  SkippableWrite();
+  ~SkippableWrite();
+  bool skipped() const;
+
+  // For writeBuffer() of the connections: false drops the write
+  static bool allow(int fd);
+};
+
+// Plain HTTP connection that knows its socket, for SkippableWrite
+class PlainConnection : public HTTPConnection {
+public:
+  using HTTPConnection::HTTPConnection;
+
+  int initialize(int serverSocketID, HTTPHeaders* defaultHeaders) override {
+    _fd = HTTPConnection::initialize(serverSocketID, defaultHeaders);
+    return _fd;
+  }
+
+protected:
+  // A dropped write reports success so the frame is simply not sent
+  size_t writeBuffer(byte* buffer, size_t length) override {
+    if (!SkippableWrite::allow(_fd)) return length;
+    return HTTPConnection::writeBuffer(buffer, length);
+  }
+
+private:
+  int _fd = -1;
+};
+
+// HTTPServer with PlainConnection, for the main server in HTTP mode
+class PlainServer : public HTTPServer {
+public:
+  using HTTPServer::HTTPServer;
+
+protected:
+  int createConnection(int idx) override {
+    PlainConnection* connection = new PlainConnection(this);
+    _connections[idx] = connection;
+    return connection->initialize(_socket, &_defaultHeaders);
+  }
+};
+
+template <class Base>
+class TaskServer : public Base {
+public:
+  using Base::Base;
+
+  void onTick(ServerTickFn fn) { _tick = fn; }
+
+  bool startTask(const char* name, uint32_t stack = httpTaskStack) {
+    return xTaskCreatePinnedToCore(&TaskServer::taskMain, name, stack, this,
+                                   httpTaskPriority, &_task, httpTaskCore) == pdPASS;
+  }
+
+  int openConnections() {
+    int open = 0;
+    for (int i = 0; i < this->_maxConnections; i++) {
+      if (this->_connections[i] != NULL && !this->_connections[i]->isClosed()) open++;
+    }
+    return open;
+  }
+
+private:
+  void waitForClient(unsigned long timeoutMs) {
+    if (this->_socket < 0) {
+      vTaskDelay(timeoutMs / portTICK_PERIOD_MS);
+      return;
+    }
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(this->_socket, &readable);
+    timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    select(this->_socket + 1, &readable, NULL, NULL, &tv);
+  }
+
+  static void taskMain(void* parameter) {
+    TaskServer* self = (TaskServer*)parameter;
+    while (true) {
+      self->loop();
+      if (self->_tick) self->_tick();
+      if (self->openConnections() == 0) self->waitForClient(serverIdleWaitMs);
+      // A client left in the backlog keeps the socket readable; don't spin
+      vTaskDelay(1);
+    }
+  }
+
+  TaskHandle_t _task = NULL;
+  ServerTickFn _tick = NULL;
+};
+
+#endif // ENABLE_HTTP
+
+#endif // SR_SERVER_TASK_H
@@ -1,10 +1,26 @@
 #include "SR_Session.h"
 #include "SR_LCDDisplay.h"
+#include "SR_SessionLog.h"
+#include "SR_Worker.h"
+#include "SR_Events.h"
 #include "globals.h"
+#include "SR_Metrics.h"
+
+// LCD writes take lcdMutex and ~2 ms of GPIO; keep them off the HTTP task
+static void showCurrentJob(void*) {
+  char job[sizeof(currentJob)];
+  job[0] = '\0';
+  if (takeMutex(dataMutex, MUTEX_DATA)) {
+    memcpy(job, currentJob, sizeof(job));
+    xSemaphoreGive(dataMutex);
+  }
+  if (job[0]) showJob(String(job));
+  else showReady();
+}
 
 // ===== Session Management =====
 void resetSession() {
-  if (xSemaphoreTake(dataMutex, portMAX_DELAY) == pdTRUE) {
+  if (takeMutex(dataMutex, MUTEX_DATA)) {
     rotationCount = 0;
     maxSpeed_mph = 0.0f;
     lastRotationMicros = 0;
@@ -21,21 +37,37 @@ void resetSession() {
 void startSession(const String& job) {
   resetSession();
   
-  if (xSemaphoreTake(dataMutex, portMAX_DELAY) == pdTRUE) {
+  if (takeMutex(dataMutex, MUTEX_DATA)) {
     strncpy(currentJob, job.c_str(), sizeof(currentJob) - 1);
     currentJob[sizeof(currentJob) - 1] = '\0';
     sessionActive = true;
     xSemaphoreGive(dataMutex);
   }
   
-  showJob(job);
+  sessionLogStart(job.c_str());
+  logSessionEvent(EVENT_SESSION_START, job.c_str());
+  runDeferred(showCurrentJob);
 }
 
 void endSession() {
-  if (xSemaphoreTake(dataMutex, portMAX_DELAY) == pdTRUE) {
+  SessionEndPayload summary = {};
+  char job[sizeof(currentJob)] = "";
+  
+  if (takeMutex(dataMutex, MUTEX_DATA)) {
+    memcpy(job, currentJob, sizeof(job));
+    summary.endMs = millis();
+    summary.rotations = rotationCount;
+    summary.maxSpeed = maxSpeed_mph;
+    summary.maxAngle = maxAngle;
+    summary.minAngle = minAngle;
+    summary.maxVibration = maxVibration;
+    summary.reason = END_NORMAL;
     sessionActive = false;
     currentJob[0] = '\0'; 
     xSemaphoreGive(dataMutex);
   }
-  showReady();
+  
+  sessionLogEnd(summary);
+  logSessionEvent(EVENT_SESSION_END, job);
+  runDeferred(showCurrentJob);
 }
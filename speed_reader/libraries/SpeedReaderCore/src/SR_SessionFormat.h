@@ -0,0 +1,79 @@
+#ifndef SR_SESSION_FORMAT_H
+#define SR_SESSION_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SR_Crc.h"
+#include "SR_Sample.h"
+
+// ===== On-flash session log format =====
+// A session file is a sequence of records:
+//   [RecordHeader][payload (len bytes)][crc32 of header+payload]
+// Records are only ever appended. A reader stops at the first record whose
+// CRC does not match; everything before it is trusted.
+
+#define SESSION_LOG_DIR "/sessions"
+#define SESSION_LOG_EXT ".srl"
+
+enum SessionRecordType : uint8_t {
+  REC_SESSION_START = 1,
+  REC_SAMPLES       = 2,  // raw Sample array
+  REC_SESSION_END   = 3,
+  REC_SAMPLES_PACKED = 4, // encodeSampleBlock() output, see SR_SampleCodec.h
+  REC_TIME_ANCHOR   = 5   // TimeAnchorPayload; maps t_ms to UTC from here on
+};
+
+enum SessionEndReason : uint8_t {
+  END_NORMAL    = 0,  // endSession() (speed timeout or explicit)
+  END_REPLACED  = 1,  // a new session was started while this one was open
+  END_RECOVERED = 2   // closed at boot after a reset mid-session
+};
+
+struct __attribute__((packed)) RecordHeader {
+  uint8_t type;
+  uint8_t version;
+  uint16_t len;
+};
+
+struct __attribute__((packed)) SessionStartPayload {
+  uint32_t sessionId;
+  uint32_t startMs;
+  char job[32];
+};
+
+struct __attribute__((packed)) SessionEndPayload {
+  uint32_t endMs;
+  uint32_t rotations;
+  float maxSpeed;
+  float maxAngle;
+  float minAngle;
+  float maxVibration;
+  uint8_t reason;
+};
+
+// Written after the start record when the clock is synced, and again on
+// every SNTP sync during the session. Sample UTC = utcMs + (t_ms - tMs)
+// using the latest anchor before the sample.
+struct __attribute__((packed)) TimeAnchorPayload {
+  uint32_t tMs;
+  uint64_t utcMs;
+};
+
+const uint8_t SESSION_RECORD_VERSION = 1;
+const size_t SESSION_RECORD_OVERHEAD = sizeof(RecordHeader) + sizeof(uint32_t);
+const size_t SESSION_END_RECORD_SIZE = SESSION_RECORD_OVERHEAD + sizeof(SessionEndPayload);
+
+// Validates one record at buf[0..avail). Returns the full record size
+// (header + payload + crc) or 0 if the record is truncated or corrupt.
+inline size_t sessionRecordCheck(const uint8_t* buf, size_t avail) {
+  if (avail < SESSION_RECORD_OVERHEAD) return 0;
+  const RecordHeader* h = (const RecordHeader*)buf;
+  size_t total = SESSION_RECORD_OVERHEAD + h->len;
+  if (total > avail) return 0;
+  uint32_t stored;
+  const uint8_t* c = buf + sizeof(RecordHeader) + h->len;
+  stored = (uint32_t)c[0] | ((uint32_t)c[1] << 8) | ((uint32_t)c[2] << 16) | ((uint32_t)c[3] << 24);
+  return (srCrc32(buf, sizeof(RecordHeader) + h->len) == stored) ? total : 0;
+}
+
+#endif // SR_SESSION_FORMAT_H
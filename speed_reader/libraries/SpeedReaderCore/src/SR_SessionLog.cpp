@@ -0,0 +1,523 @@
+#include "SR_SessionLog.h"
+#include <SPIFFS.h>
+#include <freertos/queue.h>
+#include "globals.h"
+#include "SR_SampleCodec.h"
+#include "SR_Time.h"
+#include "SR_Metrics.h"
+#include "SR_Log.h"
+
+// ===== Session Recorder =====
+// Producers (sensorTask, HTTP handlers) append records into one of two RAM
+// blocks. A block is only handed to the writer task once it is full, so
+// flash is written in whole pages; the partial block is flushed when the
+// session ends. If the writer falls behind, records are dropped rather than
+// blocking the sampling path.
+
+static const size_t LOG_BLOCK_SIZE = 512;            // 2 SPIFFS pages
+static const size_t SAMPLES_PER_RECORD = 16;
+static const float LOG_MAX_USAGE = 0.75f;            // prune oldest above this
+static const size_t LOG_QUEUE_LENGTH = 8;
+static const UBaseType_t LOG_WRITE_SLOTS = 2;        // one per block
+static const unsigned long LOG_CMD_WAIT_MS = 100;    // open/close wait for queue room
+
+enum LogOp : uint8_t { LOG_OP_OPEN, LOG_OP_WRITE, LOG_OP_CLOSE };
+
+struct LogCmd {
+  uint8_t op;
+  uint8_t block;
+  uint32_t sessionId;
+};
+
+struct LogBlock {
+  uint8_t data[LOG_BLOCK_SIZE];
+  size_t len;
+  volatile bool busy;
+};
+
+static LogBlock blocks[2];
+static uint8_t activeBlock = 0;
+static SemaphoreHandle_t logMutex = NULL;
+static QueueHandle_t logQueue = NULL;
+static TaskHandle_t logTaskHandle = NULL;
+
+static Sample pendingSamples[SAMPLES_PER_RECORD];
+static size_t pendingCount = 0;
+static uint8_t packedSamples[LOG_BLOCK_SIZE - SESSION_RECORD_OVERHEAD];
+
+static volatile uint32_t activeSessionId = 0;
+static uint32_t nextSessionId = 1;
+static volatile uint32_t droppedRecords = 0;
+
+bool sessionLogPath(uint32_t id, char* out, size_t outLen) {
+  if (id == 0) return false;
+  int n = snprintf(out, outLen, SESSION_LOG_DIR "/%08lu" SESSION_LOG_EXT, (unsigned long)id);
+  return n > 0 && (size_t)n < outLen;
+}
+
+static uint32_t sessionIdFromName(const char* name) {
+  const char* base = strrchr(name, '/');
+  base = base ? base + 1 : name;
+  const char* ext = strstr(base, SESSION_LOG_EXT);
+  if (!ext) return 0;
+  return strtoul(base, NULL, 10);
+}
+
+// ===== Writer side =====
+static void pruneSessions(uint32_t keepId) {
+  while (SPIFFS.usedBytes() > SPIFFS.totalBytes() * LOG_MAX_USAGE) {
+    uint32_t oldest = 0;
+    File dir = SPIFFS.open(SESSION_LOG_DIR);
+    File f = dir.openNextFile();
+    while (f) {
+      uint32_t id = sessionIdFromName(f.name());
+      if (id != 0 && id != keepId && (oldest == 0 || id < oldest)) oldest = id;
+      f = dir.openNextFile();
+    }
+    dir.close();
+
+    char path[40];
+    if (oldest == 0 || !sessionLogPath(oldest, path, sizeof(path))) return;
+    LOG_I("Session", "pruning %s", path);
+    // Otherwise the same file would be picked again forever
+    size_t usedBefore = SPIFFS.usedBytes();
+    if (!SPIFFS.remove(path) || SPIFFS.usedBytes() >= usedBefore) {
+      LOG_E("Session", "could not free space by removing %s", path);
+      return;
+    }
+  }
+}
+
+static void sessionLogTask(void* parameter) {
+  File file;
+  LogCmd cmd;
+  char path[40];
+
+  while (true) {
+    if (xQueueReceive(logQueue, &cmd, portMAX_DELAY) != pdTRUE) continue;
+
+    switch (cmd.op) {
+      case LOG_OP_OPEN:
+        if (file) file.close();
+        pruneSessions(cmd.sessionId);
+        if (sessionLogPath(cmd.sessionId, path, sizeof(path))) {
+          file = SPIFFS.open(path, FILE_APPEND);
+          if (!file) LOG_E("Session", "failed to open %s", path);
+        }
+        break;
+
+      case LOG_OP_WRITE: {
+        LogBlock& b = blocks[cmd.block];
+        if (file && b.len > 0) {
+          file.write(b.data, b.len);
+          file.flush();
+        }
+        b.len = 0;
+        b.busy = false;
+        break;
+      }
+
+      case LOG_OP_CLOSE:
+        if (file) file.close();
+        break;
+    }
+  }
+}
+
+// ===== Producer side (caller holds logMutex) =====
+// A dropped WRITE would leave a hole in the middle of a record, and a
+// reader stops at the first bad record. So the last LOG_WRITE_SLOTS queue
+// slots are kept for WRITEs: a block stays busy until the writer has
+// written it, so no more than that can be outstanding and a WRITE always
+// finds room. Producers are serialised by logMutex and the writer only
+// takes from the queue, so the free space can only grow while waiting.
+// Open and close wait a bounded time for room and are dropped after it.
+static bool queueCmd(uint8_t op, uint8_t block, uint32_t sessionId) {
+  LogCmd cmd = { op, block, sessionId };
+  if (op == LOG_OP_WRITE) return xQueueSend(logQueue, &cmd, portMAX_DELAY) == pdTRUE;
+
+  TickType_t start = xTaskGetTickCount();
+  while (uxQueueSpacesAvailable(logQueue) <= LOG_WRITE_SLOTS) {
+    if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(LOG_CMD_WAIT_MS)) {
+      droppedRecords++;
+      return false;
+    }
+    vTaskDelay(1);
+  }
+  return xQueueSend(logQueue, &cmd, 0) == pdTRUE;
+}
+
+static void submitActiveBlock() {
+  LogBlock& b = blocks[activeBlock];
+  if (b.busy || b.len == 0) return;
+  b.busy = true;
+  queueCmd(LOG_OP_WRITE, activeBlock, 0);
+  activeBlock ^= 1;
+}
+
+static void logBytes(const uint8_t* p, size_t n) {
+  while (n > 0) {
+    LogBlock& b = blocks[activeBlock];
+    size_t chunk = LOG_BLOCK_SIZE - b.len;
+    if (chunk > n) chunk = n;
+    memcpy(b.data + b.len, p, chunk);
+    b.len += chunk;
+    p += chunk;
+    n -= chunk;
+    if (b.len == LOG_BLOCK_SIZE) submitActiveBlock();
+  }
+}
+
+static bool appendRecord(uint8_t type, const void* payload, uint16_t len) {
+  if (blocks[activeBlock].busy) activeBlock ^= 1;
+
+  const LogBlock& cur = blocks[activeBlock];
+  const LogBlock& other = blocks[activeBlock ^ 1];
+  size_t space = cur.busy ? 0 : LOG_BLOCK_SIZE - cur.len;
+  if (!other.busy) space += LOG_BLOCK_SIZE;
+
+  if (SESSION_RECORD_OVERHEAD + len > space) {
+    droppedRecords++;
+    return false;
+  }
+
+  RecordHeader h = { type, SESSION_RECORD_VERSION, len };
+  uint32_t crc = srCrc32(&h, sizeof(h));
+  crc = srCrc32(payload, len, crc);
+
+  logBytes((const uint8_t*)&h, sizeof(h));
+  logBytes((const uint8_t*)payload, len);
+  logBytes((const uint8_t*)&crc, sizeof(crc));
+  return true;
+}
+
+static void flushPendingSamples() {
+  if (pendingCount == 0) return;
+  size_t packed = encodeSampleBlock(pendingSamples, pendingCount, packedSamples, sizeof(packedSamples));
+  if (packed > 0) {
+    appendRecord(REC_SAMPLES_PACKED, packedSamples, packed);
+  } else {
+    appendRecord(REC_SAMPLES, pendingSamples, pendingCount * sizeof(Sample));
+  }
+  pendingCount = 0;
+}
+
+// Caller holds logMutex. Pending samples go first so the anchor applies
+// to the samples after it.
+static void appendTimeAnchor() {
+  TimeAnchorPayload anchor;
+  anchor.tMs = millis();
+  anchor.utcMs = utcMs();
+  if (anchor.utcMs == 0) return;
+  flushPendingSamples();
+  appendRecord(REC_TIME_ANCHOR, &anchor, sizeof(anchor));
+}
+
+static void closeActiveSession(const SessionEndPayload& summary) {
+  flushPendingSamples();
+  appendRecord(REC_SESSION_END, &summary, sizeof(summary));
+  submitActiveBlock();
+  queueCmd(LOG_OP_CLOSE, 0, activeSessionId);
+  activeSessionId = 0;
+}
+
+void sessionLogStart(const char* job) {
+  if (!logQueue) return;
+  if (!takeMutex(logMutex, MUTEX_SESSION_LOG)) return;
+
+  if (activeSessionId != 0) {
+    SessionEndPayload replaced = {};
+    replaced.endMs = millis();
+    replaced.reason = END_REPLACED;
+    closeActiveSession(replaced);
+  }
+
+  // Without an open file nothing of this session can be written; leave it
+  // unrecorded rather than appending to the previous file
+  uint32_t id = nextSessionId++;
+  if (!queueCmd(LOG_OP_OPEN, 0, id)) {
+    xSemaphoreGive(logMutex);
+    return;
+  }
+  activeSessionId = id;
+
+  SessionStartPayload start = {};
+  start.sessionId = activeSessionId;
+  start.startMs = millis();
+  strncpy(start.job, job, sizeof(start.job) - 1);
+  appendRecord(REC_SESSION_START, &start, sizeof(start));
+  appendTimeAnchor();
+
+  xSemaphoreGive(logMutex);
+}
+
+void sessionLogSample(const Sample& sample) {
+  if (!logQueue || activeSessionId == 0) return;
+  if (!takeMutex(logMutex, MUTEX_SESSION_LOG)) return;
+
+  if (activeSessionId != 0) {
+    pendingSamples[pendingCount++] = sample;
+    if (pendingCount == SAMPLES_PER_RECORD) flushPendingSamples();
+  }
+
+  xSemaphoreGive(logMutex);
+}
+
+void sessionLogEnd(const SessionEndPayload& summary) {
+  if (!logQueue || activeSessionId == 0) return;
+  if (!takeMutex(logMutex, MUTEX_SESSION_LOG)) return;
+
+  if (activeSessionId != 0) {
+    closeActiveSession(summary);
+  }
+
+  xSemaphoreGive(logMutex);
+}
+
+void sessionLogTimeAnchor() {
+  if (!logQueue || activeSessionId == 0) return;
+  if (!takeMutex(logMutex, MUTEX_SESSION_LOG)) return;
+
+  if (activeSessionId != 0) {
+    appendTimeAnchor();
+  }
+
+  xSemaphoreGive(logMutex);
+}
+
+uint32_t sessionLogDropped() {
+  return droppedRecords;
+}
+
+// ===== Catalog =====
+bool sessionLogInfo(uint32_t id, SessionInfo& info) {
+  char path[40];
+  if (!sessionLogPath(id, path, sizeof(path)) || !SPIFFS.exists(path)) return false;
+
+  File file = SPIFFS.open(path, FILE_READ);
+  if (!file) return false;
+
+  memset(&info, 0, sizeof(info));
+  info.id = id;
+  info.bytes = file.size();
+  info.active = (id == activeSessionId);
+
+  uint8_t buf[SESSION_RECORD_OVERHEAD + sizeof(SessionStartPayload)];
+  if (file.read(buf, sizeof(buf)) == sizeof(buf) && sessionRecordCheck(buf, sizeof(buf)) &&
+      ((RecordHeader*)buf)->type == REC_SESSION_START) {
+    const SessionStartPayload* start = (const SessionStartPayload*)(buf + sizeof(RecordHeader));
+    info.startMs = start->startMs;
+    memcpy(info.job, start->job, sizeof(info.job) - 1);
+  }
+
+  if (info.bytes >= SESSION_END_RECORD_SIZE) {
+    uint8_t end[SESSION_END_RECORD_SIZE];
+    file.seek(info.bytes - SESSION_END_RECORD_SIZE);
+    info.complete = file.read(end, sizeof(end)) == sizeof(end) &&
+                    sessionRecordCheck(end, sizeof(end)) &&
+                    ((RecordHeader*)end)->type == REC_SESSION_END;
+  }
+
+  file.close();
+  return true;
+}
+
+int sessionLogList(SessionInfoCallback cb, void* ctx) {
+  int count = 0;
+  File dir = SPIFFS.open(SESSION_LOG_DIR);
+  if (!dir) return 0;
+
+  File f = dir.openNextFile();
+  while (f) {
+    uint32_t id = sessionIdFromName(f.name());
+    f.close();
+    SessionInfo info;
+    if (id != 0 && sessionLogInfo(id, info)) {
+      cb(info, ctx);
+      count++;
+    }
+    f = dir.openNextFile();
+  }
+  dir.close();
+  return count;
+}
+
+// ===== Boot-time recovery =====
+// Walks every record of a file. Returns the length of the valid prefix and
+// fills in what a recovered end record needs.
+static size_t scanSessionFile(File& file, uint8_t& lastType, SessionEndPayload& summary) {
+  uint8_t buf[LOG_BLOCK_SIZE + 64];
+  Sample decoded[SAMPLES_PER_RECORD];
+  size_t have = 0;
+  size_t offset = 0;
+  lastType = 0;
+
+  while (true) {
+    size_t n = file.read(buf + have, sizeof(buf) - have);
+    have += n;
+
+    size_t pos = 0;
+    size_t rec;
+    while ((rec = sessionRecordCheck(buf + pos, have - pos)) > 0) {
+      const RecordHeader* h = (const RecordHeader*)(buf + pos);
+      const uint8_t* payload = buf + pos + sizeof(RecordHeader);
+      lastType = h->type;
+
+      if (h->type == REC_SESSION_START) {
+        summary.endMs = ((const SessionStartPayload*)payload)->startMs;
+      } else if (h->type == REC_SAMPLES || h->type == REC_SAMPLES_PACKED) {
+        size_t count = 0;
+        if (h->type == REC_SAMPLES_PACKED) {
+          count = decodeSampleBlock(payload, h->len, decoded, SAMPLES_PER_RECORD);
+        } else {
+          count = h->len / sizeof(Sample);
+          if (count > SAMPLES_PER_RECORD) count = SAMPLES_PER_RECORD;
+          memcpy(decoded, payload, count * sizeof(Sample));
+        }
+        for (size_t i = 0; i < count; i++) {
+          const Sample& s = decoded[i];
+          summary.endMs = s.t_ms;
+          summary.rotations = s.rotations;
+          if (s.speed_mph > summary.maxSpeed) summary.maxSpeed = s.speed_mph;
+          if (s.angle > summary.maxAngle) summary.maxAngle = s.angle;
+          if (s.angle < summary.minAngle) summary.minAngle = s.angle;
+          if (s.vibration > summary.maxVibration) summary.maxVibration = s.vibration;
+        }
+      }
+      pos += rec;
+    }
+
+    offset += pos;
+    if (n == 0 || (pos == 0 && have == sizeof(buf))) break;
+    memmove(buf, buf + pos, have - pos);
+    have -= pos;
+  }
+  return offset;
+}
+
+static const char RECOVER_TMP_PATH[] = SESSION_LOG_DIR "/recover.tmp";
+
+static void recoverSessionFile(uint32_t id) {
+  char path[40];
+  if (!sessionLogPath(id, path, sizeof(path))) return;
+
+  File file = SPIFFS.open(path, FILE_READ);
+  if (!file) return;
+  size_t size = file.size();
+
+  uint8_t lastType = 0;
+  SessionEndPayload summary = {};
+  summary.maxAngle = -180.0f;
+  summary.minAngle = 180.0f;
+  size_t valid = scanSessionFile(file, lastType, summary);
+
+  if (lastType == REC_SESSION_END && valid == size) {
+    file.close();
+    return;
+  }
+
+  if (valid == 0) {
+    file.close();
+    LOG_W("Session", "removing empty/corrupt %s", path);
+    SPIFFS.remove(path);
+    return;
+  }
+
+  LOG_W("Session", "recovering %s (%u of %u bytes valid)", path, (unsigned)valid, (unsigned)size);
+
+  summary.reason = END_RECOVERED;
+  RecordHeader h = { REC_SESSION_END, SESSION_RECORD_VERSION, sizeof(SessionEndPayload) };
+  uint32_t crc = srCrc32(&h, sizeof(h));
+  crc = srCrc32(&summary, sizeof(summary), crc);
+
+  if (valid == size) {
+    // Clean tail: just append the end record
+    file.close();
+    file = SPIFFS.open(path, FILE_APPEND);
+  } else {
+    // Torn tail: copy the valid prefix, since SPIFFS cannot truncate in
+    // place. The original goes only once the copy is complete; a reset
+    // before the rename is undone by restoreRecoveryCopy().
+    File out = SPIFFS.open(RECOVER_TMP_PATH, FILE_WRITE);
+    uint8_t buf[256];
+    file.seek(0);
+    size_t left = valid;
+    while (out && left > 0) {
+      size_t n = file.read(buf, left < sizeof(buf) ? left : sizeof(buf));
+      if (n == 0 || out.write(buf, n) != n) break;
+      left -= n;
+    }
+    bool copied = out && left == 0;
+    file.close();
+    if (out) out.close();
+    if (!copied || !SPIFFS.remove(path)) {
+      LOG_E("Session", "could not copy %s, left without an end record", path);
+      SPIFFS.remove(RECOVER_TMP_PATH);
+      return;
+    }
+    if (!SPIFFS.rename(RECOVER_TMP_PATH, path)) {
+      LOG_E("Session", "could not rename the copy of %s, retrying at next boot", path);
+      return;
+    }
+    file = SPIFFS.open(path, FILE_APPEND);
+  }
+
+  if (file) {
+    file.write((const uint8_t*)&h, sizeof(h));
+    file.write((const uint8_t*)&summary, sizeof(summary));
+    file.write((const uint8_t*)&crc, sizeof(crc));
+    file.close();
+  }
+}
+
+// A reset between removing a torn session and renaming its copy leaves
+// only recover.tmp. Its start record names the session; put it back
+// unless the original is still there.
+static void restoreRecoveryCopy() {
+  File f = SPIFFS.open(RECOVER_TMP_PATH, FILE_READ);
+  if (!f) return;
+  uint8_t buf[64];
+  size_t n = f.read(buf, sizeof(buf));
+  f.close();
+
+  uint32_t id = 0;
+  if (sessionRecordCheck(buf, n) > 0 && ((const RecordHeader*)buf)->type == REC_SESSION_START) {
+    id = ((const SessionStartPayload*)(buf + sizeof(RecordHeader)))->sessionId;
+  }
+  char path[40];
+  if (sessionLogPath(id, path, sizeof(path)) && !SPIFFS.exists(path)) {
+    LOG_W("Session", "restoring %s from an interrupted recovery", path);
+    if (SPIFFS.rename(RECOVER_TMP_PATH, path)) return;
+  }
+  SPIFFS.remove(RECOVER_TMP_PATH);
+}
+
+void initSessionLog() {
+  LOG_I("Session", "Initializing session log...");
+
+  // Find the highest session id. Only the most recent session can have
+  // been cut short by a reset, so that is the one to check.
+  restoreRecoveryCopy();
+  unsigned count = 0;
+  File dir = SPIFFS.open(SESSION_LOG_DIR);
+  if (dir) {
+    File f = dir.openNextFile();
+    while (f) {
+      uint32_t id = sessionIdFromName(f.name());
+      f.close();
+      if (id != 0) count++;
+      if (id >= nextSessionId) nextSessionId = id + 1;
+      f = dir.openNextFile();
+    }
+    dir.close();
+  }
+  if (nextSessionId > 1) {
+    recoverSessionFile(nextSessionId - 1);
+  }
+
+  LOG_I("Session", "%u stored session(s), next id %lu", count, (unsigned long)nextSessionId);
+
+  logMutex = xSemaphoreCreateMutex();
+  logQueue = xQueueCreate(LOG_QUEUE_LENGTH, sizeof(LogCmd));
+  xTaskCreatePinnedToCore(sessionLogTask, "SessionLog", 4096, NULL, 1, &logTaskHandle, 0);
+}
@@ -0,0 +1,33 @@
+#ifndef SR_SESSION_LOG_H
+#define SR_SESSION_LOG_H
+
+#include <Arduino.h>
+#include "SR_Sample.h"
+#include "SR_SessionFormat.h"
+
+// Catalog entry for one stored session
+struct SessionInfo {
+  uint32_t id;
+  uint32_t startMs;
+  uint32_t bytes;
+  char job[32];
+  bool complete;  // has a valid end record
+  bool active;    // currently being recorded
+};
+
+typedef void (*SessionInfoCallback)(const SessionInfo& info, void* ctx);
+
+// Session Recorder Functions
+void initSessionLog();
+void sessionLogStart(const char* job);
+void sessionLogSample(const Sample& sample);
+void sessionLogEnd(const SessionEndPayload& summary);
+void sessionLogTimeAnchor();   // no-op without an open session or a synced clock
+
+// Catalog / download helpers
+bool sessionLogPath(uint32_t id, char* out, size_t outLen);
+bool sessionLogInfo(uint32_t id, SessionInfo& info);
+int sessionLogList(SessionInfoCallback cb, void* ctx);
+uint32_t sessionLogDropped();
+
+#endif // SR_SESSION_LOG_H
@@ -1,9 +1,11 @@
 #include "SR_SpeedSensor.h"
 #include "SR_Session.h"
 #include "globals.h"
+#include "SR_Profiler.h"
 
 // ===== Interrupt Handler =====
 void IRAM_ATTR onRotation() {
+  PROFILE_SCOPE(PROF_ON_ROTATION);
   unsigned long t = micros();
   const unsigned long debounceUs = 5000UL; // Reduced to 5ms to allow speeds up to ~124mph
   
@@ -2,10 +2,11 @@
 #include "globals.h"
 #include "SR_LCDDisplay.h"
 #include "SR_Accelerometer.h"
+#include "SR_Log.h"
 #include <WiFi.h>
 
 void runStartupDiagnostics() {
-    Serial.println("\n\n===== STARTUP DIAGNOSTICS =====");
+    LOG_I("Diag", "===== STARTUP DIAGNOSTICS =====");
     
     updateLCD("Self Test...", "Checking Systems");
     delay(1000);
@@ -13,44 +14,39 @@ void runStartupDiagnostics() {
     bool anyFailure = false;
     
     // 1. Accelerometer Check
-    Serial.print("[DIAG] Accelerometer: ");
     if (isAccelConnected) {
-        Serial.println("OK");
+        LOG_I("Diag", "Accelerometer: OK");
         updateLCD("Sensors:", "Accel OK");
         delay(500);
     } else {
-        Serial.println("FAIL - Not Detected");
+        LOG_E("Diag", "Accelerometer: FAIL - Not Detected");
         updateLCD("Sensors:", "Accel FAILED");
         anyFailure = true;
         delay(2000);
     }
     
     // 2. WiFi Check
-    Serial.print("[DIAG] WiFi: ");
     if (haveWiFi) {
-        Serial.print("OK - IP: ");
-        Serial.println(WiFi.localIP());
-        
         char ipStr[17];
         snprintf(ipStr, sizeof(ipStr), "IP %s", WiFi.localIP().toString().c_str());
+        LOG_I("Diag", "WiFi: OK - %s", ipStr);
         updateLCD("WiFi: OK", ipStr);
         delay(1000);
     } else {
-        Serial.println("FAIL - Not Connected");
-        updateLCD("WiFi: FAILED", "Check Config");
-        anyFailure = true;
-        delay(2000);
+        // Not a failure: the WiFi manager keeps retrying in the background
+        LOG_I("Diag", "WiFi: Not connected yet, still trying");
+        updateLCD("WiFi:", "Connecting...");
+        delay(1000);
     }
     
     // 3. Bluetooth Check
     #if ENABLE_BT
-    Serial.print("[DIAG] Bluetooth: ");
     if (haveBT) {
-        Serial.println("OK");
+        LOG_I("Diag", "Bluetooth: OK");
         updateLCD("Bluetooth:", "OK");
         delay(500);
     } else {
-        Serial.println("FAIL - Init Error");
+        LOG_E("Diag", "Bluetooth: FAIL - Init Error");
         updateLCD("Bluetooth:", "FAILED");
         anyFailure = true;
         delay(2000);
@@ -58,12 +54,11 @@ void runStartupDiagnostics() {
     #endif
     
     // Summary
-    Serial.println("===== DIAGNOSTICS COMPLETE =====");
     if (anyFailure) {
-        Serial.println("System Status: DEGRADED (Check Logs)");
+        LOG_W("Diag", "===== DIAGNOSTICS COMPLETE: DEGRADED (Check Logs) =====");
         updateLCD("System Status:", "Failures Found");
     } else {
-        Serial.println("System Status: HEALTHY");
+        LOG_I("Diag", "===== DIAGNOSTICS COMPLETE: HEALTHY =====");
         updateLCD("System Status:", "All Green");
     }
     delay(1500);
@@ -0,0 +1,387 @@
+#include "SR_TLSServer.h"
+
+#if ENABLE_HTTP
+#include <lwip/sockets.h>
+#include <mbedtls/net_sockets.h>
+#include "SR_Log.h"
+#include "SR_ServerTask.h"
+
+#ifndef MBEDTLS_SSL_CACHE_C
+#error "TLSServer needs the mbedTLS session cache (MBEDTLS_SSL_CACHE_C)"
+#endif
+
+// Cipher suites in preference order, per key type. ECDHE for forward
+// secrecy; AES-GCM first since the ESP32 has AES in hardware. mbedTLS
+// takes the first of ours that the client also offers.
+static const int TLS_CIPHERS_ECDSA[] = {
+  MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+  MBEDTLS_TLS_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256,
+  MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256,
+  0
+};
+static const int TLS_CIPHERS_RSA[] = {
+  MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,
+  MBEDTLS_TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256,
+  MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256,
+  0
+};
+
+// One client: TLS over the accepted socket, set up from the server's
+// shared config so sessions cached on one connection resume on the next.
+// Also exposes the connection state the library keeps protected.
+class TLSConnection : public HTTPConnection {
+public:
+  explicit TLSConnection(TLSServer* server) : HTTPConnection(server), _ready(false) {
+    mbedtls_ssl_init(&_ssl);
+    mbedtls_net_init(&_net);
+  }
+
+  virtual ~TLSConnection() {
+    closeConnection();
+  }
+
+  // Accepts the pending client and runs the handshake; -1 on failure.
+  // The handshake runs on the server task, so a client that connects and
+  // then goes quiet must not hold it: every socket read and write times
+  // out, and the handshake as a whole has a deadline. The socket timeouts
+  // stay for the connection's life, so a stalled peer later fails its own
+  // read or write instead of blocking the other clients.
+  int initialize(int serverSocketID, const mbedtls_ssl_config* conf, HTTPHeaders* defaultHeaders) {
+    int fd = HTTPConnection::initialize(serverSocketID, defaultHeaders);
+    if (fd < 0) return -1;
+
+    struct timeval tv;
+    tv.tv_sec = tlsHandshakeTimeoutMs / 1000;
+    tv.tv_usec = (tlsHandshakeTimeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    _net.fd = fd;
+    int ret = mbedtls_ssl_setup(&_ssl, conf);
+    if (ret == 0) {
+      _ready = true;
+      mbedtls_ssl_set_bio(&_ssl, &_net, mbedtls_net_send, mbedtls_net_recv, NULL);
+      unsigned long start = millis();
+      do {
+        ret = mbedtls_ssl_handshake(&_ssl);
+      } while ((ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) &&
+               millis() - start < tlsHandshakeTimeoutMs);
+      if (ret == 0) return fd;
+      if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) ret = MBEDTLS_ERR_SSL_TIMEOUT;
+    }
+    LOG_D("TLS", "Handshake failed: -0x%04x", (unsigned)-ret);
+    _connectionState = STATEERROR;
+    closeConnection();
+    return -1;
+  }
+
+  // The socket itself is closed by HTTPConnection
+  void closeConnection() override {
+    if (_ready) {
+      if (!isError()) mbedtls_ssl_close_notify(&_ssl);
+      mbedtls_ssl_free(&_ssl);
+      mbedtls_ssl_init(&_ssl);
+      _ready = false;
+    }
+    HTTPConnection::closeConnection();
+  }
+
+  bool isSecure() override { return true; }
+
+  // Waiting for the next request on a kept-alive connection
+  bool isIdle() { return !isClosed() && _connectionState == STATEINITIAL; }
+  unsigned long idleMs() { return millis() - _lastTransmissionTS; }
+
+protected:
+  size_t writeBuffer(byte* buffer, size_t length) override {
+    if (!SkippableWrite::allow(_net.fd)) return length;
+    // mbedTLS writes at most one record per call
+    size_t sent = 0;
+    while (sent < length) {
+      int ret = mbedtls_ssl_write(&_ssl, buffer + sent, length - sent);
+      if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) continue;
+      if (ret < 0) break;
+      sent += ret;
+    }
+    return sent;
+  }
+
+  // Same contract as recv(): 0 when the peer closed, negative on error
+  size_t readBytesToBuffer(byte* buffer, size_t length) override {
+    int ret;
+    do {
+      ret = mbedtls_ssl_read(&_ssl, buffer, length);
+    } while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+    if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) return 0;
+    return (size_t)ret;
+  }
+
+  bool canReadData() override {
+    return HTTPConnection::canReadData() || mbedtls_ssl_get_bytes_avail(&_ssl) > 0;
+  }
+
+  size_t pendingByteCount() override {
+    return mbedtls_ssl_get_bytes_avail(&_ssl);
+  }
+
+private:
+  mbedtls_ssl_context _ssl;
+  mbedtls_net_context _net;
+  bool _ready;   // _ssl is set up on the socket
+};
+
+static TLSServer* activeServer = NULL;
+
+TLSServer::TLSServer(SSLCert* cert, const uint16_t port, const uint8_t maxConnections)
+  : HTTPServer(port, maxConnections), _cert(cert), _resumed(false), _deferredSince(0) {
+  memset(&_stats, 0, sizeof(_stats));
+  _stats.maxConnections = maxConnections;
+  _statsMux = portMUX_INITIALIZER_UNLOCKED;
+  mbedtls_ssl_config_init(&_conf);
+  mbedtls_x509_crt_init(&_crt);
+  mbedtls_pk_init(&_pk);
+  mbedtls_entropy_init(&_entropy);
+  mbedtls_ctr_drbg_init(&_drbg);
+  mbedtls_ssl_cache_init(&_cache);
+}
+
+TLSServer::~TLSServer() {
+  stop();
+  freeTLS();
+}
+
+// ===== Setup =====
+uint8_t TLSServer::setupSocket() {
+  if (isRunning()) return 1;
+
+  KeyInfo key;
+  parsePrivateKey(_cert->getPKData(), _cert->getPKLength(), key);
+  _stats.keyType = key.type;
+  LOG_I("TLS", "TLS key: %s, %u bits", keyTypeName(key.type), key.bits);
+  if (key.type != KEY_RSA && key.type != KEY_EC_P256) {
+    // mbedTLS on the ESP32 signs with RSA and ECDSA only; P-256 is the
+    // curve it is fastest on
+    LOG_E("TLS", "TLS key must be RSA or ECDSA P-256");
+    return 0;
+  }
+
+  if (setupTLS(key.type) && HTTPServer::setupSocket()) {
+    activeServer = this;
+    return 1;
+  }
+  freeTLS();
+  return 0;
+}
+
+// The certificate is parsed in place: its DER stays in mapped flash (or
+// in the heap copy SSLCert keeps for the whole uptime), so the chain adds
+// no copy of it. mbedtls_pk_parse_key has no such variant; the parsed key
+// is held on the heap.
+bool TLSServer::setupTLS(KeyType keyType) {
+  static const char PERSONALIZATION[] = "sr_tls_server";
+  int ret;
+  if ((ret = mbedtls_ctr_drbg_seed(&_drbg, mbedtls_entropy_func, &_entropy,
+                                   (const unsigned char*)PERSONALIZATION, sizeof(PERSONALIZATION) - 1)) != 0 ||
+      (ret = mbedtls_x509_crt_parse_der_nocopy(&_crt, _cert->getCertData(), _cert->getCertLength())) != 0 ||
+      (ret = mbedtls_pk_parse_key(&_pk, _cert->getPKData(), _cert->getPKLength(), NULL, 0,
+                                  mbedtls_ctr_drbg_random, &_drbg)) != 0 ||
+      (ret = mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                         MBEDTLS_SSL_PRESET_DEFAULT)) != 0 ||
+      (ret = mbedtls_ssl_conf_own_cert(&_conf, &_crt, &_pk)) != 0) {
+    LOG_E("TLS", "TLS setup failed: -0x%04x", (unsigned)-ret);
+    return false;
+  }
+  mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &_drbg);
+
+  // Offer only TLS 1.2 and the suites that match the key, ours first
+  mbedtls_ssl_conf_min_tls_version(&_conf, MBEDTLS_SSL_VERSION_TLS1_2);
+  mbedtls_ssl_conf_max_tls_version(&_conf, MBEDTLS_SSL_VERSION_TLS1_2);
+  mbedtls_ssl_conf_ciphersuites(&_conf, keyType == KEY_RSA ? TLS_CIPHERS_RSA : TLS_CIPHERS_ECDSA);
+
+  // Keep sessions so returning clients get an abbreviated handshake
+  mbedtls_ssl_cache_set_max_entries(&_cache, tlsSessionCacheSize);
+  mbedtls_ssl_cache_set_timeout(&_cache, tlsSessionTimeoutS);
+  mbedtls_ssl_conf_session_cache(&_conf, this, &TLSServer::cacheGet, &TLSServer::cacheSet);
+  return true;
+}
+
+// Frees everything setupTLS() allocated and leaves it ready for another
+// setup. Only called once no connection uses the config.
+void TLSServer::freeTLS() {
+  mbedtls_ssl_config_free(&_conf);
+  mbedtls_x509_crt_free(&_crt);
+  mbedtls_pk_free(&_pk);
+  mbedtls_ctr_drbg_free(&_drbg);
+  mbedtls_entropy_free(&_entropy);
+  mbedtls_ssl_cache_free(&_cache);
+  mbedtls_ssl_config_init(&_conf);
+  mbedtls_x509_crt_init(&_crt);
+  mbedtls_pk_init(&_pk);
+  mbedtls_entropy_init(&_entropy);
+  mbedtls_ctr_drbg_init(&_drbg);
+  mbedtls_ssl_cache_init(&_cache);
+}
+
+// Handshakes run one at a time on the server task, so the flag belongs to
+// the handshake in progress
+int TLSServer::cacheGet(void* data, unsigned char const* id, size_t idLen, mbedtls_ssl_session* session) {
+  TLSServer* server = (TLSServer*)data;
+  int ret = mbedtls_ssl_cache_get(&server->_cache, id, idLen, session);
+  if (ret == 0) server->_resumed = true;
+  return ret;
+}
+
+int TLSServer::cacheSet(void* data, unsigned char const* id, size_t idLen, const mbedtls_ssl_session* session) {
+  return mbedtls_ssl_cache_set(&((TLSServer*)data)->_cache, id, idLen, session);
+}
+
+void TLSServer::teardownSocket() {
+  if (activeServer == this) activeServer = NULL;
+  HTTPServer::teardownSocket();
+  freeTLS();
+}
+
+uint8_t TLSServer::connectionBudget() {
+  uint32_t freeHeap = ESP.getFreeHeap();
+  uint32_t n = freeHeap > tlsHeapReserve ? (freeHeap - tlsHeapReserve) / tlsConnectionHeap : 0;
+  if (n < 1) n = 1;
+  if (n > httpsMaxConnections) n = httpsMaxConnections;
+  return (uint8_t)n;
+}
+
+// ===== Admission =====
+bool TLSServer::canAdmit() {
+  return ESP.getFreeHeap() >= tlsHeapReserve + tlsConnectionHeap &&
+         ESP.getMaxAllocHeap() >= tlsMinLargestBlock;
+}
+
+bool TLSServer::clientPending() {
+  fd_set readable;
+  FD_ZERO(&readable);
+  FD_SET(_socket, &readable);
+  timeval tv = { 0, 0 };
+  return select(_socket + 1, &readable, NULL, NULL, &tv) > 0;
+}
+
+bool TLSServer::evictIdle() {
+  TLSConnection* oldest = NULL;
+  unsigned long oldestIdle = tlsIdleEvictMs;
+  for (int i = 0; i < _maxConnections; i++) {
+    TLSConnection* c = static_cast<TLSConnection*>(_connections[i]);
+    if (c && c->isIdle() && c->idleMs() >= oldestIdle) {
+      oldest = c;
+      oldestIdle = c->idleMs();
+    }
+  }
+  if (!oldest) return false;
+
+  // Closed connections are freed on the next loop pass
+  oldest->closeConnection();
+  portENTER_CRITICAL(&_statsMux);
+  _stats.evicted++;
+  portEXIT_CRITICAL(&_statsMux);
+  return true;
+}
+
+void TLSServer::rejectPending() {
+  int fd = accept(_socket, NULL, NULL);
+  if (fd >= 0) close(fd);
+  portENTER_CRITICAL(&_statsMux);
+  _stats.rejected++;
+  portEXIT_CRITICAL(&_statsMux);
+  LOG_W("TLS", "client rejected, heap %u, largest block %u",
+        ESP.getFreeHeap(), ESP.getMaxAllocHeap());
+}
+
+static uint8_t countOpen(HTTPConnection** connections, int count) {
+  uint8_t open = 0;
+  for (int i = 0; i < count; i++) {
+    if (connections[i] && !connections[i]->isClosed()) open++;
+  }
+  return open;
+}
+
+void TLSServer::loop() {
+  if (!_running) return;
+  if (clientPending() && countOpen(_connections, _maxConnections) == _maxConnections) {
+    evictIdle();
+  }
+  HTTPServer::loop();
+
+  uint8_t open = countOpen(_connections, _maxConnections);
+  portENTER_CRITICAL(&_statsMux);
+  _stats.openConnections = open;
+  portEXIT_CRITICAL(&_statsMux);
+}
+
+int TLSServer::createConnection(int idx) {
+  if (!canAdmit()) {
+    // Leave the client in the backlog until memory is freed
+    if (evictIdle()) return -1;
+    if (_deferredSince == 0) {
+      _deferredSince = millis();
+      portENTER_CRITICAL(&_statsMux);
+      _stats.deferred++;
+      portEXIT_CRITICAL(&_statsMux);
+    }
+    if (millis() - _deferredSince >= tlsAdmitWaitMs) {
+      rejectPending();
+      _deferredSince = 0;
+    }
+    return -1;
+  }
+  _deferredSince = 0;
+
+  TLSConnection* connection = new TLSConnection(this);
+  _connections[idx] = connection;
+
+  uint32_t freeBefore = ESP.getFreeHeap();
+  uint32_t minBefore = ESP.getMinFreeHeap();
+  unsigned long start = millis();
+  _resumed = false;
+  int id = connection->initialize(_socket, &_conf, &_defaultHeaders);
+  uint32_t ms = millis() - start;
+
+  // The low-water mark only moves when the handshake sets a new one, so the
+  // peak is exact for the first handshakes after boot and a lower bound
+  // after that
+  uint32_t freeAfter = ESP.getFreeHeap();
+  uint32_t minAfter = ESP.getMinFreeHeap();
+  uint32_t low = minAfter < minBefore ? minAfter : freeAfter;
+  recordHandshake(id >= 0, _resumed, ms,
+                  freeBefore > freeAfter ? freeBefore - freeAfter : 0,
+                  freeBefore > low ? freeBefore - low : 0);
+  return id;
+}
+
+// ===== Stats =====
+void TLSServer::recordHandshake(bool ok, bool resumed, uint32_t ms, uint32_t heapHeld, uint32_t heapPeak) {
+  portENTER_CRITICAL(&_statsMux);
+  if (ok) {
+    _stats.handshakes++;
+    _stats.heapPerConnection = heapHeld;
+    if (heapPeak > _stats.heapPeak) _stats.heapPeak = heapPeak;
+    _stats.lastMs = ms;
+    _stats.totalMs += ms;
+    if (ms > _stats.maxMs) _stats.maxMs = ms;
+    if (resumed) _stats.resumed++;
+  } else {
+    _stats.failures++;
+  }
+  portEXIT_CRITICAL(&_statsMux);
+}
+
+TLSStats TLSServer::stats() {
+  portENTER_CRITICAL(&_statsMux);
+  TLSStats s = _stats;
+  portEXIT_CRITICAL(&_statsMux);
+  return s;
+}
+
+bool getTLSStats(TLSStats& out) {
+  if (!activeServer) return false;
+  out = activeServer->stats();
+  return true;
+}
+
+#endif // ENABLE_HTTP
@@ -0,0 +1,95 @@
+#ifndef SR_TLS_SERVER_H
+#define SR_TLS_SERVER_H
+
+#include "globals.h"
+#include "SR_CertInfo.h"
+
+#if ENABLE_HTTP
+#include <HTTPServer.hpp>
+#include <HTTPConnection.hpp>
+#include <SSLCert.hpp>
+#include <mbedtls/ssl.h>
+#include <mbedtls/ssl_cache.h>
+#include <mbedtls/x509_crt.h>
+#include <mbedtls/pk.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+
+struct TLSStats {
+  uint32_t handshakes;      // completed
+  uint32_t failures;
+  uint32_t resumed;         // abbreviated handshakes from the session cache
+  uint32_t deferred;        // clients that had to wait for memory
+  uint32_t rejected;        // clients dropped after tlsAdmitWaitMs
+  uint32_t evicted;         // idle keep-alive connections closed for a new client
+  uint32_t lastMs;
+  uint32_t maxMs;
+  uint32_t totalMs;
+  uint32_t heapPerConnection; // held by the last connection after its handshake
+  uint32_t heapPeak;          // largest heap drop during a handshake
+  KeyType keyType;
+  uint8_t maxConnections;
+  uint8_t openConnections;
+};
+
+// ===== HTTPS server =====
+// Replaces HTTPSServer so the server owns its TLS setup and connections.
+// TLS runs on mbedTLS directly: every connection shares one
+// mbedtls_ssl_config, which carries
+//  - cipher suites that follow the key type (ECDSA P-256 or RSA), server order
+//  - the session cache, so a returning client skips the key exchange
+//  - a connection is only accepted while the heap can hold its buffers;
+//    otherwise the client waits in the backlog for up to tlsAdmitWaitMs
+//  - when a client is waiting, the longest-idle keep-alive connection is
+//    closed to make room
+//  - handshake counts and durations are kept for /config
+class TLSServer : public HTTPServer {
+public:
+  TLSServer(SSLCert* cert, const uint16_t port = 443, const uint8_t maxConnections = httpsMaxConnections);
+  virtual ~TLSServer();
+
+  // Hides HTTPServer::loop() to make room for a waiting client first
+  void loop();
+
+  // Safe to call from any task
+  TLSStats stats();
+
+  // Connections the current free heap can hold, 1..httpsMaxConnections
+  static uint8_t connectionBudget();
+
+protected:
+  virtual uint8_t setupSocket();
+  virtual void teardownSocket();
+  virtual int createConnection(int idx);
+
+private:
+  bool canAdmit();
+  bool clientPending();
+  bool evictIdle();
+  void rejectPending();
+  void recordHandshake(bool ok, bool resumed, uint32_t ms, uint32_t heapHeld, uint32_t heapPeak);
+
+  bool setupTLS(KeyType keyType);
+  void freeTLS();
+  static int cacheGet(void* data, unsigned char const* id, size_t idLen, mbedtls_ssl_session* session);
+  static int cacheSet(void* data, unsigned char const* id, size_t idLen, const mbedtls_ssl_session* session);
+
+  SSLCert* _cert;
+  mbedtls_ssl_config _conf;
+  mbedtls_x509_crt _crt;
+  mbedtls_pk_context _pk;
+  mbedtls_entropy_context _entropy;
+  mbedtls_ctr_drbg_context _drbg;
+  mbedtls_ssl_cache_context _cache;
+  bool _resumed;       // the current handshake was found in the cache
+  unsigned long _deferredSince;
+  TLSStats _stats;
+  portMUX_TYPE _statsMux;
+};
+
+// Stats of the running HTTPS server; false if none is running
+bool getTLSStats(TLSStats& out);
+
+#endif // ENABLE_HTTP
+
+#endif // SR_TLS_SERVER_H
@@ -3,18 +3,32 @@
 #include "SR_SpeedSensor.h"
 #include "SR_LCDDisplay.h"
 #include "SR_Accelerometer.h"
-
-#if ENABLE_BT
-#include <BluetoothSerial.h>
-#endif
+#include "SR_SessionLog.h"
+#include "SR_Readings.h"
+#include "SR_Uploader.h"
+#include "SR_Events.h"
+#include "SR_Metrics.h"
+#include "SR_Profiler.h"
+#include "SR_Log.h"
+#include "SR_SerialTelemetry.h"
 
 // ===== FreeRTOS Tasks =====
 void sensorTask(void* parameter) {
   unsigned long lastPrint = 0;
   const unsigned long printInterval = 1000;
+  unsigned long lastLogSample = 0;
+  unsigned long lastPublish = 0;
+  #if ENABLE_PROFILER
+  uint32_t loopStart = 0;
+  #endif
   
   while (true) {
     unsigned long now = millis();
+    #if ENABLE_PROFILER
+    uint32_t cycles = ESP.getCycleCount();
+    if (loopStart) profileRecord(PROF_SENSOR_PERIOD, cycles - loopStart);
+    loopStart = cycles;
+    #endif
     
     // Read ADC
     if (now - lastAdcRead >= readIntervalMs) {
@@ -30,6 +44,31 @@ void sensorTask(void* parameter) {
 
     // Read Accelerometer
     updateAngle();
+    serialTelemetrySample();
+    
+    // Publish a snapshot for streaming consumers
+    if (now - lastPublish >= publishIntervalMs) {
+      lastPublish = now;
+      publishReading();
+      checkEventRules();
+      uploadTick(now);
+    }
+    
+    // Record session samples
+    if (sessionActive && now - lastLogSample >= sessionSampleIntervalMs) {
+      lastLogSample = now;
+      Sample s;
+      s.t_ms = now;
+      s.speed_mph = getCurrentSpeed();
+      
+      if (takeMutex(dataMutex, MUTEX_DATA)) {
+        s.rotations = rotationCount;
+        s.angle = currentAngle;
+        s.vibration = currentVibration;
+        xSemaphoreGive(dataMutex);
+        sessionLogSample(s);
+      }
+    }
     
     // Periodic debug print
     if (now - lastPrint >= printInterval) {
@@ -41,7 +80,7 @@ void sensorTask(void* parameter) {
       float ang;
       float vib;
       
-      if (xSemaphoreTake(dataMutex, portMAX_DELAY) == pdTRUE) {
+      if (takeMutex(dataMutex, MUTEX_DATA)) {
         rc = rotationCount;
         totalDistance_miles = (float)rc * distancePerRotation_miles;
         d_miles = totalDistance_miles;
@@ -50,53 +89,22 @@ void sensorTask(void* parameter) {
         xSemaphoreGive(dataMutex);
       }
       
-      Serial.print("rot:");
-      Serial.print(rc);
-      Serial.print(" dist_mi:");
-      Serial.print(d_miles, 2);
-      Serial.print(" speed_mph:");
-      Serial.print(speed_mph, 2);
-      Serial.print(" D4(Pin");
-      Serial.print(D4_DIGITAL);
-      Serial.print("):");
-      Serial.print(lastDigital);
-      Serial.print(" D5(Pin");
-      Serial.print(D5_ANALOG);
-      Serial.print("):");
-      Serial.print(lastAnalog);
-      
-      float voltage = (lastAnalog / 4095.0f) * 3.3f;
-      Serial.print(" (");
-      Serial.print(voltage, 2);
-      Serial.print("V)");
-
-      Serial.print(" Angle:");
-      Serial.print(ang, 4);
-      Serial.print(" Vib:");
-      Serial.print(vib, 4);
-      Serial.print(" RawAng:");
-      Serial.print(rawAngle, 4);
-      
-      Serial.print(" RawAcc:[");
-      Serial.print(debug_raw_x); Serial.print(",");
-      Serial.print(debug_raw_y); Serial.print(",");
-      Serial.print(debug_raw_z); Serial.print("] Heap:");
-      Serial.println(ESP.getFreeHeap());
-      
-      #if ENABLE_BT
-      if (haveBT) {
-        SerialBT.print(rc);
-        SerialBT.print(',');
-        SerialBT.print(d_miles);
-        SerialBT.print(',');
-        SerialBT.print(speed_mph);
-        SerialBT.print(',');
-        SerialBT.println(lastAnalog);
-      }
-      #endif
+      // One formatted line into the log ring; the UART is drained elsewhere
+      int analog = lastAnalog;
+      float voltage = (analog / 4095.0f) * 3.3f;
+      LOG_I("Sensor", "rot:%lu dist_mi:%.2f speed_mph:%.2f D4(Pin%d):%d D5(Pin%d):%d (%.2fV) "
+            "Angle:%.4f Vib:%.4f RawAng:%.4f RawAcc:[%d,%d,%d] Heap:%lu",
+            rc, d_miles, speed_mph, D4_DIGITAL, (int)lastDigital, D5_ANALOG, analog, voltage,
+            ang, vib, rawAngle, debug_raw_x, debug_raw_y, debug_raw_z,
+            (unsigned long)ESP.getFreeHeap());
     }
     
-    vTaskDelay(20 / portTICK_PERIOD_MS);
+    #if ENABLE_PROFILER
+    profileRecord(PROF_SENSOR_LOOP, ESP.getCycleCount() - loopStart);
+    #endif
+    // Binary serial telemetry samples every pass, so it sets the pace
+    unsigned long loopMs = serialTelemetryActive() ? (unsigned long)serialIntervalMs : sensorLoopMs;
+    vTaskDelay(loopMs / portTICK_PERIOD_MS);
   }
 }
 
@@ -113,7 +121,7 @@ void displayTask(void* parameter) {
       bool shouldShowStats = sessionActive;
       
       if (!shouldShowStats) {
-        if (xSemaphoreTake(dataMutex, 0) == pdTRUE) {
+        if (takeMutex(dataMutex, MUTEX_DATA, 0)) {
           if (rotationCount > 0) shouldShowStats = true;
           xSemaphoreGive(dataMutex);
         }
@@ -0,0 +1,88 @@
+#include "SR_TelemetryDatagram.h"
+#include "SR_ReadingCodec.h"
+#include "SR_JsonWriter.h"
+#include "SR_Json.h"
+#include <string.h>
+
+size_t encodeTelemetry(const Reading& r, uint32_t packet, TelemetryFormat format,
+                       uint8_t* out, size_t cap) {
+  if (format == TELEMETRY_PACKED) {
+    TelemetryHeader h = { { 'S', 'R' }, TELEMETRY_VERSION, TELEMETRY_PACKED, packet };
+    if (cap < sizeof(h)) return 0;
+    size_t n = encodeReadingPacket(r, out + sizeof(h), cap - sizeof(h));
+    if (n == 0) return 0;
+    memcpy(out, &h, sizeof(h));
+    return sizeof(h) + n;
+  }
+
+  JsonWriter w((char*)out, cap);
+  w.beginObject();
+  w.field("pkt", (unsigned long)packet);
+  w.field("seq", (unsigned long)r.seq);
+  w.field("t_ms", (unsigned long)r.t_ms);
+  writeReadingFields(w, r);
+  w.endObject();
+  return w.overflow() ? 0 : w.length();
+}
+
+// ===== Decoding =====
+static bool decodeJson(const char* json, size_t len, uint32_t& packet, Reading& r) {
+  struct FloatKey {
+    const char* name;
+    float Reading::*field;
+  };
+  static const FloatKey FLOAT_KEYS[] = {
+    { "distance_miles", &Reading::distance_miles },
+    { "speed_mph",      &Reading::speed_mph },
+    { "max_speed",      &Reading::max_speed },
+    { "angle",          &Reading::angle },
+    { "max_angle",      &Reading::max_angle },
+    { "min_angle",      &Reading::min_angle },
+    { "vibration",      &Reading::vibration },
+    { "max_vibration",  &Reading::max_vibration },
+  };
+
+  memset(&r, 0, sizeof(r));
+  bool havePacket = false;
+  JsonScanner scan(json, len);
+  JsonToken key, value;
+  while (scan.next(key, value)) {
+    // Counters are uint32; long is only 32 bits on the device
+    uint64_t u;
+    if (key.equals("pkt") && value.toUInt64(u)) {
+      packet = (uint32_t)u;
+      havePacket = true;
+    } else if (key.equals("seq") && value.toUInt64(u)) {
+      r.seq = (uint32_t)u;
+    } else if (key.equals("t_ms") && value.toUInt64(u)) {
+      r.t_ms = (uint32_t)u;
+    } else if (key.equals("rotations") && value.toUInt64(u)) {
+      r.rotations = (uint32_t)u;
+    } else if (key.equals("utc_ms")) {
+      value.toUInt64(r.utc_ms);
+    } else if (key.equals("job")) {
+      value.copyTo(r.job, sizeof(r.job));
+    } else {
+      for (const FloatKey& k : FLOAT_KEYS) {
+        if (key.equals(k.name)) {
+          value.toFloat(r.*k.field);
+          break;
+        }
+      }
+    }
+  }
+  return havePacket && !scan.error();
+}
+
+bool decodeTelemetry(const uint8_t* in, size_t len, uint32_t& packet, Reading& r) {
+  if (len > 0 && in[0] == '{') return decodeJson((const char*)in, len, packet, r);
+
+  TelemetryHeader h;
+  if (len < sizeof(h)) return false;
+  memcpy(&h, in, sizeof(h));
+  if (h.magic[0] != 'S' || h.magic[1] != 'R' || h.version < 1 || h.format != TELEMETRY_PACKED) {
+    return false;
+  }
+  packet = h.packet;
+  return decodeReadingPacket(in + sizeof(h), len - sizeof(h), r) > 0;
+}
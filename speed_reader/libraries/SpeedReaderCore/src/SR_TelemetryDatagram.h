@@ -0,0 +1,43 @@
+#ifndef SR_TELEMETRY_DATAGRAM_H
+#define SR_TELEMETRY_DATAGRAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SR_Reading.h"
+
+// ===== UDP telemetry datagrams =====
+// One reading per datagram, in one of two formats:
+//
+//   JSON:   {"pkt":N,"seq":S,"t_ms":T,...same members as /readings...}
+//   packed: TelemetryHeader followed by a ReadingPacket (SR_ReadingCodec.h)
+//
+// `pkt` counts datagrams sent by the device since boot, independent of
+// the reading seq (which skips when the send interval is longer than the
+// publish interval), so a receiver can count lost datagrams exactly.
+//
+// No Arduino dependencies; tools/sr_udp_recv.cpp links the same code.
+
+enum TelemetryFormat : uint8_t {
+  TELEMETRY_JSON = 0,
+  TELEMETRY_PACKED = 1
+};
+
+const uint8_t TELEMETRY_VERSION = 1;
+
+struct __attribute__((packed)) TelemetryHeader {
+  uint8_t magic[2];     // "SR"
+  uint8_t version;
+  uint8_t format;       // TELEMETRY_PACKED
+  uint32_t packet;      // little-endian
+};
+
+const size_t TELEMETRY_MAX_DATAGRAM = 384;
+
+// Returns the datagram length, or 0 if `cap` is too small
+size_t encodeTelemetry(const Reading& r, uint32_t packet, TelemetryFormat format,
+                       uint8_t* out, size_t cap);
+
+// Accepts either format; false if the datagram is malformed
+bool decodeTelemetry(const uint8_t* in, size_t len, uint32_t& packet, Reading& r);
+
+#endif // SR_TELEMETRY_DATAGRAM_H
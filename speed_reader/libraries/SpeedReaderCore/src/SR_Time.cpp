@@ -0,0 +1,101 @@
+#include "SR_Time.h"
+#include <esp_timer.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
+#include "globals.h"
+#include "SR_SessionLog.h"
+#include "SR_Worker.h"
+#include "SR_Log.h"
+
+// Drift is only re-estimated from syncs at least this far apart, and from
+// corrections small enough to be drift rather than a step (first sync,
+// server change, a manual clock set)
+static const uint64_t driftMinIntervalUs = 60000000ULL;
+static const int64_t driftMaxOffsetUs = 1000000;
+static const int32_t driftMaxPpb = 500000;   // 500 ppm, well past any crystal
+
+static uint64_t anchorMonoUs = 0;
+static int64_t anchorUtcUs = 0;
+static TimeStats stats;
+static portMUX_TYPE timeMux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool started = false;
+static char activeServer[sizeof(ntpServer)] = "";
+static int activeIntervalS = 0;
+
+uint64_t monoUs() {
+  return (uint64_t)esp_timer_get_time();
+}
+
+// Caller holds timeMux
+static int64_t predictUtcUs(uint64_t mono) {
+  int64_t elapsedUs = (int64_t)(mono - anchorMonoUs);
+  // In ms * ppb so long gaps between syncs cannot overflow
+  return anchorUtcUs + elapsedUs + (elapsedUs / 1000) * stats.driftPpb / 1000000;
+}
+
+uint64_t utcMs() {
+  uint64_t mono = monoUs();
+  portENTER_CRITICAL(&timeMux);
+  int64_t utc = stats.synced ? predictUtcUs(mono) : 0;
+  portEXIT_CRITICAL(&timeMux);
+  return utc > 0 ? (uint64_t)utc / 1000 : 0;
+}
+
+bool timeSynced() {
+  portENTER_CRITICAL(&timeMux);
+  bool synced = stats.synced;
+  portEXIT_CRITICAL(&timeMux);
+  return synced;
+}
+
+void getTimeStats(TimeStats& out) {
+  portENTER_CRITICAL(&timeMux);
+  out = stats;
+  portEXIT_CRITICAL(&timeMux);
+}
+
+// ===== SNTP =====
+// Runs in the lwIP task with the time SNTP has just set
+static void onTimeSync(struct timeval* tv) {
+  uint64_t mono = monoUs();
+  int64_t utc = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+
+  portENTER_CRITICAL(&timeMux);
+  int64_t offset = 0;
+  if (stats.synced) {
+    offset = utc - predictUtcUs(mono);
+    uint64_t elapsed = mono - anchorMonoUs;
+    if (elapsed >= driftMinIntervalUs && offset > -driftMaxOffsetUs && offset < driftMaxOffsetUs) {
+      int64_t drift = stats.driftPpb + offset * 1000000000LL / (int64_t)elapsed;
+      if (drift > driftMaxPpb) drift = driftMaxPpb;
+      if (drift < -driftMaxPpb) drift = -driftMaxPpb;
+      stats.driftPpb = (int32_t)drift;
+    }
+  }
+  anchorMonoUs = mono;
+  anchorUtcUs = utc;
+  stats.synced = true;
+  stats.syncs++;
+  stats.lastOffsetUs = offset;
+  stats.lastSyncUs = mono;
+  portEXIT_CRITICAL(&timeMux);
+
+  // A new anchor for the session log; flash work stays off the lwIP task
+  runDeferred([](void*) { sessionLogTimeAnchor(); });
+}
+
+void startTimeSync() {
+  if (ntpServer[0] == '\0') return;
+  if (started && strcmp(activeServer, ntpServer) == 0 && activeIntervalS == ntpIntervalS) return;
+
+  strcpy(activeServer, ntpServer);
+  activeIntervalS = ntpIntervalS;
+  started = true;
+
+  sntp_set_time_sync_notification_cb(onTimeSync);
+  sntp_set_sync_interval((uint32_t)activeIntervalS * 1000);
+  // UTC only; the server name must outlive SNTP, so it is the static copy
+  configTime(0, 0, activeServer);
+  LOG_I("Time", "SNTP %s every %d s", activeServer, activeIntervalS);
+}
@@ -0,0 +1,35 @@
+#ifndef SR_TIME_H
+#define SR_TIME_H
+
+#include <Arduino.h>
+
+// ===== Timebase =====
+// monoUs() is esp_timer's 64-bit microsecond counter: monotonic from boot
+// and never wraps, unlike millis(). Wall-clock time is derived from it:
+// every SNTP sync records an anchor (mono, UTC) pair, and utcMs() is the
+// anchor plus the monotonic time since, corrected by the drift measured
+// between the last two syncs. A sync therefore never moves a timestamp by
+// more than the error accumulated since the previous one, and readings
+// taken between syncs stay evenly spaced.
+//
+// Until the first sync utcMs() returns 0; consumers treat that as "no
+// wall clock" and fall back to t_ms.
+
+struct TimeStats {
+  bool synced;
+  uint32_t syncs;
+  int64_t lastOffsetUs;   // correction applied at the last sync (UTC - predicted)
+  int32_t driftPpb;       // local clock error, + = running slow
+  uint64_t lastSyncUs;    // monoUs() of the last sync
+};
+
+// Starts SNTP against ntp_server every ntp_interval_s. Called again after
+// a /config change; restarts SNTP only if either setting changed.
+void startTimeSync();
+
+uint64_t monoUs();
+uint64_t utcMs();          // 0 until the first sync
+bool timeSynced();
+void getTimeStats(TimeStats& out);
+
+#endif // SR_TIME_H
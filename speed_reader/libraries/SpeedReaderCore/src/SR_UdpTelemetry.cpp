@@ -0,0 +1,73 @@
+#include "SR_UdpTelemetry.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "globals.h"
+#include "SR_Readings.h"
+#include "SR_TelemetryDatagram.h"
+#include "SR_ConfigStore.h"
+#include "SR_Log.h"
+
+static TaskHandle_t udpTaskHandle = NULL;
+
+static void udpTelemetryTask(void* parameter) {
+  WiFiUDP udp;
+  uint8_t datagram[TELEMETRY_MAX_DATAGRAM];
+  uint32_t packet = 0;
+  uint32_t lastSeq = 0;
+  unsigned long lastSendMs = 0;
+  unsigned long lastErrorLogMs = 0;
+  uint32_t failures = 0;
+
+  char address[sizeof(udpAddress)];
+  char parsedAddress[sizeof(udpAddress)] = "";
+  IPAddress target;
+  bool targetValid = false;
+
+  subscribeReadings(xTaskGetCurrentTaskHandle());
+
+  while (true) {
+    // Woken by each published reading
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+    unsigned long now = millis();
+    if (WiFi.status() != WL_CONNECTED || now - lastSendMs < (unsigned long)udpIntervalMs) continue;
+
+    uint32_t seq = latestReadingSeq();
+    Reading r;
+    if (seq == lastSeq || !getReading(seq, r)) continue;
+
+    copyConfigString(address, udpAddress, sizeof(address));
+    if (strcmp(parsedAddress, address) != 0) {
+      strcpy(parsedAddress, address);
+      targetValid = target.fromString(parsedAddress);
+      if (!targetValid) LOG_E("UDP", "invalid udp_address '%s'", parsedAddress);
+    }
+    if (!targetValid) continue;
+
+    size_t len = encodeTelemetry(r, packet + 1, udpBinary ? TELEMETRY_PACKED : TELEMETRY_JSON,
+                                 datagram, sizeof(datagram));
+    if (len == 0) continue;
+
+    if (udp.beginPacket(target, udpPort) && udp.write(datagram, len) == len && udp.endPacket()) {
+      packet++;
+    } else {
+      failures++;
+      if (now - lastErrorLogMs > 10000) {
+        LOG_W("UDP", "send failed (%lu so far)", (unsigned long)failures);
+        lastErrorLogMs = now;
+      }
+    }
+    lastSeq = seq;
+    lastSendMs = now;
+  }
+}
+
+void startUdpTelemetry() {
+  if (!udpEnabled || udpTaskHandle) return;
+  char address[sizeof(udpAddress)];
+  copyConfigString(address, udpAddress, sizeof(address));
+
+  xTaskCreatePinnedToCore(udpTelemetryTask, "UdpTelemetry", 4096, NULL, 1, &udpTaskHandle, 0);
+  LOG_I("UDP", "UDP telemetry to %s:%d every %d ms (%s)",
+        address, udpPort, udpIntervalMs, udpBinary ? "binary" : "json");
+}
@@ -0,0 +1,17 @@
+#ifndef SR_UDP_TELEMETRY_H
+#define SR_UDP_TELEMETRY_H
+
+#include <Arduino.h>
+
+// ===== UDP telemetry publisher =====
+// Sends the latest reading as one datagram (SR_TelemetryDatagram.h) to
+// udp_address:udp_port every udp_interval_ms. The address can be a
+// multicast group (LAN only, TTL 1) or a broadcast address, so any number
+// of dashboards and loggers can listen for the cost of a single send.
+//
+// udp_enabled is read at boot; address, port, interval and format
+// (udp_binary) apply to the next datagram after a /config change.
+
+void startUdpTelemetry();
+
+#endif // SR_UDP_TELEMETRY_H
@@ -0,0 +1,348 @@
+#include "SR_Uploader.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <SPIFFS.h>
+#include <esp_random.h>
+#include "globals.h"
+#include "SR_Readings.h"
+#include "SR_ReadingCodec.h"
+#include "SR_JsonWriter.h"
+#include "SR_ConfigStore.h"
+#include "SR_Log.h"
+
+// One queued reading. Also the record layout of the spill file.
+struct __attribute__((packed)) UploadRecord {
+  uint32_t boot;
+  ReadingPacket packet;
+};
+
+// Spill file: header, then records. readOffset is where the oldest unsent
+// record starts; it is advanced in place as batches are acknowledged.
+// The magic changes with the record layout, so a queue written by older
+// firmware is discarded rather than misread.
+static const char* SPILL_PATH = "/upload.q";
+static const uint32_t SPILL_MAGIC = 0x32555253;   // "SRU2": packet with utc_ms
+
+struct __attribute__((packed)) SpillHeader {
+  uint32_t magic;
+  uint32_t readOffset;
+};
+
+static const size_t UPLOAD_BODY_SIZE = 6144;
+
+static UploadRecord ramQueue[uploadRamRecords];
+static size_t ramHead = 0;
+static size_t ramCount = 0;
+static portMUX_TYPE queueMux = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t uploaderTaskHandle = NULL;
+static uint32_t bootId = 0;
+static uint32_t lastQueuedSeq = 0;
+static volatile bool resumeRequested = false;
+static unsigned long lastSampleMs = 0;
+
+static UploadStats stats;
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Only the uploader task touches these
+static uint32_t spillRecords = 0;
+static UploadRecord batch[uploadBatchMax];
+static char body[UPLOAD_BODY_SIZE];
+
+// ===== RAM queue =====
+void uploadTick(unsigned long now) {
+  if (!uploaderTaskHandle || now - lastSampleMs < (unsigned long)uploadSampleMs) return;
+  lastSampleMs = now;
+
+  uint32_t seq = latestReadingSeq();
+  Reading r;
+  if (seq == 0 || seq == lastQueuedSeq || !getReading(seq, r)) return;
+  lastQueuedSeq = seq;
+
+  UploadRecord rec;
+  rec.boot = bootId;
+  encodeReadingPacket(r, (uint8_t*)&rec.packet, sizeof(rec.packet));
+
+  portENTER_CRITICAL(&queueMux);
+  bool full = ramCount == uploadRamRecords;
+  if (!full) {
+    ramQueue[(ramHead + ramCount) % uploadRamRecords] = rec;
+    ramCount++;
+  }
+  portEXIT_CRITICAL(&queueMux);
+
+  if (full) {
+    portENTER_CRITICAL(&statsMux);
+    stats.dropped++;
+    portEXIT_CRITICAL(&statsMux);
+  }
+}
+
+// Copies up to `max` of the oldest queued records without removing them
+static size_t peekRam(UploadRecord* out, size_t max) {
+  portENTER_CRITICAL(&queueMux);
+  size_t n = ramCount < max ? ramCount : max;
+  for (size_t i = 0; i < n; i++) out[i] = ramQueue[(ramHead + i) % uploadRamRecords];
+  portEXIT_CRITICAL(&queueMux);
+  return n;
+}
+
+static void popRam(size_t n) {
+  portENTER_CRITICAL(&queueMux);
+  if (n > ramCount) n = ramCount;
+  ramHead = (ramHead + n) % uploadRamRecords;
+  ramCount -= n;
+  portEXIT_CRITICAL(&queueMux);
+}
+
+static size_t ramQueued() {
+  portENTER_CRITICAL(&queueMux);
+  size_t n = ramCount;
+  portEXIT_CRITICAL(&queueMux);
+  return n;
+}
+
+// ===== Flash queue =====
+static bool readSpillHeader(File& f, SpillHeader& h) {
+  return f.seek(0) && f.read((uint8_t*)&h, sizeof(h)) == sizeof(h) && h.magic == SPILL_MAGIC &&
+         h.readOffset >= sizeof(h) && h.readOffset <= f.size();
+}
+
+static void openSpillQueue() {
+  spillRecords = 0;
+  if (!SPIFFS.exists(SPILL_PATH)) return;
+
+  File f = SPIFFS.open(SPILL_PATH, FILE_READ);
+  SpillHeader h;
+  bool valid = f && readSpillHeader(f, h);
+  if (valid) spillRecords = (f.size() - h.readOffset) / sizeof(UploadRecord);
+  f.close();
+
+  if (!valid || spillRecords == 0) {
+    SPIFFS.remove(SPILL_PATH);
+    spillRecords = 0;
+  } else {
+    LOG_I("Upload", "%lu readings queued in flash", (unsigned long)spillRecords);
+  }
+}
+
+// Moves the oldest RAM records to the spill file
+static void spillRam(size_t n) {
+  File f = SPIFFS.open(SPILL_PATH, FILE_APPEND);
+  if (!f) return;
+  size_t size = f.size();
+  if (size == 0) {
+    SpillHeader h = { SPILL_MAGIC, sizeof(SpillHeader) };
+    size += f.write((const uint8_t*)&h, sizeof(h));
+  }
+
+  size_t moved = 0;
+  UploadRecord rec;
+  while (moved < n && peekRam(&rec, 1) == 1) {
+    if (size + sizeof(rec) > uploadSpillMaxBytes) break;
+    if (f.write((const uint8_t*)&rec, sizeof(rec)) != sizeof(rec)) break;
+    size += sizeof(rec);
+    popRam(1);
+    moved++;
+  }
+  f.close();
+  spillRecords += moved;
+
+  // Flash queue full: drop the oldest in RAM so new readings keep flowing
+  if (moved < n) {
+    popRam(n - moved);
+    portENTER_CRITICAL(&statsMux);
+    stats.dropped += n - moved;
+    portEXIT_CRITICAL(&statsMux);
+  }
+}
+
+static size_t readSpill(UploadRecord* out, size_t max) {
+  File f = SPIFFS.open(SPILL_PATH, FILE_READ);
+  SpillHeader h;
+  if (!f || !readSpillHeader(f, h)) {
+    LOG_W("Upload", "flash queue unreadable, discarding it");
+    f.close();
+    SPIFFS.remove(SPILL_PATH);
+    spillRecords = 0;
+    return 0;
+  }
+  f.seek(h.readOffset);
+  size_t n = f.read((uint8_t*)out, max * sizeof(UploadRecord)) / sizeof(UploadRecord);
+  f.close();
+  return n;
+}
+
+static void ackSpill(size_t n) {
+  spillRecords = n < spillRecords ? spillRecords - n : 0;
+  if (spillRecords == 0) {
+    SPIFFS.remove(SPILL_PATH);
+    return;
+  }
+  File f = SPIFFS.open(SPILL_PATH, "r+");
+  SpillHeader h;
+  if (!f || !readSpillHeader(f, h)) return;
+  h.readOffset += n * sizeof(UploadRecord);
+  f.seek(0);
+  f.write((const uint8_t*)&h, sizeof(h));
+  f.close();
+}
+
+// ===== Sending =====
+static size_t formatBatch(const UploadRecord* recs, size_t n) {
+  JsonWriter w(body, sizeof(body));
+  w.beginObject();
+  w.field("device", deviceName);
+  w.field("station", station);
+  w.field("boot", (unsigned long)recs[0].boot);
+  w.key("readings").beginArray();
+  for (size_t i = 0; i < n; i++) {
+    Reading r;
+    if (!decodeReadingPacket((const uint8_t*)&recs[i].packet, sizeof(recs[i].packet), r)) continue;
+    w.beginObject();
+    w.field("seq", (unsigned long)r.seq);
+    w.field("t_ms", (unsigned long)r.t_ms);
+    writeReadingFields(w, r);
+    w.endObject();
+  }
+  w.endArray();
+  w.endObject();
+  return w.overflow() ? 0 : w.length();
+}
+
+static int postBatch(const char* url, size_t len) {
+  HTTPClient http;
+  http.setConnectTimeout(uploadTimeoutMs);
+  http.setTimeout(uploadTimeoutMs);
+  if (!http.begin(url)) return HTTPC_ERROR_CONNECTION_REFUSED;
+  http.addHeader("Content-Type", "application/json");
+  int code = http.POST((uint8_t*)body, len);
+  http.end();
+  return code;
+}
+
+// Sends the oldest queued readings. Returns false if the attempt failed
+// and should be retried after a backoff.
+static bool uploadBatch(const char* url) {
+  bool fromFlash = spillRecords > 0;
+  size_t n = fromFlash ? readSpill(batch, uploadBatchMax) : peekRam(batch, uploadBatchMax);
+  if (n == 0) return true;
+
+  // One boot per batch, so the collector sees a single dedup key prefix
+  size_t sameBoot = 1;
+  while (sameBoot < n && batch[sameBoot].boot == batch[0].boot) sameBoot++;
+  n = sameBoot;
+
+  size_t len = formatBatch(batch, n);
+  while (len == 0 && n > 1) {
+    n /= 2;
+    len = formatBatch(batch, n);
+  }
+
+  int code = postBatch(url, len);
+  bool ok = code >= 200 && code < 300;
+  // The collector will never take this payload; retrying would block the queue
+  bool refused = code == 400 || code == 413 || code == 422;
+
+  if (ok || refused) {
+    if (fromFlash) ackSpill(n); else popRam(n);
+  }
+
+  portENTER_CRITICAL(&statsMux);
+  stats.lastStatus = code;
+  if (ok) {
+    stats.uploaded += n;
+    stats.batches++;
+  } else if (refused) {
+    stats.rejected += n;
+  } else {
+    stats.failures++;
+  }
+  portEXIT_CRITICAL(&statsMux);
+
+  if (!ok) {
+    LOG_W("Upload", "POST %s failed (%d), %s", url, code,
+          refused ? "batch dropped" : "will retry");
+  }
+  return ok || refused;
+}
+
+static unsigned long nextBackoff(unsigned long current) {
+  unsigned long next = current ? current * 2 : uploadBackoffMinMs;
+  if (next > uploadBackoffMaxMs) next = uploadBackoffMaxMs;
+  // +-25% jitter so a fleet does not retry in lockstep after an outage
+  return next - next / 4 + esp_random() % (next / 2 + 1);
+}
+
+static void uploaderTask(void* parameter) {
+  unsigned long nextAttemptMs = millis() + uploadBatchMs;
+  unsigned long backoffMs = 0;
+  char url[sizeof(uploadUrl)];
+
+  openSpillQueue();
+
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(250));
+
+    size_t queued = ramQueued();
+    if (queued > uploadRamRecords * 3 / 4) spillRam(queued - uploadRamRecords / 4);
+
+    queued = ramQueued();
+    portENTER_CRITICAL(&statsMux);
+    stats.queuedRam = queued;
+    stats.queuedFlash = spillRecords;
+    stats.backoffMs = backoffMs;
+    portEXIT_CRITICAL(&statsMux);
+
+    unsigned long now = millis();
+    if (resumeRequested) {
+      // Back on the network: retry soon, jittered like the backoff
+      resumeRequested = false;
+      backoffMs = 0;
+      nextAttemptMs = now + esp_random() % uploadBackoffMinMs;
+    }
+    if ((long)(now - nextAttemptMs) < 0) continue;
+    copyConfigString(url, uploadUrl, sizeof(url));
+    if (url[0] == '\0' || WiFi.status() != WL_CONNECTED) {
+      nextAttemptMs = now + uploadBatchMs;
+      continue;
+    }
+    if (spillRecords == 0 && queued == 0) {
+      nextAttemptMs = now + uploadBatchMs;
+      continue;
+    }
+
+    if (uploadBatch(url)) {
+      backoffMs = 0;
+      // Catch up on a backlog without waiting a full interval per batch
+      bool backlog = spillRecords > 0 || ramQueued() >= uploadBatchMax;
+      nextAttemptMs = millis() + (backlog ? 0 : uploadBatchMs);
+    } else {
+      backoffMs = nextBackoff(backoffMs);
+      nextAttemptMs = millis() + backoffMs;
+    }
+  }
+}
+
+void startUploader() {
+  char url[sizeof(uploadUrl)];
+  copyConfigString(url, uploadUrl, sizeof(url));
+  if (url[0] == '\0' || uploaderTaskHandle) return;
+
+  bootId = esp_random();
+  xTaskCreatePinnedToCore(uploaderTask, "Uploader", uploaderTaskStack, NULL, 1, &uploaderTaskHandle, 0);
+  LOG_I("Upload", "Uploading to %s: a reading every %d ms, batches every %d ms",
+        url, uploadSampleMs, uploadBatchMs);
+}
+
+void resumeUploads() {
+  resumeRequested = true;
+}
+
+bool getUploadStats(UploadStats& out) {
+  if (!uploaderTaskHandle) return false;
+  portENTER_CRITICAL(&statsMux);
+  out = stats;
+  portEXIT_CRITICAL(&statsMux);
+  return true;
+}
@@ -0,0 +1,51 @@
+#ifndef SR_UPLOADER_H
+#define SR_UPLOADER_H
+
+#include <Arduino.h>
+
+// ===== Collector uploads =====
+// Pushes readings to a central collector so it does not have to poll each
+// device. The sensor task queues one reading every upload_sample_ms into a
+// RAM ring; the uploader task POSTs them in batches to upload_url every
+// upload_batch_ms:
+//
+//   {"device":"SensorNode-01","station":"Station-01","boot":2866519142,
+//    "readings":[{"seq":812,"t_ms":40600,...same members as /readings...},...]}
+//
+// Any 2xx response acknowledges the whole batch. While the collector (or
+// WiFi) is unreachable the queue keeps filling; when the RAM ring is three
+// quarters full the oldest readings are moved to a queue file on SPIFFS,
+// which is sent first once the collector is back. Failed attempts back off
+// exponentially from uploadBackoffMinMs to uploadBackoffMaxMs.
+//
+// A batch that timed out may still have been stored, and readings already
+// sent are sent again after a reboot, so the collector must deduplicate on
+// (device, boot, seq). `boot` is random per boot; seq only increases.
+//
+// upload_url is read at boot; a changed URL or interval applies to the
+// next batch.
+
+struct UploadStats {
+  uint32_t uploaded;      // readings acknowledged
+  uint32_t batches;
+  uint32_t failures;      // attempts that failed and will be retried
+  uint32_t rejected;      // readings dropped after a 400/413/422
+  uint32_t dropped;       // readings lost to a full queue
+  uint32_t queuedRam;
+  uint32_t queuedFlash;
+  uint32_t backoffMs;     // current retry delay, 0 when healthy
+  int lastStatus;         // HTTP status or HTTPClient error of the last attempt
+};
+
+void startUploader();
+
+// Sensor task: queues the latest published reading every upload_sample_ms
+void uploadTick(unsigned long now);
+
+// WiFi manager, on every connect: drops the backoff so the queue starts
+// draining within uploadBackoffMinMs
+void resumeUploads();
+
+bool getUploadStats(UploadStats& out);
+
+#endif // SR_UPLOADER_H
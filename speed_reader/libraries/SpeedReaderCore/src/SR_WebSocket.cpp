@@ -0,0 +1,226 @@
+#include "SR_WebSocket.h"
+
+#if ENABLE_HTTP
+#include <WebsocketHandler.hpp>
+#include <WebsocketNode.hpp>
+#include "SR_Json.h"
+#include "SR_JsonWriter.h"
+#include "SR_Readings.h"
+#include "SR_Session.h"
+#include "SR_Log.h"
+#include "SR_ServerTask.h"
+
+static const size_t WS_MAX_MESSAGE = 128;
+
+// Everything below runs on the main server task: handlers are created,
+// polled and deleted there, so the slot table needs no lock
+class ReadingSocket;
+static ReadingSocket* sockets[wsMaxClients];
+
+class ReadingSocket : public WebsocketHandler {
+public:
+  ReadingSocket() {
+    for (int i = 0; i < wsMaxClients; i++) {
+      if (!sockets[i]) {
+        sockets[i] = this;
+        break;
+      }
+    }
+  }
+
+  ~ReadingSocket() {
+    for (int i = 0; i < wsMaxClients; i++) {
+      if (sockets[i] == this) sockets[i] = NULL;
+    }
+  }
+
+  void onMessage(WebsocketInputStreambuf* input) override;
+  void onError(std::string error) override {
+    LOG_W("WS", "WebSocket error: %s", error.c_str());
+  }
+
+  void poll(unsigned long now);
+
+private:
+  void reply(const char* json, JsonWriter& w);
+  void replyError(const char* message);
+  void sendReading(const uint8_t* data, size_t len, uint8_t type);
+
+  uint32_t _intervalMs = wsDefaultIntervalMs;
+  uint32_t _backoffMs = 0;
+  ReadingFormat _format = READING_PACKED;
+  uint32_t _lastSeq = 0;
+  unsigned long _lastSendMs = 0;
+};
+
+// ===== Commands =====
+void ReadingSocket::replyError(const char* message) {
+  char out[96];
+  JsonWriter w(out, sizeof(out));
+  w.beginObject().field("ok", false).field("error", message).endObject();
+  reply(out, w);
+}
+
+void ReadingSocket::reply(const char* json, JsonWriter& w) {
+  w.flush();
+  if (!w.overflow()) send((uint8_t*)json, (uint16_t)w.length(), SEND_TYPE_TEXT);
+}
+
+void ReadingSocket::onMessage(WebsocketInputStreambuf* input) {
+  char msg[WS_MAX_MESSAGE];
+  std::streamsize len = input->sgetn(msg, sizeof(msg));
+  if (len >= (std::streamsize)sizeof(msg)) {
+    // Drain the rest of the frame
+    while (input->sgetn(msg, sizeof(msg)) > 0) {}
+    replyError("Message too long");
+    return;
+  }
+
+  char cmd[16] = "";
+  char job[sizeof(currentJob)] = "";
+  bool jobTooLong = false;
+  long interval = -1;
+  char format[8] = "";
+
+  JsonScanner scan(msg, (size_t)len);
+  JsonToken key, value;
+  while (scan.next(key, value)) {
+    if (key.equals("cmd")) value.copyTo(cmd, sizeof(cmd));
+    else if (key.equals("job")) jobTooLong = !value.copyTo(job, sizeof(job));
+    else if (key.equals("interval_ms")) value.toLong(interval);
+    else if (key.equals("format")) value.copyTo(format, sizeof(format));
+  }
+  if (scan.error() || cmd[0] == '\0') {
+    replyError("Expected {\"cmd\":...}");
+    return;
+  }
+
+  char out[160];
+  JsonWriter w(out, sizeof(out));
+  if (strcmp(cmd, "start") == 0) {
+    if (jobTooLong || job[0] == '\0') {
+      replyError(jobTooLong ? "Job name too long (max 31 chars)" : "Missing 'job'");
+      return;
+    }
+    startSession(job);
+    w.beginObject().field("ok", true).field("cmd", cmd).field("job", job).endObject();
+  } else if (strcmp(cmd, "end") == 0) {
+    bool wasActive = sessionActive;
+    if (wasActive) endSession();
+    w.beginObject().field("ok", true).field("cmd", cmd).field("was_active", wasActive).endObject();
+  } else if (strcmp(cmd, "reset") == 0) {
+    resetSession();
+    w.beginObject().field("ok", true).field("cmd", cmd).endObject();
+  } else if (strcmp(cmd, "rate") == 0) {
+    if (interval >= 0) {
+      if (interval > 60000) {
+        replyError("interval_ms must be 0 to 60000");
+        return;
+      }
+      _intervalMs = (uint32_t)interval;
+      if (_intervalMs && _intervalMs < publishIntervalMs) _intervalMs = publishIntervalMs;
+      _backoffMs = 0;
+    }
+    if (format[0]) {
+      if (strcmp(format, "packed") == 0) _format = READING_PACKED;
+      else if (strcmp(format, "cbor") == 0) _format = READING_CBOR;
+      else if (strcmp(format, "json") == 0) _format = READING_JSON;
+      else {
+        replyError("format must be packed, cbor or json");
+        return;
+      }
+    }
+    static const char* FORMAT_NAMES[] = { "json", "cbor", "packed" };
+    w.beginObject().field("ok", true).field("cmd", cmd)
+     .field("interval_ms", (unsigned long)_intervalMs)
+     .field("format", FORMAT_NAMES[_format]).endObject();
+  } else {
+    replyError("Unknown cmd");
+    return;
+  }
+  reply(out, w);
+}
+
+// ===== Readings =====
+// A reading is only written if the socket can take it right away; with a
+// full socket buffer it is skipped, so a peer that stopped reading never
+// holds up the server task. Replies to commands are always written.
+void ReadingSocket::sendReading(const uint8_t* data, size_t len, uint8_t type) {
+  unsigned long start = millis();
+  bool skipped;
+  {
+    SkippableWrite write;
+    WebsocketHandler::send((uint8_t*)data, (uint16_t)len, type);
+    skipped = write.skipped();
+  }
+  unsigned long took = millis() - start;
+
+  // A skipped or slow write means the socket buffer is full; back off
+  // instead of trying again every interval
+  if (skipped || took >= wsSlowSendMs) {
+    uint32_t base = _backoffMs > _intervalMs ? _backoffMs : _intervalMs;
+    if (base < publishIntervalMs) base = publishIntervalMs;
+    _backoffMs = base * 2 > wsMaxBackoffMs ? wsMaxBackoffMs : base * 2;
+  } else if (_backoffMs) {
+    _backoffMs /= 2;
+    if (_backoffMs <= _intervalMs) _backoffMs = 0;
+  }
+}
+
+void ReadingSocket::poll(unsigned long now) {
+  if (closed() || _intervalMs == 0) return;
+  if (now - _lastSendMs < (_backoffMs > _intervalMs ? _backoffMs : _intervalMs)) return;
+
+  // Pre-rendered by the sensor task; whatever was published in between
+  // is skipped, never queued
+  uint8_t buf[READING_RENDER_MAX];
+  uint32_t seq = 0;
+  size_t len = readRenderedReading(_format, buf, sizeof(buf), &seq);
+  if (len == 0 || seq == _lastSeq) return;
+
+  _lastSeq = seq;
+  _lastSendMs = now;
+  sendReading(buf, len, _format == READING_JSON ? SEND_TYPE_TEXT : SEND_TYPE_BINARY);
+}
+
+// ===== Registration =====
+static WebsocketHandler* createReadingSocket() {
+  return new ReadingSocket();
+}
+
+static int openSockets() {
+  int open = 0;
+  for (int i = 0; i < wsMaxClients; i++) {
+    if (sockets[i]) open++;
+  }
+  return open;
+}
+
+bool isWebSocketUpgrade(HTTPRequest* req) {
+  std::string path = req->getRequestString();
+  return path.compare(0, 3, "/ws") == 0 && (path.size() == 3 || path[3] == '?');
+}
+
+static void middlewareWebSocket(HTTPRequest* req, HTTPResponse* res, std::function<void()> next) {
+  if (isWebSocketUpgrade(req) && openSockets() >= wsMaxClients) {
+    res->setStatusCode(503);
+    res->setHeader("Content-Type", "application/json");
+    res->print("{\"error\":\"Too many WebSocket clients\"}");
+    return;
+  }
+  next();
+}
+
+void registerWebSocket(HTTPServer* srv) {
+  srv->addMiddleware(&middlewareWebSocket);
+  srv->registerNode(new WebsocketNode("/ws", &createReadingSocket));
+}
+
+void pollWebSockets() {
+  unsigned long now = millis();
+  for (int i = 0; i < wsMaxClients; i++) {
+    if (sockets[i]) sockets[i]->poll(now);
+  }
+}
+
+#endif // ENABLE_HTTP
@@ -0,0 +1,46 @@
+#ifndef SR_WEB_SOCKET_H
+#define SR_WEB_SOCKET_H
+
+#include "globals.h"
+
+#if ENABLE_HTTP
+#include <HTTPServer.hpp>
+#include <HTTPRequest.hpp>
+#include <HTTPResponse.hpp>
+#include <functional>
+
+using namespace httpsserver;
+
+// ===== WebSocket /ws =====
+// One connection on the main server for both control and live readings,
+// instead of POST /start plus polling /readings. The upgrade request is
+// authenticated once, with the X-API-Key header or ?key= (browsers cannot
+// set headers on a WebSocket).
+//
+// Client -> device, text frames:
+//   {"cmd":"start","job":"Run_001"}
+//   {"cmd":"end"}
+//   {"cmd":"reset"}                       zero the counters and maxima
+//   {"cmd":"rate","interval_ms":200}      0 pauses readings
+//   {"cmd":"rate","format":"cbor"}        or "packed" (the default)
+// Device -> client:
+//   text   {"ok":true,"cmd":"start",...} or {"ok":false,"error":"..."}
+//   binary the latest reading, as /readings would send it in that format
+//
+// Only the latest reading is ever sent: a client that cannot keep up
+// skips readings instead of queueing them. Frames are written from the
+// server task; when a write blocks on a full socket the client's rate is
+// halved until writes are fast again.
+
+bool isWebSocketUpgrade(HTTPRequest* req);
+
+// Registers /ws and a middleware that turns upgrades away with 503 once
+// wsMaxClients are connected, so sockets cannot take every connection slot
+void registerWebSocket(HTTPServer* srv);
+
+// Called by the server task every pass of its loop
+void pollWebSockets();
+
+#endif // ENABLE_HTTP
+
+#endif // SR_WEB_SOCKET_H
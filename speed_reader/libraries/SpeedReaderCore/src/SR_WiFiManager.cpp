@@ -0,0 +1,255 @@
+#include "SR_WiFiManager.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include "globals.h"
+#include "SR_Crc.h"
+#include "SR_LCDDisplay.h"
+#include "SR_HTTPHandlers.h"
+#include "SR_EventStream.h"
+#include "SR_WiFiLoader.h"
+#include "SR_UdpTelemetry.h"
+#include "SR_Uploader.h"
+#include "SR_Events.h"
+#include "SR_Time.h"
+#include "SR_Worker.h"
+#include "SR_Log.h"
+
+// Last AP joined, for the next fast connect. Only valid for the SSID it
+// was recorded with.
+struct __attribute__((packed)) CachedAp {
+  uint32_t ssidCrc;
+  uint8_t bssid[6];
+  uint8_t channel;
+};
+
+static const char* CACHE_NAMESPACE = "speedreader";
+static const char* CACHE_KEY = "wifi_ap";
+
+// Task notification bits, set from the WiFi event handler
+static const uint32_t NOTIFY_GOT_IP = 1 << 0;
+static const uint32_t NOTIFY_DISCONNECTED = 1 << 1;
+
+enum LinkState : uint8_t { LINK_CONNECTING, LINK_CONNECTED, LINK_WAITING };
+
+static TaskHandle_t wifiTaskHandle = NULL;
+static CachedAp cachedAp;
+static bool haveCachedAp = false;
+static volatile uint8_t lastReason = 0;
+
+static WiFiStats stats;
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ===== AP cache =====
+static uint32_t ssidCrc() {
+  return srCrc32((const uint8_t*)wifiSSID, strlen(wifiSSID));
+}
+
+static void loadCachedAp() {
+  Preferences prefs;
+  if (!prefs.begin(CACHE_NAMESPACE, true)) return;
+  haveCachedAp = prefs.getBytesLength(CACHE_KEY) == sizeof(cachedAp) &&
+                 prefs.getBytes(CACHE_KEY, &cachedAp, sizeof(cachedAp)) == sizeof(cachedAp) &&
+                 cachedAp.ssidCrc == ssidCrc() && cachedAp.channel > 0;
+  prefs.end();
+}
+
+// Written only when the AP changed, to spare the flash
+static void saveCachedAp() {
+  CachedAp ap;
+  ap.ssidCrc = ssidCrc();
+  memcpy(ap.bssid, WiFi.BSSID(), sizeof(ap.bssid));
+  ap.channel = (uint8_t)WiFi.channel();
+  if (haveCachedAp && memcmp(&ap, &cachedAp, sizeof(ap)) == 0) return;
+
+  cachedAp = ap;
+  haveCachedAp = true;
+  Preferences prefs;
+  if (!prefs.begin(CACHE_NAMESPACE, false)) return;
+  prefs.putBytes(CACHE_KEY, &ap, sizeof(ap));
+  prefs.end();
+}
+
+// ===== Connecting =====
+static void applyIpConfig() {
+  IPAddress ip, gateway, subnet, dns;
+  if (wifiIp[0] && ip.fromString(wifiIp) && gateway.fromString(wifiGateway) &&
+      subnet.fromString(wifiSubnet)) {
+    if (!dns.fromString(wifiDns)) dns = gateway;
+    WiFi.config(ip, gateway, subnet, dns);
+  } else {
+    if (wifiIp[0]) LOG_W("WiFi", "incomplete static IP settings, using DHCP");
+    WiFi.config(IPAddress(), IPAddress(), IPAddress());   // DHCP
+  }
+}
+
+static void beginAttempt(bool fast) {
+  WiFi.disconnect();
+  applyIpConfig();
+  if (fast) {
+    WiFi.begin(wifiSSID, wifiPassword, cachedAp.channel, cachedAp.bssid);
+  } else {
+    WiFi.begin(wifiSSID, wifiPassword);
+  }
+}
+
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  if (!wifiTaskHandle) return;
+  // ASSOC_LEAVE is our own disconnect() before an attempt, not a failure
+  if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED &&
+      info.wifi_sta_disconnected.reason == WIFI_REASON_ASSOC_LEAVE) {
+    return;
+  }
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    xTaskNotify(wifiTaskHandle, NOTIFY_GOT_IP, eSetBits);
+  } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+    lastReason = info.wifi_sta_disconnected.reason;
+    xTaskNotify(wifiTaskHandle, NOTIFY_DISCONNECTED, eSetBits);
+  }
+}
+
+// ===== Network services =====
+static void showConnected(void*) {
+  char ipStr[20];
+  snprintf(ipStr, sizeof(ipStr), "%s", WiFi.localIP().toString().c_str());
+  updateLCD("WiFi Connected", ipStr);
+}
+
+static void startNetworkServices() {
+  #if ENABLE_HTTP
+  static bool serversStarted = false;
+  if (!serversStarted) {
+    serversStarted = true;
+    if (useHTTPS) {
+      setupHTTPSServer();
+      if (lanHTTP) setupLanServer();
+    } else {
+      setupHTTPServer();
+    }
+    startEventStream();
+  } else {
+    // Listening sockets normally survive a reconnect; reopen any that did not
+    if (server && !server->isRunning()) server->start();
+    if (lanServer && !lanServer->isRunning()) lanServer->start();
+  }
+
+  // The address may have changed
+  runDeferred([](void*) { registerDevice(); });
+  #endif
+
+  startUdpTelemetry();
+  startTimeSync();
+  resumeUploads();
+  resumeEventWebhook();
+  runDeferred(showConnected);
+}
+
+// ===== Manager task =====
+static void wifiTask(void* parameter) {
+  LinkState state = LINK_CONNECTING;
+  bool fast = haveCachedAp;
+  unsigned long attemptMs = millis();
+  unsigned long retryMs = 0;
+  unsigned long retryAtMs = 0;
+  beginAttempt(fast);
+
+  while (true) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, pdMS_TO_TICKS(250));
+    unsigned long now = millis();
+
+    if ((bits & NOTIFY_GOT_IP) && state != LINK_CONNECTED) {
+      state = LINK_CONNECTED;
+      retryMs = 0;
+      haveWiFi = true;
+      saveCachedAp();
+
+      portENTER_CRITICAL(&statsMux);
+      stats.connected = true;
+      stats.connects++;
+      if (fast) stats.fastConnects++;
+      stats.lastConnectMs = now - attemptMs;
+      if (stats.bootConnectMs == 0) stats.bootConnectMs = now;
+      portEXIT_CRITICAL(&statsMux);
+
+      LOG_I("WiFi", "connected in %lu ms (%s, %s), IP %s, RSSI %d", now - attemptMs,
+            fast ? "cached AP" : "scan", wifiIp[0] ? "static IP" : "DHCP",
+            WiFi.localIP().toString().c_str(), WiFi.RSSI());
+      startNetworkServices();
+      continue;
+    }
+
+    bool failed = false;
+    if (bits & NOTIFY_DISCONNECTED) {
+      if (state == LINK_CONNECTED) {
+        haveWiFi = false;
+        portENTER_CRITICAL(&statsMux);
+        stats.connected = false;
+        stats.disconnects++;
+        stats.lastReason = lastReason;
+        portEXIT_CRITICAL(&statsMux);
+        LOG_W("WiFi", "lost (reason %u), reconnecting", lastReason);
+
+        // Most drops are the same AP coming back; try it directly first
+        fast = haveCachedAp;
+        attemptMs = now;
+        state = LINK_CONNECTING;
+        beginAttempt(fast);
+        continue;
+      }
+      failed = state == LINK_CONNECTING;
+    }
+    if (state == LINK_CONNECTING &&
+        now - attemptMs > (fast ? wifiFastConnectTimeoutMs : wifiConnectTimeoutMs)) {
+      failed = true;
+    }
+
+    if (failed) {
+      portENTER_CRITICAL(&statsMux);
+      stats.failedAttempts++;
+      stats.lastReason = lastReason;
+      portEXIT_CRITICAL(&statsMux);
+
+      if (fast) {
+        // The AP may have moved channel or been replaced: scan straight away
+        LOG_W("WiFi", "cached AP failed (reason %u), scanning", lastReason);
+        fast = false;
+        attemptMs = now;
+        beginAttempt(false);
+      } else {
+        WiFi.disconnect();
+        retryMs = retryMs ? retryMs * 2 : wifiRetryMinMs;
+        if (retryMs > wifiRetryMaxMs) retryMs = wifiRetryMaxMs;
+        retryAtMs = now + retryMs;
+        state = LINK_WAITING;
+        LOG_W("WiFi", "connect to '%s' failed (reason %u), retry in %lu ms",
+              wifiSSID, lastReason, retryMs);
+      }
+    } else if (state == LINK_WAITING && (long)(now - retryAtMs) >= 0) {
+      fast = haveCachedAp;
+      attemptMs = now;
+      state = LINK_CONNECTING;
+      beginAttempt(fast);
+    }
+  }
+}
+
+void startWiFi() {
+  if (wifiTaskHandle) return;
+
+  WiFi.persistent(false);        // credentials live in our own NVS record
+  WiFi.mode(WIFI_STA);
+  WiFi.setHostname(deviceName);
+  WiFi.setAutoReconnect(false);  // reconnects are driven from wifiTask
+  loadCachedAp();
+
+  LOG_I("WiFi", "connecting to '%s'%s in the background", wifiSSID,
+        haveCachedAp ? " (cached AP)" : "");
+  WiFi.onEvent(onWiFiEvent);
+  xTaskCreatePinnedToCore(wifiTask, "WiFiManager", wifiTaskStack, NULL, 1, &wifiTaskHandle, 0);
+}
+
+void getWiFiStats(WiFiStats& out) {
+  portENTER_CRITICAL(&statsMux);
+  out = stats;
+  portEXIT_CRITICAL(&statsMux);
+}
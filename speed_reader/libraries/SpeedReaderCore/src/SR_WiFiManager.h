@@ -0,0 +1,32 @@
+#ifndef SR_WIFI_MANAGER_H
+#define SR_WIFI_MANAGER_H
+
+#include <Arduino.h>
+
+// ===== WiFi connection manager =====
+// Connects in the background so begin() does not wait on the network, and
+// reconnects whenever the link drops. The BSSID and channel of the last
+// AP are kept in NVS; the next attempt joins that AP directly instead of
+// scanning every channel, and falls back to a full scan if it fails. With
+// wifi_ip set the address is static and DHCP is skipped as well.
+//
+// On every connect, the first included, the manager (re)starts what needs
+// the network: the HTTP(S) servers and event stream, registration, UDP
+// telemetry and SNTP, and lets the uploader and event webhook retry at
+// once instead of waiting out their backoff.
+
+struct WiFiStats {
+  bool connected;
+  uint32_t connects;
+  uint32_t disconnects;
+  uint32_t failedAttempts;
+  uint32_t fastConnects;     // connects that used the cached BSSID/channel
+  uint32_t lastConnectMs;    // attempt start to IP, last connect
+  uint32_t bootConnectMs;    // boot to IP, first connect (0 until then)
+  uint8_t lastReason;        // wifi_err_reason_t of the last disconnect
+};
+
+void startWiFi();
+void getWiFiStats(WiFiStats& out);
+
+#endif // SR_WIFI_MANAGER_H
@@ -0,0 +1,43 @@
+#include "SR_Worker.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "SR_Log.h"
+
+struct WorkItem {
+  WorkFn fn;
+  void* arg;
+};
+
+static const int WORK_QUEUE_LENGTH = 8;
+
+static QueueHandle_t workQueue = NULL;
+static TaskHandle_t workerTaskHandle = NULL;
+
+static void workerTask(void* parameter) {
+  WorkItem item;
+  while (true) {
+    if (xQueueReceive(workQueue, &item, portMAX_DELAY) == pdTRUE) {
+      item.fn(item.arg);
+    }
+  }
+}
+
+void startWorker() {
+  if (workerTaskHandle) return;
+  workQueue = xQueueCreate(WORK_QUEUE_LENGTH, sizeof(WorkItem));
+  xTaskCreatePinnedToCore(workerTask, "Worker", 4096, NULL, 1, &workerTaskHandle, 0);
+}
+
+bool runDeferred(WorkFn fn, void* arg) {
+  if (!workQueue) {
+    fn(arg);
+    return true;
+  }
+  WorkItem item = { fn, arg };
+  if (xQueueSend(workQueue, &item, 0) != pdTRUE) {
+    LOG_W("Worker", "queue full, job dropped");
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,19 @@
+#ifndef SR_WORKER_H
+#define SR_WORKER_H
+
+#include <Arduino.h>
+
+// ===== Background worker =====
+// One low-priority task that runs slow control-plane jobs (LCD updates,
+// device registration, ...) so request handlers and the sensor task can
+// return straight away. Jobs run in submission order.
+
+typedef void (*WorkFn)(void* arg);
+
+void startWorker();
+
+// Queues fn(arg). Returns false if the queue is full. Before the worker is
+// started the job runs inline.
+bool runDeferred(WorkFn fn, void* arg = NULL);
+
+#endif // SR_WORKER_H
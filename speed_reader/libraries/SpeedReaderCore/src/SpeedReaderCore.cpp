@@ -1,6 +1,5 @@
 #include "SpeedReaderCore.h"
 #include <Arduino.h>
-#include <WiFi.h>
 #include <SPIFFS.h>
 #include <LiquidCrystal.h>
 
@@ -10,27 +9,36 @@
 #include "SR_SpeedSensor.h"
 #include "SR_WiFiLoader.h"
 #include "SR_Accelerometer.h"
-#include "SR_HTTPHandlers.h"
 #include "SR_Tasks.h"
 #include "SR_StartupCheck.h"
-
-#if ENABLE_BT
-#include <BluetoothSerial.h>
-#endif
+#include "SR_SessionLog.h"
+#include "SR_ConfigStore.h"
+#include "SR_Worker.h"
+#include "SR_Uploader.h"
+#include "SR_Events.h"
+#include "SR_WiFiManager.h"
+#include "SR_BleTelemetry.h"
+#include "SR_Profiler.h"
+#include "SR_Log.h"
+#include "SR_SerialTelemetry.h"
 
 namespace SpeedReader {
 
 void begin() {
   Serial.begin(115200);
   delay(1000);
-  Serial.println("\n\nSpeed Reader Starting (Library Mode)...");
-  
-  // Create mutexes immediately
+
+  // Create mutexes immediately; the log drain needs consoleMutex
   dataMutex = xSemaphoreCreateMutex();
   lcdMutex = xSemaphoreCreateMutex();
+  configMutex = xSemaphoreCreateMutex();
+  consoleMutex = xSemaphoreCreateMutex();
+
+  startLog();
+  LOG_I("Setup", "Speed Reader Starting (Library Mode)...");
   
   // Initialize LCD
-  Serial.println("Initializing LCD...");
+  LOG_I("Setup", "Initializing LCD...");
   
   // Pre-initialize LCD pins to known state to prevent garbage
   pinMode(LCD_RS, OUTPUT); digitalWrite(LCD_RS, LOW);
@@ -43,8 +51,7 @@ void begin() {
   // Set up contrast control via PWM
   pinMode(LCD_CONTRAST, OUTPUT);
   analogWrite(LCD_CONTRAST, LCD_CONTRAST_VALUE);
-  Serial.print("LCD contrast set to: ");
-  Serial.println(LCD_CONTRAST_VALUE);
+  LOG_I("Setup", "LCD contrast set to: %d", LCD_CONTRAST_VALUE);
   
   delay(100); // 100ms for power stabilization
   lcd.begin(16, 2);
@@ -52,8 +59,14 @@ void begin() {
   updateLCD("Initializing...", "Please wait");
   
   // Load WiFi config
-  updateLCD("Loading Config", "SPIFFS...");
+  updateLCD("Loading Config", "NVS...");
   loadWiFiConfig();
+  startConfigSaver();
+  startWorker();
+  
+  // Recover interrupted sessions and start the recorder
+  updateLCD("Session Log", "Recovering...");
+  initSessionLog();
   
   // Configure pins
   updateLCD("Configuring", "Pins...");
@@ -63,16 +76,12 @@ void begin() {
   analogReadResolution(12);
   analogSetPinAttenuation(D5_ANALOG, ADC_11db);
   
-  Serial.print("Configured Pins: D4_DIGITAL=");
-  Serial.print(D4_DIGITAL);
-  Serial.print(" (Speed), D5_ANALOG=");
-  Serial.print(D5_ANALOG);
-  Serial.println(" (Monitor)");
+  LOG_I("Setup", "Configured Pins: D4_DIGITAL=%d (Speed), D5_ANALOG=%d (Monitor)",
+        D4_DIGITAL, D5_ANALOG);
   
   // Initial read test
   int initialVal = analogRead(D5_ANALOG);
-  Serial.print("Initial Analog Read: ");
-  Serial.println(initialVal);
+  LOG_I("Setup", "Initial Analog Read: %d", initialVal);
   
   // Compute distance per rotation
   // 1 inch = 1/63360 miles
@@ -85,8 +94,7 @@ void begin() {
   // Apply configuration offset as a calibration adjustment per rotation
   distancePerRotation_miles += distanceOffset;
   
-  Serial.print("Dist/Rot (miles): ");
-  Serial.println(distancePerRotation_miles, 8);
+  LOG_I("Setup", "Dist/Rot (miles): %.8f", distancePerRotation_miles);
   
   // Startup blink
   for (int i = 0; i < 3; i++) {
@@ -106,69 +114,24 @@ void begin() {
   // Attach rotation interrupt
   attachInterrupt(digitalPinToInterrupt(D4_DIGITAL), onRotation, FALLING);
   
-  // Start Bluetooth
+  // Start the BLE telemetry service
   #if ENABLE_BT
-  Serial.print("Starting Bluetooth as '");
-  Serial.print(deviceName);
-  Serial.println("'...");
-  haveBT = SerialBT.begin(deviceName);
-  Serial.println(haveBT ? " OK" : " FAILED");
+  haveBT = startBleTelemetry();
   #endif
   
-  // Start WiFi
-  Serial.print("Attempting WiFi connect...");
+  // Start WiFi; connects in the background and brings the servers,
+  // registration and UDP telemetry up on every (re)connect
   updateLCD("Connecting WiFi", wifiSSID);
-  WiFi.mode(WIFI_STA);
-  WiFi.setHostname(deviceName);
-  WiFi.begin(wifiSSID, wifiPassword);
-  
-  unsigned long startAttempt = millis();
-  const unsigned long wifiTimeout = 30000UL; // 30 seconds
-  
-  while (millis() - startAttempt < wifiTimeout) {
-    if (WiFi.status() == WL_CONNECTED) {
-      haveWiFi = true;
-      break;
-    }
-    delay(500);
-    Serial.print('.');
-  }
-  
-  if (!haveWiFi) {
-      Serial.println("\nWiFi Connection Failed!");
-      Serial.print("SSID: "); Serial.println(wifiSSID);
-      Serial.print("Status Code: "); Serial.println(WiFi.status());
-  }
-  
-  if (haveWiFi) {
-    Serial.println("\nWiFi connected");
-    Serial.print("IP: ");
-    Serial.println(WiFi.localIP());
-    
-    char ipStr[20];
-    snprintf(ipStr, sizeof(ipStr), "%s", WiFi.localIP().toString().c_str());
-    updateLCD("WiFi Connected", ipStr);
-    delay(2000);
-    
-    #if ENABLE_HTTP
-    if (useHTTPS) {
-      setupHTTPSServer();
-    } else {
-      setupHTTPServer();
-    }
-    
-    // Register device
-    registerDevice();
-    #endif
-  } else {
-    Serial.println("\nWiFi not available");
-    updateLCD("WiFi Failed", "Serial/BT only");
-    delay(2000);
-  }
+  startWiFi();
+
+  // Queues offline too; batches go out once WiFi is up
+  startUploader();
+  startEvents();
   
   // Create FreeRTOS tasks
-  xTaskCreatePinnedToCore(sensorTask, "SensorTask", 2048, NULL, 1, &sensorTaskHandle, 0);
+  xTaskCreatePinnedToCore(sensorTask, "SensorTask", 4096, NULL, 1, &sensorTaskHandle, 0);
   xTaskCreatePinnedToCore(displayTask, "DisplayTask", 2048, NULL, 1, &displayTaskHandle, 1);
+  startProfiler();
 
   // Run Startup Diagnostics
   runStartupDiagnostics();
@@ -178,17 +141,15 @@ void begin() {
   
   // Show ready
   showReady();
-  Serial.println("System Ready!");
+  LOG_I("Setup", "System Ready!");
+
+  // With serial_binary the console now switches to framed packets
+  startSerialTelemetry();
 }
 
 void update() {
-  #if ENABLE_HTTP
-  if (serverStarted && server) {
-    server->loop();
-  }
-  #endif
-  
-  delay(10);
+  // Servers, sensors and display all run in their own tasks
+  delay(1000);
 }
 
 } // namespace SpeedReader
@@ -10,6 +10,16 @@
 #define ENABLE_BT 0
 #endif
 
+// Cycle-counter timing of ISRs, loops and handlers (SR_Profiler.h)
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 0
+#endif
+
+// Most verbose log level compiled in, 0 (off) to 4 (debug); see SR_Log.h
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 4
+#endif
+
 // ===== Pin Definitions =====
 const int LED_PIN = 2;
 const int D4_DIGITAL = 4;   // rotation pulse (Changed to 4 for internal pull-up support)
@@ -33,6 +43,65 @@ const int LCD_CONTRAST_VALUE = 100;  // 0-255: Increased to 120 to fix solid blo
 // ===== Timing Constants =====
 const unsigned long readIntervalMs = 200;
 const unsigned long speedTimeoutMs = 2000UL;
+const unsigned long sessionSampleIntervalMs = 200;  // session recorder rate
+const unsigned long configSaveDelayMs = 500;        // coalesce /config writes
+const unsigned long publishIntervalMs = 50;         // readings ring / stream rate
+const unsigned long sensorLoopMs = 20;              // sensorTask period, text console
+
+// ===== Streaming =====
+const uint16_t streamPort = 8081;    // Server-Sent Events /stream
+const int streamMaxClients = 4;
+const int wsMaxClients = 2;                  // WebSocket /ws on the main server
+const uint32_t wsDefaultIntervalMs = 200;
+const uint32_t wsSlowSendMs = 20;            // a write this slow means the socket is full
+const uint32_t wsMaxBackoffMs = 2000;
+
+// ===== HTTP server task =====
+const int httpTaskCore = 1;
+const int httpTaskPriority = 2;              // above sensor/display (1)
+const uint32_t httpTaskStack = 8192;         // TLS handshakes need ~6 KB
+const uint32_t lanTaskStack = 4096;          // plain HTTP read-only listener
+const unsigned long serverIdleWaitMs = 1000; // select() timeout while idle
+
+// ===== HTTPS =====
+// Each TLS connection holds an mbedTLS context plus 16 KB record buffers
+const uint8_t httpsMaxConnections = 4;
+const uint32_t tlsConnectionHeap = 40000;     // heap used by one connection
+const uint32_t tlsMinLargestBlock = 17000;    // one record buffer, contiguous
+const uint32_t tlsHeapReserve = 24000;        // kept free for the other tasks
+const unsigned long tlsIdleEvictMs = 250;     // keep-alive idle time before eviction
+const unsigned long tlsAdmitWaitMs = 2000;    // how long a client waits for memory
+const unsigned long tlsHandshakeTimeoutMs = 3000;  // whole handshake, and each socket read/write
+const uint16_t tlsSessionCacheSize = 8;
+const long tlsSessionTimeoutS = 3600;
+
+// ===== Logging =====
+const uint32_t logRingSlots = 32;              // power of two
+const size_t logLineMax = 176;                 // longer messages are truncated
+const unsigned long logDrainIdleMs = 10;
+
+// ===== Serial telemetry =====
+const size_t serialQueueDepth = 64;            // samples between sensorTask and the writer
+const uint32_t serialTaskStack = 3072;
+
+// ===== Profiler =====
+const unsigned long profileDumpMs = 10000;     // Log dump period (ENABLE_PROFILER)
+
+// ===== WiFi =====
+const unsigned long wifiFastConnectTimeoutMs = 5000;   // cached BSSID/channel
+const unsigned long wifiConnectTimeoutMs = 20000;      // full scan
+const unsigned long wifiRetryMinMs = 1000;
+const unsigned long wifiRetryMaxMs = 30000;
+const uint32_t wifiTaskStack = 6144;                   // also starts the servers
+
+// ===== Collector uploads =====
+const size_t uploadRamRecords = 64;           // RAM queue; ~1 min at 1 Hz
+const size_t uploadBatchMax = 16;             // readings per POST
+const unsigned long uploadTimeoutMs = 5000;   // connect + response
+const unsigned long uploadBackoffMinMs = 2000;
+const unsigned long uploadBackoffMaxMs = 300000;
+const uint32_t uploadSpillMaxBytes = 65536;   // flash queue cap (~710 readings)
+const uint32_t uploaderTaskStack = 6144;
 
 // ===== Physical Constants =====
 const float wheelDiameterIn = 3.5f;
@@ -6,14 +6,15 @@
 #include <HTTPSServer.hpp>
 #endif
 
-#if ENABLE_BT
-#include <BluetoothSerial.h>
-#endif
 
 // ===== WiFi credentials =====
 char wifiSSID[64] = "";
 char wifiPassword[128] = "";
 char deviceName[32] = "speed_reader";
+char wifiIp[16] = "";
+char wifiGateway[16] = "";
+char wifiSubnet[16] = "255.255.255.0";
+char wifiDns[16] = "";
 
 // ===== LCD Object =====
 // Note: Pins are defined in config.h via globals.h
@@ -43,20 +44,39 @@ char currentJob[32] = "";
 bool sessionActive = false;
 
 // Radio / server state
-#if ENABLE_BT
-BluetoothSerial SerialBT;
-#endif
-
 bool haveWiFi = false;
 bool haveBT = false;
 bool serverStarted = false;
 
 #if ENABLE_HTTP
 HTTPServer *server = NULL;
+HTTPServer *lanServer = NULL;
 SSLCert *cert = NULL;
 bool useHTTPS = false;
+bool lanHTTP = false;
+int httpPort = 80;
+int httpsPort = 443;
+#endif
+
+// UDP telemetry publisher
+bool udpEnabled = false;
+char udpAddress[16] = "239.255.83.82";
+int udpPort = 5005;
+int udpIntervalMs = publishIntervalMs;
+bool udpBinary = false;
+
+#if ENABLE_BT
+int bleIntervalMs = 200;
+char blePin[7] = "";
 #endif
 
+// Binary serial telemetry
+bool serialBinary = false;
+int serialBaud = 921600;
+int serialIntervalMs = 5;
+
+int logLevel = 3;   // LOG_LEVEL_INFO
+
 // Non-blocking timers
 unsigned long lastAdcRead = 0;
 unsigned long lastDigitalRead = 0;
@@ -68,6 +88,8 @@ TaskHandle_t displayTaskHandle = NULL;
 // Mutex for shared data
 SemaphoreHandle_t dataMutex = NULL;
 SemaphoreHandle_t lcdMutex = NULL;
+SemaphoreHandle_t configMutex = NULL;
+SemaphoreHandle_t consoleMutex = NULL;
 
 // ===== Configurable Offsets =====
 float speedOffset = 0.0f;
@@ -81,6 +103,20 @@ int pulsesPerRotation = 1;
 
 // ===== API Key for Authentication =====
 char apiKey[64] = "hello";
+char readKey[64] = "";
 char devicePassword[32] = "admin";
 char registerUrl[128] = "";
 char station[32] = "DefaultStation";
+
+// Batched uploads to a collector
+char uploadUrl[128] = "";
+int uploadSampleMs = 1000;
+int uploadBatchMs = 10000;
+
+// Threshold rules and their notifications
+char eventRules[160] = "";
+char eventWebhook[128] = "";
+
+// Wall clock
+char ntpServer[64] = "pool.ntp.org";
+int ntpIntervalS = 3600;
@@ -19,14 +19,14 @@ namespace httpsserver {
 using namespace httpsserver;
 #endif
 
-#if ENABLE_BT
-class BluetoothSerial;
-#endif
-
 // ===== WiFi credentials loaded at runtime from SPIFFS =====
 extern char wifiSSID[64];
 extern char wifiPassword[128];
 extern char deviceName[32];
+extern char wifiIp[16];        // static address; empty = DHCP
+extern char wifiGateway[16];
+extern char wifiSubnet[16];
+extern char wifiDns[16];       // empty = gateway
 
 // ===== LCD Object =====
 extern LiquidCrystal lcd;
@@ -53,20 +53,41 @@ extern char currentJob[32];
 extern bool sessionActive;
 
 // Radio / server state
-#if ENABLE_BT
-extern BluetoothSerial SerialBT;
-#endif
-
 extern bool haveWiFi;
 extern bool haveBT;
 extern bool serverStarted;
 
 #if ENABLE_HTTP
 extern HTTPServer *server; // Base class for both servers (HTTPServer or HTTPSServer)
+extern HTTPServer *lanServer; // Read-only plain HTTP listener next to HTTPS
 extern SSLCert *cert;
 extern bool useHTTPS;  // Control HTTP vs HTTPS
+extern bool lanHTTP;   // Also serve read-only endpoints over plain HTTP
+extern int httpPort;
+extern int httpsPort;
 #endif
 
+// UDP telemetry publisher
+extern bool udpEnabled;
+extern char udpAddress[16];
+extern int udpPort;
+extern int udpIntervalMs;
+extern bool udpBinary;
+
+#if ENABLE_BT
+// BLE telemetry service
+extern int bleIntervalMs;
+extern char blePin[7];        // 6-digit passkey for the write characteristics
+#endif
+
+// Binary serial telemetry
+extern bool serialBinary;
+extern int serialBaud;
+extern int serialIntervalMs;
+
+// Runtime log level (LogLevel in SR_Log.h)
+extern int logLevel;
+
 // Non-blocking timers
 extern unsigned long lastAdcRead;
 extern unsigned long lastDigitalRead;
@@ -78,6 +99,8 @@ extern TaskHandle_t displayTaskHandle;
 // Mutex for shared data
 extern SemaphoreHandle_t dataMutex;
 extern SemaphoreHandle_t lcdMutex;
+extern SemaphoreHandle_t configMutex;   // settings written by /config
+extern SemaphoreHandle_t consoleMutex;  // text log vs. the switch to binary serial
 
 // ===== Configurable Offsets =====
 extern float speedOffset;
@@ -94,8 +117,22 @@ extern float vibrationOffset;
 
 // ===== API Key for Authentication =====
 extern char apiKey[64];
+extern char readKey[64];   // optional key for read-only endpoints over plain HTTP
 extern char devicePassword[32];
 extern char registerUrl[128];
 extern char station[32];
 
+// Batched uploads to a collector
+extern char uploadUrl[128];
+extern int uploadSampleMs;
+extern int uploadBatchMs;
+
+// Threshold rules and their notifications
+extern char eventRules[160];
+extern char eventWebhook[128];
+
+// Wall clock
+extern char ntpServer[64];
+extern int ntpIntervalS;
+
 #endif // GLOBALS_H
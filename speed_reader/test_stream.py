@@ -0,0 +1,58 @@
+
+import requests
+import time
+import json
+import sys
+
+# The stream is plain HTTP: it takes the device's read key (read_key), never
+# the API key, and only answers clients on the device's subnet.
+def stream_events(ip, read_key="", interval_ms=0):
+    url = f"http://{ip}:8081/stream"
+    params = {"interval_ms": interval_ms} if interval_ms else {}
+    headers = {"X-API-Key": read_key} if read_key else {}
+
+    print(f"Connecting to SSE stream at {url}...")
+
+    count = 0
+    gaps = 0
+    last_id = None
+    start_time = time.time()
+
+    try:
+        while True:
+            # Resume where we left off after a drop
+            if last_id is not None:
+                headers["Last-Event-ID"] = str(last_id)
+            try:
+                with requests.get(url, params=params, headers=headers, stream=True, timeout=20) as response:
+                    if response.status_code != 200:
+                        print(f"\nError: Status {response.status_code} {response.text}")
+                        time.sleep(1)
+                        continue
+
+                    event_id = None
+                    for line in response.iter_lines(decode_unicode=True):
+                        if line.startswith("id: "):
+                            event_id = int(line[4:])
+                        elif line.startswith("data: "):
+                            data = json.loads(line[6:])
+                            if last_id is not None and event_id != last_id + 1 and not interval_ms:
+                                gaps += 1
+                            last_id = event_id
+                            count += 1
+                            sys.stdout.write(f"\r[{event_id}] Speed: {data.get('speed_mph', 0.0):.2f} mph | Dist: {data.get('distance_miles', 0.0):.4f} mi | Angle: {data.get('angle', 0.0):.1f}°    ")
+                            sys.stdout.flush()
+            except requests.exceptions.RequestException as e:
+                print(f"\nStream dropped: {e} (resuming after {last_id})")
+                time.sleep(1)
+
+    except KeyboardInterrupt:
+        total_time = time.time() - start_time
+        print(f"\n\nStream stopped.")
+        print(f"Total events: {count}")
+        print(f"Average frequency: {count/total_time:.2f} Hz")
+        print(f"Sequence gaps: {gaps}")
+
+if __name__ == "__main__":
+    DEVICE_IP = "10.2.1.79"
+    stream_events(DEVICE_IP)
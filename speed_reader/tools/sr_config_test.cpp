@@ -0,0 +1,152 @@
+// Host-side checks for configFieldSet()/writeConfigField() (SR_ConfigField).
+// --self-test runs /config-style bodies against a small table of its own
+// fields: an explicit "" or null clears a string, a member left out keeps
+// its value, required strings cannot be cleared, and numbers and bools are
+// type- and range-checked.
+//
+// Build (from speed_reader/tools):
+//   g++ -std=c++11 -O2 -I../libraries/SpeedReaderCore/src sr_config_test.cpp
+//       ../libraries/SpeedReaderCore/src/SR_ConfigField.cpp
+//       ../libraries/SpeedReaderCore/src/SR_Json.cpp
+//       ../libraries/SpeedReaderCore/src/SR_JsonWriter.cpp -o sr_config_test
+//
+// Usage:
+//   sr_config_test --self-test
+
+#include <stdio.h>
+#include <string.h>
+
+#include "SR_ConfigSchema.h"
+
+static char url[32];
+static char key[17];
+static char name[8];
+static float scale;
+static int port;
+static bool enabled;
+
+static const ConfigField FIELDS[] = {
+  { "url",     CFG_STRING, url,      sizeof(url),  0, 0,     0 },
+  { "key",     CFG_STRING, key,      sizeof(key),  0, 0,     CFG_SECRET | CFG_REQUIRED },
+  { "name",    CFG_STRING, name,     sizeof(name), 0, 0,     0 },
+  { "scale",   CFG_FLOAT,  &scale,   0,            0.1f, 10, 0 },
+  { "port",    CFG_INT,    &port,    0,            1, 65535, 0 },
+  { "enabled", CFG_BOOL,   &enabled, 0,            0, 0,     0 },
+};
+static const size_t FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+static void reset() {
+  strcpy(url, "http://collector/up");
+  strcpy(key, "0123456789abcdef");
+  strcpy(name, "lathe");
+  scale = 1.5f;
+  port = 5005;
+  enabled = true;
+}
+
+static const ConfigField* field(const JsonToken& k) {
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    if (k.equals(FIELDS[i].name)) return &FIELDS[i];
+  }
+  return NULL;
+}
+
+// Applies every member of the body, as handleConfig does; returns the
+// result for the member named `which`
+static ConfigSetResult apply(const char* json, const char* which) {
+  ConfigSetResult result = CFG_SET_INVALID;
+  JsonScanner scan(json, strlen(json));
+  JsonToken k, v;
+  while (scan.next(k, v)) {
+    const ConfigField* f = field(k);
+    if (!f) continue;
+    ConfigSetResult r = configFieldSet(*f, v);
+    if (k.equals(which)) result = r;
+  }
+  return result;
+}
+
+// ===== Self-test =====
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (ok) return;
+  fprintf(stderr, "FAIL %s\n", what);
+  failures++;
+}
+
+static void testClear() {
+  reset();
+  expect(apply("{\"url\":\"\"}", "url") == CFG_SET_OK && url[0] == '\0', "\"\" clears a string");
+  expect(strcmp(name, "lathe") == 0 && port == 5005, "members left out are unchanged");
+
+  reset();
+  expect(apply("{\"url\":null,\"port\":6000}", "url") == CFG_SET_OK && url[0] == '\0', "null clears a string");
+  expect(port == 6000, "member after a null applied");
+
+  reset();
+  expect(apply("{\"key\":\"\"}", "key") == CFG_SET_INVALID && strcmp(key, "0123456789abcdef") == 0,
+         "required string not cleared by \"\"");
+  expect(apply("{\"key\":null}", "key") == CFG_SET_INVALID && key[0], "required string not cleared by null");
+  expect(apply("{\"key\":\"abcd\"}", "key") == CFG_SET_OK && strcmp(key, "abcd") == 0, "required string set");
+}
+
+static void testNumbers() {
+  reset();
+  expect(apply("{\"scale\":\"\"}", "scale") == CFG_SET_EMPTY && scale == 1.5f, "\"\" keeps a float");
+  expect(apply("{\"port\":null}", "port") == CFG_SET_EMPTY && port == 5005, "null keeps an int");
+  expect(apply("{\"enabled\":null}", "enabled") == CFG_SET_EMPTY && enabled, "null keeps a bool");
+
+  expect(apply("{\"scale\":2.25}", "scale") == CFG_SET_OK && scale == 2.25f, "float set");
+  expect(apply("{\"scale\":\"0.5\"}", "scale") == CFG_SET_OK && scale == 0.5f, "float from a string");
+  expect(apply("{\"scale\":11}", "scale") == CFG_SET_OUT_OF_RANGE && scale == 0.5f, "float above range");
+  expect(apply("{\"scale\":\"nan\"}", "scale") == CFG_SET_INVALID && scale == 0.5f, "float NaN string");
+  expect(apply("{\"scale\":NaN}", "scale") == CFG_SET_INVALID && scale == 0.5f, "float bare NaN");
+  expect(apply("{\"scale\":\"-inf\"}", "scale") == CFG_SET_INVALID && scale == 0.5f, "float infinity");
+  expect(apply("{\"port\":0}", "port") == CFG_SET_OUT_OF_RANGE && port == 5005, "int below range");
+  expect(apply("{\"port\":\"x\"}", "port") == CFG_SET_INVALID && port == 5005, "int not a number");
+  expect(apply("{\"enabled\":false}", "enabled") == CFG_SET_OK && !enabled, "bool set");
+  expect(apply("{\"enabled\":\"yes\"}", "enabled") == CFG_SET_INVALID && !enabled, "bool not a bool");
+}
+
+static void testStrings() {
+  reset();
+  expect(apply("{\"name\":\"mill-1\"}", "name") == CFG_SET_OK && strcmp(name, "mill-1") == 0, "string set");
+  expect(apply("{\"name\":\"mill-12\"}", "name") == CFG_SET_OK && strcmp(name, "mill-12") == 0,
+         "string filling the buffer");
+  expect(apply("{\"name\":\"mill-123\"}", "name") == CFG_SET_INVALID && strcmp(name, "mill-12") == 0,
+         "string too long rejected whole");
+  expect(apply("{\"name\":\"a\\\"b\"}", "name") == CFG_SET_OK && strcmp(name, "a\"b") == 0, "escaped string");
+  expect(apply("{\"name\":7}", "name") == CFG_SET_OK && strcmp(name, "7") == 0, "number into a string");
+}
+
+static void testWrite() {
+  reset();
+  url[0] = '\0';
+  char buf[160];
+  JsonWriter w(buf, sizeof(buf));
+  w.beginObject();
+  for (size_t i = 0; i < FIELD_COUNT; i++) {
+    w.key(FIELDS[i].name);
+    writeConfigField(w, FIELDS[i]);
+  }
+  w.endObject();
+  expect(!w.overflow() && strcmp(buf, "{\"url\":\"\",\"key\":\"0123456789abcdef\",\"name\":\"lathe\","
+                                      "\"scale\":1.5000,\"port\":5005,\"enabled\":true}") == 0,
+         "fields written back");
+}
+
+static int selfTest() {
+  testClear();
+  testNumbers();
+  testStrings();
+  testWrite();
+  printf("%s\n", failures ? "self-test FAILED" : "self-test ok");
+  return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 2 && !strcmp(argv[1], "--self-test")) return selfTest();
+  fprintf(stderr, "usage: %s --self-test\n", argv[0]);
+  return 2;
+}
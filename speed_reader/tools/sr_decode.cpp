@@ -0,0 +1,115 @@
+// Host-side decoder for session logs downloaded from GET /sessions/<id>.
+// Prints the samples as CSV, with the session start/end records as
+// '#' comment lines. utc_ms is filled in from the latest time anchor
+// (written when the device clock is synced) and left empty before one.
+//
+// Build (from speed_reader/tools):
+//   g++ -std=c++11 -O2 -I../libraries/SpeedReaderCore/src sr_decode.cpp
+//       ../libraries/SpeedReaderCore/src/SR_SampleCodec.cpp -o sr_decode
+//
+// Usage:
+//   sr_decode session_3.srl > session_3.csv
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "SR_SessionFormat.h"
+#include "SR_SampleCodec.h"
+
+static bool haveAnchor = false;
+static TimeAnchorPayload anchor;
+
+static void printSamples(const Sample* s, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    printf("%lu,%lu,%.2f,%.2f,%.3f,", (unsigned long)s[i].t_ms, (unsigned long)s[i].rotations,
+           s[i].speed_mph, s[i].angle, s[i].vibration);
+    if (haveAnchor) {
+      // t_ms wraps after ~49 days; the signed difference stays correct
+      int32_t dt = (int32_t)(s[i].t_ms - anchor.tMs);
+      printf("%llu", (unsigned long long)((int64_t)anchor.utcMs + dt));
+    }
+    printf("\n");
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <session.srl>\n", argv[0]);
+    return 2;
+  }
+
+  FILE* f = fopen(argv[1], "rb");
+  if (!f) {
+    perror(argv[1]);
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+  fclose(f);
+
+  printf("t_ms,rotations,speed_mph,angle,vibration,utc_ms\n");
+
+  Sample samples[SAMPLE_BLOCK_MAX_COUNT];
+  size_t pos = 0;
+  size_t total = 0;
+  size_t rec;
+  while ((rec = sessionRecordCheck(data.data() + pos, data.size() - pos)) > 0) {
+    const RecordHeader* h = (const RecordHeader*)(data.data() + pos);
+    const uint8_t* payload = data.data() + pos + sizeof(RecordHeader);
+
+    switch (h->type) {
+      case REC_SESSION_START: {
+        SessionStartPayload start;
+        memcpy(&start, payload, sizeof(start));
+        start.job[sizeof(start.job) - 1] = '\0';
+        printf("# session %lu job=\"%s\" start_ms=%lu\n", (unsigned long)start.sessionId, start.job,
+               (unsigned long)start.startMs);
+        break;
+      }
+      case REC_SAMPLES: {
+        size_t count = h->len / sizeof(Sample);
+        if (count > SAMPLE_BLOCK_MAX_COUNT) count = SAMPLE_BLOCK_MAX_COUNT;
+        memcpy(samples, payload, count * sizeof(Sample));
+        printSamples(samples, count);
+        total += count;
+        break;
+      }
+      case REC_SAMPLES_PACKED: {
+        size_t count = decodeSampleBlock(payload, h->len, samples, SAMPLE_BLOCK_MAX_COUNT);
+        if (count == 0) fprintf(stderr, "warning: undecodable sample block at offset %zu\n", pos);
+        printSamples(samples, count);
+        total += count;
+        break;
+      }
+      case REC_TIME_ANCHOR: {
+        memcpy(&anchor, payload, sizeof(anchor));
+        haveAnchor = true;
+        printf("# time t_ms=%lu utc_ms=%llu\n", (unsigned long)anchor.tMs, (unsigned long long)anchor.utcMs);
+        break;
+      }
+      case REC_SESSION_END: {
+        SessionEndPayload end;
+        memcpy(&end, payload, sizeof(end));
+        static const char* reasons[] = { "normal", "replaced", "recovered" };
+        printf("# end end_ms=%lu rotations=%lu max_speed=%.2f max_angle=%.2f min_angle=%.2f max_vibration=%.3f reason=%s\n",
+               (unsigned long)end.endMs, (unsigned long)end.rotations, end.maxSpeed, end.maxAngle, end.minAngle,
+               end.maxVibration, end.reason < 3 ? reasons[end.reason] : "unknown");
+        break;
+      }
+      default:
+        fprintf(stderr, "warning: unknown record type %u at offset %zu\n", h->type, pos);
+        break;
+    }
+    pos += rec;
+  }
+
+  if (pos != data.size()) {
+    fprintf(stderr, "warning: stopped at offset %zu of %zu (truncated or corrupt record)\n", pos, data.size());
+  }
+  fprintf(stderr, "%zu samples, %zu bytes (%.1f bytes/sample)\n", total, data.size(),
+          total ? (double)data.size() / total : 0.0);
+  return 0;
+}
@@ -0,0 +1,232 @@
+// Host-side checks for the JSON scanner (SR_Json). --self-test covers
+// escapes, nested values, truncated and malformed input, null and the
+// typed conversions, which reject trailing characters and overflow;
+// --bench times a full /config body parsed with JsonScanner against the
+// getJsonValue() lookups it replaced.
+//
+// Build (from speed_reader/tools):
+//   g++ -std=c++11 -O2 -I../libraries/SpeedReaderCore/src sr_json_test.cpp
+//       ../libraries/SpeedReaderCore/src/SR_Json.cpp -o sr_json_test
+//
+// Usage:
+//   sr_json_test --self-test
+//   sr_json_test --bench [iterations]
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "SR_Json.h"
+
+// ===== Self-test =====
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (ok) return;
+  fprintf(stderr, "FAIL %s\n", what);
+  failures++;
+}
+
+static bool find(const char* json, const char* key, JsonToken& value) {
+  return jsonFind(json, strlen(json), key, value);
+}
+
+static void testEscapes() {
+  JsonToken v;
+  char buf[64];
+  expect(find("{\"job\":\"say \\\"hi\\\"\",\"n\":1}", "job", v) && v.escaped, "escaped quote found");
+  expect(v.copyTo(buf, sizeof(buf)) && strcmp(buf, "say \"hi\"") == 0, "escaped quote decoded");
+  expect(v.equals("say \"hi\""), "escaped quote equals");
+  expect(find("{\"job\":\"say \\\"hi\\\"\",\"n\":1}", "n", v) && v.type == JSON_NUMBER,
+         "member after escaped quote");
+
+  expect(find("{\"s\":\"a\\\\b\\/c\\n\"}", "s", v) && v.copyTo(buf, sizeof(buf)) &&
+         strcmp(buf, "a\\b/c\n") == 0, "backslash, slash and newline escapes");
+  expect(find("{\"s\":\"\\u0041\\u00e9\\u20ac\"}", "s", v) && v.copyTo(buf, sizeof(buf)) &&
+         strcmp(buf, "A\xC3\xA9\xE2\x82\xAC") == 0, "\\u escapes to UTF-8");
+  expect(find("{\"s\":\"\\u12G4\"}", "s", v) && !v.copyTo(buf, sizeof(buf)), "bad \\u escape rejected");
+  expect(find("{\"s\":\"\\u00\"}", "s", v) && !v.copyTo(buf, sizeof(buf)), "short \\u escape rejected");
+
+  // Escaped key
+  expect(find("{\"j\\u006fb\":\"x\"}", "job", v) && v.equals("x"), "escaped key matches");
+
+  // copyTo never overruns and reports truncation
+  expect(find("{\"s\":\"abcdef\"}", "s", v) && !v.copyTo(buf, 4) && strcmp(buf, "abc") == 0,
+         "truncated copy");
+}
+
+static void testNested() {
+  const char* json = "{\"a\":{\"x\":[1,{\"y\":\"}]\"}],\"z\":{}},\"b\":[\"{\",[]],\"c\":2}";
+  JsonScanner scan(json, strlen(json));
+  JsonToken k, v;
+  expect(scan.next(k, v) && k.equals("a") && v.type == JSON_OBJECT, "nested object skipped whole");
+  expect(scan.next(k, v) && k.equals("b") && v.type == JSON_ARRAY, "nested array skipped whole");
+  long l = 0;
+  expect(scan.next(k, v) && k.equals("c") && v.toLong(l) && l == 2, "member after nested values");
+  expect(!scan.next(k, v) && !scan.error(), "clean end");
+
+  // Only top-level members match
+  expect(!find("{\"a\":{\"c\":1}}", "c", v), "nested key not found at top level");
+}
+
+static void testMalformed() {
+  const char* cases[] = {
+    "{\"a\":\"abc",        // unterminated string
+    "{\"a\":1,",           // missing member
+    "{\"a\"",              // missing colon
+    "{\"a\":",             // missing value
+    "{\"a\":{\"b\":1",     // unterminated object
+    "{\"a\":1 \"b\":2}",   // missing comma
+    "[1,2]",               // not an object
+    "",
+  };
+  for (const char* json : cases) {
+    JsonScanner scan(json, strlen(json));
+    JsonToken k, v;
+    while (scan.next(k, v)) {}
+    if (!scan.error()) {
+      fprintf(stderr, "FAIL malformed input accepted: %s\n", json);
+      failures++;
+    }
+  }
+
+  // Length bounds the scan even without a NUL
+  const char json[] = "{\"a\":1}{\"b\":2}";
+  JsonScanner scan(json, 7);
+  JsonToken k, v;
+  expect(scan.next(k, v) && k.equals("a") && !scan.next(k, v) && !scan.error(), "length-bounded input");
+
+  JsonScanner empty("{ }", 3);
+  expect(!empty.next(k, v) && !empty.error(), "empty object");
+}
+
+static void testTypes() {
+  const char* json = "{\"s\":\"12.5\",\"n\":-3,\"f\":1e3,\"t\":true,\"z\":null,\"o\":{},\"w\":\"abc\","
+                     "\"u\":1760870400123}";
+  JsonToken v;
+  float f;
+  long l;
+  bool b;
+  uint64_t u;
+
+  expect(find(json, "z", v) && v.type == JSON_NULL, "null type");
+  expect(!v.toLong(l) && !v.toFloat(f), "null is not a number");
+  expect(find(json, "n", v) && v.toLong(l) && l == -3, "negative integer");
+  expect(!v.toUInt64(u), "negative rejected as uint64");
+  expect(find(json, "f", v) && v.toFloat(f) && f == 1000.0f, "exponent");
+  expect(find(json, "s", v) && v.type == JSON_STRING && v.toFloat(f) && f == 12.5f, "number in a string");
+  expect(find(json, "t", v) && v.type == JSON_BOOL && v.toBool(b) && b, "true");
+  expect(!v.toLong(l), "bool is not an integer");
+  expect(find(json, "o", v) && !v.toLong(l) && !v.toFloat(f) && !v.toBool(b), "object is not a scalar");
+  expect(find(json, "w", v) && !v.toLong(l) && !v.toFloat(f) && !v.toBool(b), "word is not a number or bool");
+  expect(find(json, "u", v) && v.toUInt64(u) && u == 1760870400123ULL, "uint64");
+}
+
+static void testStrictNumbers() {
+  const char* json = "{\"a\":\"12abc\",\"e\":5e9,\"d\":2.5,\"big\":99999999999999999999,"
+                     "\"fbig\":1e999,\"neg\":-99999999999999999999,\"sp\":\"7 \",\"i\":\"42\"}";
+  JsonToken v;
+  float f;
+  long l;
+  uint64_t u;
+
+  expect(find(json, "a", v) && !v.toLong(l) && !v.toFloat(f) && !v.toUInt64(u), "trailing garbage rejected");
+  expect(find(json, "e", v) && !v.toLong(l) && !v.toUInt64(u), "exponent is not an integer");
+  expect(v.toFloat(f) && f == 5e9f, "exponent is a float");
+  expect(find(json, "d", v) && !v.toLong(l), "fraction is not an integer");
+  expect(find(json, "big", v) && !v.toLong(l) && !v.toUInt64(u), "integer overflow rejected");
+  expect(find(json, "fbig", v) && !v.toFloat(f), "float overflow rejected");
+  expect(find(json, "neg", v) && !v.toLong(l), "integer underflow rejected");
+  expect(find(json, "sp", v) && !v.toLong(l), "trailing space rejected");
+  expect(find(json, "i", v) && v.toLong(l) && l == 42 && v.toUInt64(u) && u == 42, "integer in a string");
+}
+
+static int selfTest() {
+  testEscapes();
+  testNested();
+  testMalformed();
+  testTypes();
+  testStrictNumbers();
+  printf("%s\n", failures ? "self-test FAILED" : "self-test ok");
+  return failures ? 1 : 0;
+}
+
+// ===== Benchmark =====
+// getJsonValue() as it was, with std::string standing in for Arduino's
+// String: one search of the whole body and a heap copy per key.
+static std::string getJsonValue(const std::string& json, const std::string& key) {
+  size_t keyIndex = json.find("\"" + key + "\":");
+  if (keyIndex == std::string::npos) return "";
+  size_t colonIndex = json.find(":", keyIndex);
+  if (colonIndex == std::string::npos) return "";
+  size_t valStart = colonIndex + 1;
+  while (valStart < json.length() && json[valStart] <= ' ') valStart++;
+  if (valStart >= json.length()) return "";
+  if (json[valStart] == '"') {
+    valStart++;
+    size_t valEnd = json.find("\"", valStart);
+    if (valEnd == std::string::npos) return "";
+    return json.substr(valStart, valEnd - valStart);
+  }
+  size_t valEnd = valStart;
+  while (valEnd < json.length() && json[valEnd] != ',' && json[valEnd] != '}' && json[valEnd] != ']') valEnd++;
+  std::string token = json.substr(valStart, valEnd - valStart);
+  while (!token.empty() && token.back() <= ' ') token.pop_back();
+  return token;
+}
+
+static const char* BENCH_KEYS[] = {
+  "ssid", "wifi_password", "name", "api_key", "read_key", "register_url", "station",
+  "speed_offset", "speed_scale", "pulses_per_rotation", "distance_offset", "angle_offset",
+  "accel_offset", "accel_scale", "vibration_offset", "udp_port", "ntp_server", "device_password",
+};
+
+static const char BENCH_BODY[] =
+  "{\"ssid\":\"Workshop\",\"wifi_password\":\"s3cret-pass\",\"name\":\"lathe-2\","
+  "\"api_key\":\"0123456789abcdef\",\"read_key\":\"viewer\",\"register_url\":"
+  "\"https://collector.local/register\",\"station\":\"bay 4\",\"speed_offset\":0.25,"
+  "\"speed_scale\":1.02,\"pulses_per_rotation\":4,\"distance_offset\":0.0,\"angle_offset\":-1.5,"
+  "\"accel_offset\":12,\"accel_scale\":1.0,\"vibration_offset\":0.01,\"udp_port\":5005,"
+  "\"ntp_server\":\"pool.ntp.org\",\"device_password\":\"admin\"}";
+
+static int bench(long iterations) {
+  const size_t keyCount = sizeof(BENCH_KEYS) / sizeof(BENCH_KEYS[0]);
+  volatile size_t sink = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::string body(BENCH_BODY);
+  for (long i = 0; i < iterations; i++) {
+    for (size_t k = 0; k < keyCount; k++) sink += getJsonValue(body, BENCH_KEYS[k]).length();
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    JsonScanner scan(BENCH_BODY, sizeof(BENCH_BODY) - 1);
+    JsonToken key, value;
+    while (scan.next(key, value)) {
+      // The same per-key dispatch handleConfig does
+      for (size_t k = 0; k < keyCount; k++) {
+        if (key.equals(BENCH_KEYS[k])) {
+          sink += value.len;
+          break;
+        }
+      }
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  double oldNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+  double newNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / iterations;
+  printf("%lu-field /config body, %ld iterations\n", (unsigned long)keyCount, iterations);
+  printf("getJsonValue per key  %10.0f ns/body\n", oldNs);
+  printf("JsonScanner one pass  %10.0f ns/body  (%.1fx)\n", newNs, oldNs / newNs);
+  return sink == 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 2 && !strcmp(argv[1], "--self-test")) return selfTest();
+  if (argc >= 2 && !strcmp(argv[1], "--bench")) return bench(argc >= 3 ? atol(argv[2]) : 100000);
+  fprintf(stderr, "usage: %s --self-test\n       %s --bench [iterations]\n", argv[0], argv[0]);
+  return 2;
+}
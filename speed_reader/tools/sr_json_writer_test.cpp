@@ -0,0 +1,307 @@
+// Host-side checks for the streaming JSON writer (SR_JsonWriter).
+// --self-test covers string escaping, float and integer formatting,
+// commas across nesting, the overflow flag on a fixed buffer and on a
+// short-writing sink, and counts heap allocations made while writing:
+// operator new is replaced here and, on glibc, malloc/calloc/realloc
+// too, so any allocation in the writer or the libc calls it makes
+// fails the test.
+//
+// Build (from speed_reader/tools):
+//   g++ -std=c++11 -O2 -I../libraries/SpeedReaderCore/src sr_json_writer_test.cpp
+//       ../libraries/SpeedReaderCore/src/SR_JsonWriter.cpp -o sr_json_writer_test
+//
+// Usage:
+//   sr_json_writer_test --self-test
+
+#include <limits.h>
+#include <math.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "SR_JsonWriter.h"
+
+// ===== Allocation counting =====
+static bool counting = false;
+static unsigned long allocations = 0;
+
+static void countAllocation() {
+  if (counting) allocations++;
+}
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+
+void* malloc(size_t size) {
+  countAllocation();
+  return __libc_malloc(size);
+}
+void* calloc(size_t n, size_t size) {
+  countAllocation();
+  return __libc_calloc(n, size);
+}
+void* realloc(void* p, size_t size) {
+  countAllocation();
+  return __libc_realloc(p, size);
+}
+}
+#define RAW_MALLOC __libc_malloc
+#else
+#define RAW_MALLOC malloc
+#endif
+
+// Counted once here, not again by the malloc hook
+void* operator new(size_t size) {
+  countAllocation();
+  void* p = RAW_MALLOC(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ===== Self-test =====
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (ok) return;
+  fprintf(stderr, "FAIL %s\n", what);
+  failures++;
+}
+
+static void expectJson(const char* got, const char* want, const char* what) {
+  if (strcmp(got, want) == 0) return;
+  fprintf(stderr, "FAIL %s\n  got:  %s\n  want: %s\n", what, got, want);
+  failures++;
+}
+
+static void testEscapes() {
+  char buf[256];
+  {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginObject();
+    w.field("quote", "say \"hi\"");
+    w.field("slash", "a\\b/c");
+    w.field("ws", "\n\r\t\b\f");
+    w.field("ctl", "\x01\x1f");
+    w.field("utf8", "\xC3\xA9\xE2\x82\xAC");
+    w.field("k\"ey", "v");
+    w.endObject();
+  }
+  expectJson(buf,
+             "{\"quote\":\"say \\\"hi\\\"\",\"slash\":\"a\\\\b/c\",\"ws\":\"\\n\\r\\t\\b\\f\","
+             "\"ctl\":\"\\u0001\\u001f\",\"utf8\":\"\xC3\xA9\xE2\x82\xAC\",\"k\\\"ey\":\"v\"}",
+             "string and key escaping");
+
+  {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginArray().value("ab\0cd", 5).value((const char*)NULL).value("").endArray();
+  }
+  expectJson(buf, "[\"ab\\u0000cd\",\"\",\"\"]", "embedded NUL, NULL and empty strings");
+}
+
+static void testNumbers() {
+  char buf[256];
+  {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginArray();
+    w.value(1.5f).value(-0.125f, 3).value(2.0f, 0).value(0.126f, 2).value(12.3456f, 4);
+    w.value(NAN).value(INFINITY).value(-INFINITY).value(1e30f, 2);
+    w.endArray();
+  }
+  expectJson(buf, "[1.50,-0.125,2,0.13,12.3456,null,null,null,null]", "float formatting");
+
+  {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginArray();
+    w.value(0).value(-42).value(LONG_MIN).value(ULONG_MAX).value(18446744073709551615ULL);
+    w.value(true).value(false).null();
+    w.endArray();
+  }
+  char want[160];
+  snprintf(want, sizeof(want), "[0,-42,%ld,%lu,18446744073709551615,true,false,null]",
+           LONG_MIN, ULONG_MAX);
+  expectJson(buf, want, "integers, bools and null");
+}
+
+static void testNesting() {
+  char buf[256];
+  {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginObject();
+    w.key("a").beginArray().value(1).beginObject().endObject().beginArray().endArray().value(2).endArray();
+    w.key("b").beginObject().field("x", 1).key("y").raw("{\"z\":[]}", 8).endObject();
+    w.field("c", "d");
+    w.endObject();
+  }
+  expectJson(buf, "{\"a\":[1,{},[],2],\"b\":{\"x\":1,\"y\":{\"z\":[]}},\"c\":\"d\"}", "commas across nesting");
+}
+
+static void testOverflow() {
+  const char* full = "{\"key\":\"value\"}";
+  size_t n = strlen(full);
+  char buf[32];
+
+  {
+    JsonWriter w(buf, n + 1);
+    w.beginObject().field("key", "value").endObject();
+    expect(!w.overflow() && strcmp(buf, full) == 0, "exact fit");
+    expect(w.length() == n, "length of exact fit");
+  }
+  {
+    memset(buf, 'x', sizeof(buf));
+    JsonWriter w(buf, n);
+    w.beginObject().field("key", "value").endObject();
+    expect(w.overflow(), "one byte short sets overflow");
+    expect(strlen(buf) < n && strncmp(buf, full, strlen(buf)) == 0, "truncated output is a terminated prefix");
+    expect(w.length() == n, "length counts dropped output");
+  }
+  {
+    JsonWriter w(buf, 4);
+    w.beginObject().field("key", "value");
+    bool first = w.overflow();
+    w.endObject();
+    expect(first && w.overflow() && strcmp(buf, "{\"") == 0, "overflow is sticky");
+  }
+  {
+    JsonWriter w(buf, 0);
+    w.value(1);
+    expect(w.overflow(), "zero capacity overflows");
+  }
+}
+
+struct SinkState {
+  std::string out;
+  size_t calls;
+  size_t maxChunk;
+  size_t limit;   // bytes accepted before the sink starts writing short
+};
+
+static size_t sink(void* ctx, const char* data, size_t len) {
+  SinkState* s = (SinkState*)ctx;
+  s->calls++;
+  if (len > s->maxChunk) s->maxChunk = len;
+  size_t room = s->limit > s->out.size() ? s->limit - s->out.size() : 0;
+  size_t n = len < room ? len : room;
+  s->out.append(data, n);
+  return n;
+}
+
+static void writeLong(JsonWriter& w) {
+  w.beginArray();
+  for (int i = 0; i < 40; i++) w.value("0123456789");
+  w.endArray();
+}
+
+static void testSink() {
+  const size_t expected = 2 + 40 * 12 + 39;
+  SinkState s;
+  s.out.reserve(1024);
+  s.calls = 0;
+  s.maxChunk = 0;
+  s.limit = 1024;
+  counting = true;
+  {
+    JsonWriter w(&sink, &s);
+    writeLong(w);
+    expect(w.length() == expected, "sink length");
+    w.flush();
+    expect(!w.overflow(), "sink without errors");
+  }
+  counting = false;
+  expect(s.out.size() == expected && s.out[0] == '[' && s.out[expected - 1] == ']', "sink output complete");
+  expect(s.maxChunk <= JsonWriter::STAGE_SIZE && s.calls == (expected + JsonWriter::STAGE_SIZE - 1) / JsonWriter::STAGE_SIZE,
+         "sink called in full STAGE_SIZE chunks");
+
+  SinkState shortSink;
+  shortSink.out.reserve(1024);
+  shortSink.calls = 0;
+  shortSink.maxChunk = 0;
+  shortSink.limit = 100;
+  counting = true;
+  bool overflow;
+  {
+    JsonWriter w(&sink, &shortSink);
+    writeLong(w);
+    w.flush();
+    overflow = w.overflow();
+  }
+  counting = false;
+  expect(overflow && shortSink.out.size() == 100, "short write sets overflow");
+}
+
+static void testAllocations() {
+  char buf[512];
+  counting = true;
+  allocations = 0;
+  {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginObject();
+    w.field("name", "lathe \"2\"\n");
+    w.field("speed", 12.345f, 3);
+    w.field("nan", NAN, 2);
+    w.field("rotations", 123456789UL);
+    w.field("t_ms", 1760870400123ULL);
+    w.field("offset", -17L);
+    w.field("on", true);
+    w.key("list").beginArray().value(1).value("\x02").null().endArray();
+    w.endObject();
+  }
+  char small[8];
+  {
+    JsonWriter w(small, sizeof(small));
+    w.beginObject().field("overflowing", 1.25f, 2).endObject();
+  }
+  counting = false;
+  expect(allocations == 0, "no heap allocations while writing");
+  if (allocations) fprintf(stderr, "  %lu allocation(s)\n", allocations);
+}
+
+static int selfTest() {
+  // The hooks must see allocations, or a zero count proves nothing
+  counting = true;
+  allocations = 0;
+  void* volatile p = malloc(16);
+  int* volatile q = new int(1);
+  counting = false;
+  free(p);
+  delete q;
+#ifdef __GLIBC__
+  expect(allocations == 2, "malloc and operator new are counted");
+#else
+  expect(allocations == 1, "operator new is counted");
+#endif
+
+  testEscapes();
+  testNumbers();
+  testNesting();
+  testOverflow();
+  testSink();
+  testAllocations();
+  allocations = 0;
+  counting = true;
+  testEscapes();
+  testNumbers();
+  testNesting();
+  testOverflow();
+  counting = false;
+  expect(allocations == 0, "no heap allocations across the formatting tests");
+  if (allocations) fprintf(stderr, "  %lu allocation(s)\n", allocations);
+
+  printf("%s\n", failures ? "self-test FAILED" : "self-test ok");
+  return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 2 && !strcmp(argv[1], "--self-test")) return selfTest();
+  fprintf(stderr, "usage: %s --self-test\n", argv[0]);
+  return 2;
+}
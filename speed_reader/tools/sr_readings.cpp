@@ -0,0 +1,180 @@
+// Host-side decoder for binary /readings responses, either packed
+// (Accept: application/octet-stream) or CBOR (Accept: application/cbor).
+// Several responses may be concatenated in one file; each is printed as a
+// CSV row. --compact reads 20-byte BLE notifications (CompactReading)
+// instead, e.g. saved from a phone's BLE logger.
+//
+// --self-test round-trips readings, including out-of-range and NaN
+// values, through every codec and reports any mismatch.
+//
+// Build (from speed_reader/tools):
+//   g++ -std=c++11 -O2 -I../libraries/SpeedReaderCore/src sr_readings.cpp
+//       ../libraries/SpeedReaderCore/src/SR_ReadingCodec.cpp
+//       ../libraries/SpeedReaderCore/src/SR_JsonWriter.cpp -o sr_readings
+//
+// Usage:
+//   curl -s -H "X-API-Key: hello" -H "Accept: application/cbor"
+//       http://192.168.1.100/readings | sr_readings
+//   sr_readings --compact ble_capture.bin
+//   sr_readings --self-test
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "SR_ReadingCodec.h"
+
+// ===== Self-test =====
+static int failures = 0;
+
+static void expect(bool ok, const char* codec, const char* what, double got, double want) {
+  if (ok) return;
+  fprintf(stderr, "FAIL %s %s: got %.6f, want %.6f\n", codec, what, got, want);
+  failures++;
+}
+
+static void expectNear(const char* codec, const char* what, double got, double want, double tol) {
+  expect(fabs(got - want) <= tol, codec, what, got, want);
+}
+
+static Reading sampleReading(uint32_t seq) {
+  Reading r;
+  memset(&r, 0, sizeof(r));
+  r.seq = seq;
+  r.t_ms = 123456 + seq * 50;
+  r.utc_ms = 1760870400123ULL + seq * 50;
+  r.rotations = 70000 + seq;
+  r.distance_miles = 12.3456f;
+  r.speed_mph = 4.56f;
+  r.max_speed = 9.87f;
+  r.angle = -12.34f;
+  r.max_angle = 20.5f;
+  r.min_angle = -30.25f;
+  r.vibration = 0.123f;
+  r.max_vibration = 1.5f;
+  strcpy(r.job, "Run_001");
+  return r;
+}
+
+static void testFull(const char* codec, size_t (*enc)(const Reading&, uint8_t*, size_t),
+                     size_t (*dec)(const uint8_t*, size_t, Reading&)) {
+  Reading r = sampleReading(70001);
+  uint8_t buf[512];
+  size_t n = enc(r, buf, sizeof(buf));
+  Reading d;
+  expect(n > 0 && dec(buf, n, d) == n, codec, "round trip size", (double)n, (double)n);
+  if (n == 0) return;
+  expect(d.seq == r.seq, codec, "seq", d.seq, r.seq);
+  expect(d.t_ms == r.t_ms, codec, "t_ms", d.t_ms, r.t_ms);
+  expect(d.utc_ms == r.utc_ms, codec, "utc_ms", (double)d.utc_ms, (double)r.utc_ms);
+  expect(d.rotations == r.rotations, codec, "rotations", d.rotations, r.rotations);
+  expect(d.speed_mph == r.speed_mph, codec, "speed_mph", d.speed_mph, r.speed_mph);
+  expect(d.min_angle == r.min_angle, codec, "min_angle", d.min_angle, r.min_angle);
+  expect(strcmp(d.job, r.job) == 0, codec, "job", 0, 0);
+  expect(enc(r, buf, n - 1) == 0, codec, "short buffer rejected", 0, 0);
+  expect(dec(buf, n - 1, d) == 0, codec, "truncated input rejected", 0, 0);
+}
+
+static void testCompact() {
+  const char* codec = "compact";
+  Reading r = sampleReading(70001);
+  uint8_t buf[sizeof(CompactReading)];
+  expect(encodeReadingCompact(r, buf, sizeof(buf)) == 20, codec, "size", sizeof(buf), 20);
+  Reading d;
+  expect(decodeReadingCompact(buf, sizeof(buf), d) == 20, codec, "decode", 0, 0);
+  expect(d.seq == (r.seq & 0xFFFF), codec, "seq low bits", d.seq, r.seq & 0xFFFF);
+  expect(d.rotations == r.rotations, codec, "rotations", d.rotations, r.rotations);
+  expectNear(codec, "distance_miles", d.distance_miles, r.distance_miles, 0.00005);
+  expectNear(codec, "speed_mph", d.speed_mph, r.speed_mph, 0.005);
+  expectNear(codec, "max_speed", d.max_speed, r.max_speed, 0.005);
+  expectNear(codec, "angle", d.angle, r.angle, 0.005);
+  expectNear(codec, "vibration", d.vibration, r.vibration, 0.0005);
+  expect(buf[1] == COMPACT_SESSION_ACTIVE, codec, "session flag", buf[1], COMPACT_SESSION_ACTIVE);
+
+  // Saturation instead of wrap-around
+  r.speed_mph = 1000.0f;
+  r.angle = -500.0f;
+  r.vibration = NAN;
+  r.distance_miles = -1.0f;
+  r.job[0] = '\0';
+  encodeReadingCompact(r, buf, sizeof(buf));
+  decodeReadingCompact(buf, sizeof(buf), d);
+  expectNear(codec, "speed saturates", d.speed_mph, 327.67, 0.001);
+  expectNear(codec, "angle saturates", d.angle, -327.68, 0.001);
+  expect(d.vibration == 0.0f, codec, "NaN vibration", d.vibration, 0);
+  expect(d.distance_miles == 0.0f, codec, "negative distance", d.distance_miles, 0);
+  expect(buf[1] == 0, codec, "no session flag", buf[1], 0);
+  expect(decodeReadingCompact(buf, 19, d) == 0, codec, "truncated input rejected", 0, 0);
+}
+
+static int selfTest() {
+  testFull("packed", encodeReadingPacket, decodeReadingPacket);
+  testFull("cbor", encodeReadingCbor, decodeReadingCbor);
+  testCompact();
+
+  // An 80-byte packet from firmware before utc_ms still decodes
+  Reading r = sampleReading(5), d;
+  uint8_t buf[sizeof(ReadingPacket)];
+  encodeReadingPacket(r, buf, sizeof(buf));
+  buf[2] = (uint8_t)READING_PACKET_BASE_SIZE;
+  buf[3] = 0;
+  expect(decodeReadingPacket(buf, READING_PACKET_BASE_SIZE, d) == READING_PACKET_BASE_SIZE &&
+         d.utc_ms == 0 && d.seq == 5, "packed", "version 1 prefix", 0, 0);
+
+  printf("%s\n", failures ? "self-test FAILED" : "self-test ok");
+  return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+  bool compact = false;
+  int arg = 1;
+  if (arg < argc && strcmp(argv[arg], "--self-test") == 0) return selfTest();
+  if (arg < argc && strcmp(argv[arg], "--compact") == 0) {
+    compact = true;
+    arg++;
+  }
+
+  FILE* f = stdin;
+  if (arg < argc) {
+    f = fopen(argv[arg], "rb");
+    if (!f) {
+      perror(argv[arg]);
+      return 1;
+    }
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+  if (f != stdin) fclose(f);
+
+  printf("seq,t_ms,rotations,distance_miles,speed_mph,max_speed,angle,max_angle,min_angle,vibration,max_vibration,job,utc_ms\n");
+
+  size_t pos = 0;
+  size_t count = 0;
+  while (pos < data.size()) {
+    Reading r;
+    const uint8_t* p = data.data() + pos;
+    size_t avail = data.size() - pos;
+
+    // A CBOR map head is 0xA0-0xBB; the packed format starts with its
+    // version byte
+    size_t used = compact ? decodeReadingCompact(p, avail, r)
+                : ((p[0] >> 5) == 5) ? decodeReadingCbor(p, avail, r)
+                                     : decodeReadingPacket(p, avail, r);
+    if (used == 0) {
+      fprintf(stderr, "malformed reading at offset %lu\n", (unsigned long)pos);
+      return 1;
+    }
+    printf("%lu,%lu,%lu,%.4f,%.2f,%.2f,%.1f,%.1f,%.1f,%.3f,%.3f,%s,%llu\n",
+           (unsigned long)r.seq, (unsigned long)r.t_ms, (unsigned long)r.rotations,
+           r.distance_miles, r.speed_mph, r.max_speed, r.angle, r.max_angle, r.min_angle,
+           r.vibration, r.max_vibration, r.job, (unsigned long long)r.utc_ms);
+    pos += used;
+    count++;
+  }
+
+  fprintf(stderr, "%lu readings\n", (unsigned long)count);
+  return 0;
+}
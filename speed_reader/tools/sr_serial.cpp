@@ -0,0 +1,346 @@
+// Host-side decoder for the device's binary serial telemetry
+// (serial_binary). Reads COBS frames from the serial port, or from a file
+// captured from it, and prints each sample as a CSV row; log frames go to
+// stderr. --compact writes the raw 20-byte CompactReading records instead,
+// for sr_readings --compact or any tool that reads the BLE format. Lost
+// samples (gaps in seq) and bad frames are counted and reported at the
+// end of the input or on Ctrl-C.
+//
+// Build (from speed_reader/tools):
+//   g++ -std=c++11 -O2 -I../libraries/SpeedReaderCore/src sr_serial.cpp
+//       ../libraries/SpeedReaderCore/src/SR_SerialFrame.cpp
+//       ../libraries/SpeedReaderCore/src/SR_ReadingCodec.cpp
+//       ../libraries/SpeedReaderCore/src/SR_JsonWriter.cpp -o sr_serial
+//
+// Usage:
+//   sr_serial /dev/ttyUSB0 [--baud 921600] > bench.csv
+//   sr_serial --compact capture.bin > bench.compact
+//   sr_serial --self-test
+//
+// A tty is switched to raw mode at --baud (serial_baud on the device);
+// anything else is read as a capture.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+#include "SR_SerialFrame.h"
+#include "SR_ReadingCodec.h"
+
+struct StreamStats {
+  uint64_t frames;
+  uint64_t samples;
+  uint64_t lost;
+  uint64_t logLines;
+  uint64_t badFrames;     // failed COBS, CRC or version; boot ROM text counts here
+  uint32_t expected;      // next sample seq
+  uint64_t firstUs;
+  uint64_t lastUs;
+};
+
+static volatile sig_atomic_t stopping = 0;
+
+static void onSignal(int) {
+  stopping = 1;
+}
+
+// Splits the byte stream at zeros and decodes each frame
+class FrameDecoder {
+public:
+  FrameDecoder(bool compact, FILE* out) : compact(compact), out(out), overflow(false),
+                                          haveTime(false), lastRawUs(0), highUs(0) {
+    memset(&stats, 0, sizeof(stats));
+  }
+
+  void feed(const uint8_t* p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      if (p[i] != 0) {
+        if (frame.size() < SERIAL_FRAME_MAX_ENCODED) frame.push_back(p[i]);
+        else overflow = true;
+        continue;
+      }
+      if (overflow) stats.badFrames++;
+      else if (!frame.empty()) handle();
+      frame.clear();
+      overflow = false;
+    }
+  }
+
+  StreamStats stats;
+
+private:
+  // t_us wraps every ~71 minutes; frames arrive in order, so unwrap here
+  uint64_t unwrap(uint32_t us) {
+    if (haveTime && us < lastRawUs) highUs += 1ULL << 32;
+    haveTime = true;
+    lastRawUs = us;
+    return highUs + us;
+  }
+
+  void handle() {
+    uint8_t scratch[SERIAL_FRAME_MAX_RAW];
+    SerialFrameHeader h;
+    const uint8_t* payload;
+    size_t len;
+    if (!decodeSerialFrame(frame.data(), frame.size(), scratch, sizeof(scratch), h, payload, len)) {
+      stats.badFrames++;
+      return;
+    }
+    stats.frames++;
+
+    if (h.type == SERIAL_FRAME_LOG && len >= 1) {
+      static const char LEVEL_CHARS[] = "-EWID";
+      fprintf(stderr, "[%10.3f] %c %.*s\n", h.t_us / 1000000.0,
+              payload[0] < 5 ? LEVEL_CHARS[payload[0]] : '?', (int)(len - 1),
+              (const char*)payload + 1);
+      stats.logLines++;
+      return;
+    }
+
+    Reading r;
+    if (h.type != SERIAL_FRAME_SAMPLE || decodeReadingCompact(payload, len, r) == 0) {
+      stats.badFrames++;
+      return;
+    }
+    if (stats.samples > 0 && h.seq != stats.expected) {
+      // A reset device starts again from 1; count only forward gaps
+      if ((int32_t)(h.seq - stats.expected) > 0) stats.lost += h.seq - stats.expected;
+    }
+    stats.expected = h.seq + 1;
+
+    uint64_t us = unwrap(h.t_us);
+    if (stats.samples == 0) stats.firstUs = us;
+    stats.lastUs = us;
+    stats.samples++;
+
+    if (compact) {
+      fwrite(payload, 1, sizeof(CompactReading), out);
+    } else {
+      fprintf(out, "%lu,%llu,%lu,%.4f,%.2f,%.2f,%.2f,%.3f,%d\n", (unsigned long)h.seq,
+              (unsigned long long)us, (unsigned long)r.rotations, r.distance_miles, r.speed_mph,
+              r.max_speed, r.angle, r.vibration, (payload[1] & COMPACT_SESSION_ACTIVE) ? 1 : 0);
+    }
+  }
+
+  bool compact;
+  FILE* out;
+  std::vector<uint8_t> frame;
+  bool overflow;
+  bool haveTime;
+  uint32_t lastRawUs;
+  uint64_t highUs;
+};
+
+static void report(const StreamStats& s) {
+  double span = (s.lastUs - s.firstUs) / 1000000.0;
+  uint64_t total = s.samples + s.lost;
+  fprintf(stderr, "%llu samples, lost %llu (%.2f%%), %llu log lines, %llu bad frames",
+          (unsigned long long)s.samples, (unsigned long long)s.lost,
+          total ? 100.0 * s.lost / total : 0.0, (unsigned long long)s.logLines,
+          (unsigned long long)s.badFrames);
+  if (s.samples > 1 && span > 0) fprintf(stderr, ", %.1f Hz over %.1f s", (s.samples - 1) / span, span);
+  fprintf(stderr, "\n");
+}
+
+// ===== Serial port =====
+static bool setBaud(int fd, long baud) {
+  static const struct { long rate; speed_t code; } RATES[] = {
+    { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+    { 115200, B115200 }, { 230400, B230400 },
+    #ifdef B460800
+    { 460800, B460800 }, { 921600, B921600 }, { 1000000, B1000000 },
+    { 1500000, B1500000 }, { 2000000, B2000000 }, { 3000000, B3000000 },
+    #endif
+  };
+  termios t;
+  if (tcgetattr(fd, &t) != 0) return false;
+  cfmakeraw(&t);
+  t.c_cflag |= CLOCAL | CREAD;
+  t.c_cc[VMIN] = 1;
+  t.c_cc[VTIME] = 0;
+  for (const auto& r : RATES) {
+    if (r.rate == baud) {
+      cfsetispeed(&t, r.code);
+      cfsetospeed(&t, r.code);
+      return tcsetattr(fd, TCSANOW, &t) == 0;
+    }
+  }
+  fprintf(stderr, "unsupported baud rate %ld\n", baud);
+  return false;
+}
+
+// ===== Self-test =====
+static int failures = 0;
+
+static void expect(bool ok, const char* what, double got, double want) {
+  if (ok) return;
+  fprintf(stderr, "FAIL %s: got %.6f, want %.6f\n", what, got, want);
+  failures++;
+}
+
+static void testCobs() {
+  uint8_t in[700], enc[720], dec[720];
+  unsigned rng = 1;
+  for (size_t len = 0; len <= 600; len++) {
+    for (int pattern = 0; pattern < 4; pattern++) {
+      for (size_t i = 0; i < len; i++) {
+        rng = rng * 1103515245 + 12345;
+        in[i] = pattern == 0 ? 0 : pattern == 1 ? 0x55 : pattern == 2 ? (uint8_t)(rng >> 16)
+                                                 : (i % 255 == 254 ? 0 : 1);
+      }
+      size_t n = cobsEncode(in, len, enc, sizeof(enc));
+      bool zeroFree = n > 0 && memchr(enc, 0, n) == NULL;
+      expect(zeroFree, "cobs output free of zeros", (double)len, (double)pattern);
+      expect(n <= len + len / 254 + 1, "cobs overhead", (double)n, (double)(len + len / 254 + 1));
+      size_t m = cobsDecode(enc, n, dec, sizeof(dec));
+      expect(m == len && memcmp(in, dec, len) == 0, "cobs round trip", (double)m, (double)len);
+      if (n > 1) expect(cobsEncode(in, len, enc, n - 1) == 0, "cobs short buffer", 0, 0);
+    }
+  }
+  uint8_t bad[] = { 0x05, 0x11, 0x22 };
+  expect(cobsDecode(bad, sizeof(bad), dec, sizeof(dec)) == 0, "cobs truncated block", 0, 0);
+}
+
+static Reading sampleReading(uint32_t seq) {
+  Reading r;
+  memset(&r, 0, sizeof(r));
+  r.seq = seq;
+  r.rotations = 1000 + seq;
+  r.distance_miles = 1.25f;
+  r.speed_mph = 0.5f * (seq % 40);
+  r.angle = -10.0f + 0.01f * seq;
+  r.vibration = 0.02f;
+  strcpy(r.job, "bench");
+  return r;
+}
+
+static void appendSample(std::vector<uint8_t>& s, uint32_t seq, uint32_t tUs) {
+  uint8_t payload[sizeof(CompactReading)];
+  uint8_t frame[SERIAL_FRAME_MAX_ENCODED];
+  encodeReadingCompact(sampleReading(seq), payload, sizeof(payload));
+  size_t n = encodeSerialFrame(SERIAL_FRAME_SAMPLE, seq, tUs, payload, sizeof(payload), frame, sizeof(frame));
+  s.insert(s.end(), frame, frame + n);
+}
+
+static void testStream() {
+  const uint32_t count = 2000, drop = 10, periodUs = 5000;
+  std::vector<uint8_t> stream;
+  // Mid-frame start and boot text at the wrong baud
+  const char* junk = "\x13\x37rst:0x1 (POWERON_RESET),boot:0x13\r\n";
+  stream.insert(stream.end(), junk, junk + strlen(junk));
+
+  uint32_t expectBad = 1;
+  for (uint32_t seq = 1; seq <= count; seq++) {
+    if (seq % drop == 0) continue;
+    // t_us wraps partway through
+    appendSample(stream, seq, 0xFFF00000u + seq * periodUs);
+    if (seq == 501) {
+      uint8_t payload[64] = { 2 };
+      strcpy((char*)payload + 1, "Sensor: rot:1500 speed_mph:12.00");
+      uint8_t frame[SERIAL_FRAME_MAX_ENCODED];
+      size_t n = encodeSerialFrame(SERIAL_FRAME_LOG, 1, seq * periodUs, payload,
+                                   1 + strlen((char*)payload + 1), frame, sizeof(frame));
+      stream.insert(stream.end(), frame, frame + n);
+    }
+    if (seq == 701) {
+      // A reset mid-capture: the boot ROM banner between two frames
+      const char* text = "ets Jul 29 2019 12:21:46\r\n";
+      stream.insert(stream.end(), text, text + strlen(text));
+      expectBad++;
+    }
+    if (seq == 901) {
+      // A frame with one corrupted byte fails the CRC
+      appendSample(stream, seq, 0);
+      uint8_t& b = stream[stream.size() - 5];
+      b = b == 0xAA ? 0x55 : 0xAA;
+      expectBad++;
+    }
+  }
+
+  FILE* sink = fopen("/dev/null", "w");
+  FrameDecoder d(false, sink ? sink : stdout);
+  // Arbitrary read sizes, as from a serial port
+  size_t pos = 0, chunk = 1;
+  while (pos < stream.size()) {
+    size_t n = chunk < stream.size() - pos ? chunk : stream.size() - pos;
+    d.feed(stream.data() + pos, n);
+    pos += n;
+    chunk = chunk % 97 + 13;
+  }
+  if (sink) fclose(sink);
+
+  // The last seq (2000) is dropped, so its gap is never seen
+  uint64_t expectSamples = count - count / drop;
+  uint64_t expectLost = count / drop - 1;
+  expect(d.stats.samples == expectSamples, "samples", (double)d.stats.samples, (double)expectSamples);
+  expect(d.stats.lost == expectLost, "lost", (double)d.stats.lost, (double)expectLost);
+  expect(d.stats.badFrames == expectBad, "bad frames", (double)d.stats.badFrames, (double)expectBad);
+  expect(d.stats.logLines == 1, "log lines", (double)d.stats.logLines, 1);
+  double spanUs = (double)(count - 1 - 1) * periodUs;
+  expect(d.stats.lastUs - d.stats.firstUs == (uint64_t)spanUs, "t_us unwrapped",
+         (double)(d.stats.lastUs - d.stats.firstUs), spanUs);
+}
+
+static int selfTest() {
+  testCobs();
+  testStream();
+  printf("%s\n", failures ? "self-test FAILED" : "self-test ok");
+  return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+  const char* path = NULL;
+  long baud = 921600;
+  bool compact = false;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    if (!strcmp(a, "--self-test")) return selfTest();
+    else if (!strcmp(a, "--baud") && i + 1 < argc) baud = atol(argv[++i]);
+    else if (!strcmp(a, "--compact")) compact = true;
+    else if (a[0] != '-' && !path) path = a;
+    else {
+      fprintf(stderr, "usage: %s [--baud N] [--compact] [device|capture]\n"
+                      "       %s --self-test\n", argv[0], argv[0]);
+      return 2;
+    }
+  }
+
+  int fd = STDIN_FILENO;
+  if (path) {
+    fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+      perror(path);
+      return 1;
+    }
+  }
+  if (isatty(fd) && !setBaud(fd, baud)) {
+    perror("tcsetattr");
+    return 1;
+  }
+
+  // Stop cleanly on Ctrl-C; read() then returns EINTR
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = onSignal;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  if (!compact) printf("seq,t_us,rotations,distance_miles,speed_mph,max_speed,angle,vibration,active\n");
+  FrameDecoder d(compact, stdout);
+  uint8_t buf[4096];
+  while (!stopping) {
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n <= 0) break;
+    d.feed(buf, (size_t)n);
+  }
+  if (fd != STDIN_FILENO) close(fd);
+  fflush(stdout);
+  report(d.stats);
+  return 0;
+}
@@ -0,0 +1,286 @@
+// Host-side receiver for the device's UDP telemetry (udp_enabled). Counts
+// received, lost, duplicate and out-of-order datagrams per sender from the
+// datagram counter (`pkt`) and prints a report every few seconds and on
+// Ctrl-C. With --csv each reading is printed as a CSV row instead.
+//
+// Build (from speed_reader/tools):
+//   g++ -std=c++11 -O2 -I../libraries/SpeedReaderCore/src sr_udp_recv.cpp
+//       ../libraries/SpeedReaderCore/src/SR_TelemetryDatagram.cpp
+//       ../libraries/SpeedReaderCore/src/SR_ReadingCodec.cpp
+//       ../libraries/SpeedReaderCore/src/SR_JsonWriter.cpp
+//       ../libraries/SpeedReaderCore/src/SR_Json.cpp -pthread -o sr_udp_recv
+//
+// Usage:
+//   sr_udp_recv [--group 239.255.83.82] [--port 5005] [--csv]
+//   sr_udp_recv --send 127.0.0.1 [--port 5005] [--count 1000] [--drop 10] [--binary]
+//   sr_udp_recv --self-test
+//
+// --send generates synthetic readings (every --drop'th datagram is skipped
+// to simulate loss), so the receiver can be tried on loopback without a
+// device. --self-test runs both ends over 127.0.0.1 and checks the counts.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "SR_TelemetryDatagram.h"
+
+struct SourceStats {
+  uint32_t expected;     // next pkt we expect
+  uint64_t received;
+  uint64_t lost;
+  uint64_t duplicates;   // pkt below expected (late or repeated)
+  uint64_t malformed;
+  uint32_t lastSeq;
+  float lastSpeed;
+  bool started;
+};
+
+static volatile sig_atomic_t stopping = 0;
+
+static void onSignal(int) {
+  stopping = 1;
+}
+
+static bool isMulticast(const char* addr) {
+  in_addr a;
+  return inet_pton(AF_INET, addr, &a) == 1 && IN_MULTICAST(ntohl(a.s_addr));
+}
+
+static int openReceiver(const char* group, uint16_t port) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return -1;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+    perror("bind");
+    close(fd);
+    return -1;
+  }
+
+  if (group && isMulticast(group)) {
+    ip_mreq mreq;
+    inet_pton(AF_INET, group, &mreq.imr_multiaddr);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+      perror("IP_ADD_MEMBERSHIP");
+      close(fd);
+      return -1;
+    }
+  }
+
+  timeval tv = { 0, 200000 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+static void account(SourceStats& s, uint32_t pkt) {
+  if (!s.started) {
+    s.started = true;
+    s.expected = pkt;
+  }
+  if (pkt == s.expected) {
+    s.expected++;
+  } else if ((int32_t)(pkt - s.expected) > 0) {
+    s.lost += pkt - s.expected;
+    s.expected = pkt + 1;
+  } else {
+    // Arrived after a gap was already counted as lost
+    s.duplicates++;
+    if (s.lost > 0) s.lost--;
+  }
+  s.received++;
+}
+
+static void report(const std::map<std::string, SourceStats>& sources) {
+  for (const auto& it : sources) {
+    const SourceStats& s = it.second;
+    uint64_t total = s.received + s.lost;
+    fprintf(stderr, "%s: received %llu, lost %llu (%.2f%%), late/dup %llu, malformed %llu, seq %lu, %.2f mph\n",
+            it.first.c_str(), (unsigned long long)s.received, (unsigned long long)s.lost,
+            total ? 100.0 * s.lost / total : 0.0, (unsigned long long)s.duplicates,
+            (unsigned long long)s.malformed, (unsigned long)s.lastSeq, s.lastSpeed);
+  }
+}
+
+// Receives until stopped (or `limit` datagrams); returns the per-sender stats
+static std::map<std::string, SourceStats> receive(int fd, bool csv, uint64_t limit, unsigned idleStopMs) {
+  std::map<std::string, SourceStats> sources;
+  uint8_t buf[2048];
+  uint64_t total = 0;
+  timeval lastReport, lastPacket;
+  gettimeofday(&lastReport, NULL);
+  lastPacket = lastReport;
+
+  if (csv) {
+    printf("source,pkt,seq,t_ms,rotations,distance_miles,speed_mph,max_speed,angle,max_angle,min_angle,vibration,max_vibration,job,utc_ms\n");
+  }
+
+  while (!stopping && (limit == 0 || total < limit)) {
+    sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, (sockaddr*)&from, &fromLen);
+    timeval now;
+    gettimeofday(&now, NULL);
+
+    if (n > 0) {
+      lastPacket = now;
+      char source[32];
+      char ip[INET_ADDRSTRLEN];
+      inet_ntop(AF_INET, &from.sin_addr, ip, sizeof(ip));
+      snprintf(source, sizeof(source), "%s:%u", ip, ntohs(from.sin_port));
+      SourceStats& s = sources[source];
+
+      uint32_t pkt;
+      Reading r;
+      if (!decodeTelemetry(buf, (size_t)n, pkt, r)) {
+        s.malformed++;
+      } else {
+        account(s, pkt);
+        s.lastSeq = r.seq;
+        s.lastSpeed = r.speed_mph;
+        total++;
+        if (csv) {
+          printf("%s,%lu,%lu,%lu,%lu,%.4f,%.2f,%.2f,%.1f,%.1f,%.1f,%.3f,%.3f,%s,%llu\n", source,
+                 (unsigned long)pkt, (unsigned long)r.seq, (unsigned long)r.t_ms,
+                 (unsigned long)r.rotations, r.distance_miles, r.speed_mph, r.max_speed, r.angle,
+                 r.max_angle, r.min_angle, r.vibration, r.max_vibration, r.job,
+                 (unsigned long long)r.utc_ms);
+        }
+      }
+    }
+
+    long sinceReport = (now.tv_sec - lastReport.tv_sec) * 1000 + (now.tv_usec - lastReport.tv_usec) / 1000;
+    if (!csv && sinceReport >= 5000) {
+      report(sources);
+      lastReport = now;
+    }
+    long sincePacket = (now.tv_sec - lastPacket.tv_sec) * 1000 + (now.tv_usec - lastPacket.tv_usec) / 1000;
+    if (idleStopMs && sincePacket >= (long)idleStopMs) break;
+  }
+  return sources;
+}
+
+// ===== Synthetic sender =====
+static int sendSynthetic(const char* host, uint16_t port, uint32_t count, uint32_t drop,
+                         bool binary, unsigned intervalUs) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return -1;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+
+  sockaddr_in to;
+  memset(&to, 0, sizeof(to));
+  to.sin_family = AF_INET;
+  to.sin_port = htons(port);
+  if (inet_pton(AF_INET, host, &to.sin_addr) != 1) {
+    fprintf(stderr, "bad address %s\n", host);
+    close(fd);
+    return -1;
+  }
+
+  uint32_t sent = 0;
+  for (uint32_t pkt = 1; pkt <= count; pkt++) {
+    if (drop && pkt % drop == 0) continue;
+    Reading r;
+    memset(&r, 0, sizeof(r));
+    r.seq = pkt;
+    r.t_ms = pkt * 50;
+    r.rotations = pkt / 4;
+    r.speed_mph = 10.0f + (float)(pkt % 100) / 10.0f;
+    strcpy(r.job, "loopback");
+
+    uint8_t datagram[TELEMETRY_MAX_DATAGRAM];
+    size_t len = encodeTelemetry(r, pkt, binary ? TELEMETRY_PACKED : TELEMETRY_JSON, datagram, sizeof(datagram));
+    if (sendto(fd, datagram, len, 0, (sockaddr*)&to, sizeof(to)) == (ssize_t)len) sent++;
+    if (intervalUs) usleep(intervalUs);
+  }
+  close(fd);
+  return (int)sent;
+}
+
+static int selfTest(uint16_t port) {
+  const uint32_t count = 1000, drop = 10;
+  int failures = 0;
+  for (int binary = 0; binary <= 1; binary++) {
+    int fd = openReceiver(NULL, port);
+    if (fd < 0) return 1;
+    std::map<std::string, SourceStats> sources;
+    std::thread receiver([&]() { sources = receive(fd, false, 0, 500); });
+    int sent = sendSynthetic("127.0.0.1", port, count, drop, binary != 0, 100);
+    receiver.join();
+    close(fd);
+
+    const SourceStats* s = sources.empty() ? NULL : &sources.begin()->second;
+    // pkt 1000 is the last one and dropped, so the final gap is invisible
+    uint64_t expectLost = count / drop - 1;
+    bool ok = s && sources.size() == 1 && s->received == (uint64_t)sent && s->lost == expectLost &&
+              s->duplicates == 0 && s->malformed == 0;
+    printf("%s: sent %d, received %llu, lost %llu (expected %llu) ... %s\n",
+           binary ? "binary" : "json", sent, s ? (unsigned long long)s->received : 0ULL,
+           s ? (unsigned long long)s->lost : 0ULL, (unsigned long long)expectLost, ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+  }
+  return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+  const char* group = "239.255.83.82";
+  const char* sendTo = NULL;
+  uint16_t port = 5005;
+  uint32_t count = 1000, drop = 0;
+  bool csv = false, binary = false, test = false;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(a, "--group") && hasValue) group = argv[++i];
+    else if (!strcmp(a, "--port") && hasValue) port = (uint16_t)atoi(argv[++i]);
+    else if (!strcmp(a, "--send") && hasValue) sendTo = argv[++i];
+    else if (!strcmp(a, "--count") && hasValue) count = (uint32_t)atol(argv[++i]);
+    else if (!strcmp(a, "--drop") && hasValue) drop = (uint32_t)atol(argv[++i]);
+    else if (!strcmp(a, "--csv")) csv = true;
+    else if (!strcmp(a, "--binary")) binary = true;
+    else if (!strcmp(a, "--self-test")) test = true;
+    else {
+      fprintf(stderr, "usage: %s [--group ADDR] [--port N] [--csv]\n"
+                      "       %s --send HOST [--port N] [--count N] [--drop N] [--binary]\n"
+                      "       %s --self-test\n", argv[0], argv[0], argv[0]);
+      return 2;
+    }
+  }
+
+  if (test) return selfTest(port);
+
+  if (sendTo) {
+    int sent = sendSynthetic(sendTo, port, count, drop, binary, 1000);
+    fprintf(stderr, "sent %d datagrams\n", sent);
+    return sent < 0 ? 1 : 0;
+  }
+
+  int fd = openReceiver(group, port);
+  if (fd < 0) return 1;
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  fprintf(stderr, "listening on port %u%s%s\n", port, isMulticast(group) ? ", group " : "",
+          isMulticast(group) ? group : "");
+  std::map<std::string, SourceStats> sources = receive(fd, csv, 0, 0);
+  close(fd);
+  report(sources);
+  return 0;
+}